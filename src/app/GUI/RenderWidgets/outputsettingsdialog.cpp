@@ -83,6 +83,10 @@ OutputSettingsDialog::OutputSettingsDialog(const OutputSettings &settings,
     mBitrateSpinBox = new QDoubleSpinBox(this);
     mBitrateSpinBox->setRange(0.1, 100.);
     mBitrateSpinBox->setSuffix(" Mbps");
+    mThreadsLabel = new QLabel("Threads:", this);
+    mThreadsSpinBox = new QSpinBox(this);
+    mThreadsSpinBox->setRange(0, 64);
+    mThreadsSpinBox->setSpecialValueText("Auto");
 
     mVideoSettingsLayout->addPair(mVideoCodecsLabel,
                                   mVideoCodecsComboBox);
@@ -90,6 +94,8 @@ OutputSettingsDialog::OutputSettingsDialog(const OutputSettings &settings,
                                   mPixelFormatsComboBox);
     mVideoSettingsLayout->addPair(mBitrateLabel,
                                   mBitrateSpinBox);
+    mVideoSettingsLayout->addPair(mThreadsLabel,
+                                  mThreadsSpinBox);
 
     mAudioGroupBox = new QGroupBox("Audio", this);
     mAudioGroupBox->setCheckable(true);
@@ -191,6 +197,7 @@ OutputSettings OutputSettingsDialog::getSettings() {
     }
     settings.videoPixelFormat = currentPixelFormat;
     settings.videoBitrate = qRound(mBitrateSpinBox->value()*1000000);
+    settings.videoThreads = mThreadsSpinBox->value();
 
     settings.audioEnabled = mAudioGroupBox->isChecked();
     const AVCodec *currentAudioCodec = nullptr;
@@ -605,6 +612,7 @@ void OutputSettingsDialog::restoreInitialSettings() {
     } else {
         mBitrateSpinBox->setValue(currentBitrate/1000000.);
     }
+    mThreadsSpinBox->setValue(mInitialSettings.videoThreads);
     const bool noVideoCodecs = mVideoCodecsComboBox->count() == 0;
     mVideoGroupBox->setChecked(mInitialSettings.videoEnabled &&
                                !noVideoCodecs);
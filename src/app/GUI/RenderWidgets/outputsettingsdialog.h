@@ -22,6 +22,7 @@
 #include <QComboBox>
 #include <QLabel>
 #include <QDoubleSpinBox>
+#include <QSpinBox>
 #include <QGroupBox>
 #include <QCheckBox>
 #include "renderinstancesettings.h"
@@ -90,6 +91,8 @@ protected:
     QComboBox *mPixelFormatsComboBox = nullptr;
     QLabel *mBitrateLabel = nullptr;
     QDoubleSpinBox *mBitrateSpinBox = nullptr;
+    QLabel *mThreadsLabel = nullptr;
+    QSpinBox *mThreadsSpinBox = nullptr;
 
     QGroupBox *mAudioGroupBox = nullptr;
     TwoColumnLayout *mAudioSettingsLayout = nullptr;
@@ -29,6 +29,17 @@ PerformanceSettingsWidget::PerformanceSettingsWidget(QWidget *parent) :
     cpuCapSett->addWidget(mCpuThreadsCapSlider);
     addLayout(cpuCapSett);
 
+    QHBoxLayout* framesInFlightSett = new QHBoxLayout;
+
+    mFramesInFlightLabel = new QLabel("Output frames in flight", this);
+    mFramesInFlightSpin = new QSpinBox(this);
+    mFramesInFlightSpin->setRange(0, 4*HardwareInfo::sCpuThreads());
+    mFramesInFlightSpin->setSpecialValueText("Auto");
+
+    framesInFlightSett->addWidget(mFramesInFlightLabel);
+    framesInFlightSett->addWidget(mFramesInFlightSpin);
+    addLayout(framesInFlightSett);
+
     addSeparator();
 
     QHBoxLayout* ramCapSett = new QHBoxLayout;
@@ -113,6 +124,7 @@ void PerformanceSettingsWidget::applySettings() {
     eSettings& sett = *eSettings::sInstance;
     sett.fCpuThreadsCap = mCpuThreadsCapCheck->isChecked() ?
                 mCpuThreadsCapSlider->value() : 0;
+    sett.fOutputFramesInFlight = mFramesInFlightSpin->value();
     sett.fRamMBCap = intMB(mRamMBCapCheck->isChecked() ?
                 mRamMBCapSpin->value() : 0);
     sett.fAccPreference = static_cast<AccPreference>(
@@ -132,6 +144,8 @@ void PerformanceSettingsWidget::updateSettings() {
                                   HardwareInfo::sCpuThreads();
     mCpuThreadsCapSlider->setValue(nThreads);
 
+    mFramesInFlightSpin->setValue(qMax(0, sett.fOutputFramesInFlight));
+
     const bool capRam = sett.fRamMBCap.fValue > 250;
     mRamMBCapCheck->setChecked(capRam);
     const int nRamMB = capRam ? sett.fRamMBCap.fValue :
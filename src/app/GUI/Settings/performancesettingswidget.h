@@ -20,6 +20,9 @@ private:
     QLabel* mCpuThreadsCapLabel = nullptr;
     QSlider* mCpuThreadsCapSlider = nullptr;
 
+    QLabel* mFramesInFlightLabel = nullptr;
+    QSpinBox* mFramesInFlightSpin = nullptr;
+
     QCheckBox* mRamMBCapCheck = nullptr;
     QSpinBox* mRamMBCapSpin = nullptr;
     QSlider* mRamMBCapSlider = nullptr;
@@ -0,0 +1,123 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "audiofeeder.h"
+
+AudioFeeder::AudioFeeder(AudioRingBuffer& ring, QObject * const parent) :
+    QThread(parent), mRing(ring), mSilence(ring.capacity()/4, 0) {}
+
+AudioFeeder::~AudioFeeder() {
+    stopFeeding();
+}
+
+void AudioFeeder::startFeeding(const int firstSample, const int lastSample,
+                               const int frameBytes) {
+    stopFeeding();
+    {
+        QMutexLocker lock(&mMutex);
+        mNextSample = firstSample;
+        mLastSample = lastSample;
+        mFrameBytes = frameBytes;
+        mFeeding = true;
+    }
+    start(QThread::TimeCriticalPriority);
+}
+
+void AudioFeeder::stopFeeding() {
+    {
+        QMutexLocker lock(&mMutex);
+        mFeeding = false;
+    }
+    mWake.release();
+    wait();
+    // the thread is not running, drop the leftover wakeups
+    mWake.tryAcquire(mWake.available());
+    mWaiting = false;
+    mOffered.clear();
+    mRing.clear();
+}
+
+void AudioFeeder::offerSecond(const stdsptr<Samples>& samples) {
+    if(!samples || !samples->fData) return;
+    const auto range = samples->fSampleRange;
+    {
+        QMutexLocker lock(&mMutex);
+        if(!mFeeding) return;
+        if(range.fMax < mNextSample || range.fMin > mLastSample) return;
+        mOffered.insert(range.fMin, samples);
+    }
+    wake();
+}
+
+void AudioFeeder::spaceFreed() {
+    // do not wake for every small read
+    if(mRing.bytesFree() < mRing.capacity()/4) return;
+    wake();
+}
+
+void AudioFeeder::wake() {
+    if(mWaiting.exchange(false)) mWake.release();
+}
+
+void AudioFeeder::run() {
+    while(true) {
+        {
+            QMutexLocker lock(&mMutex);
+            if(!mFeeding) return;
+            // set before feeding, space freed or seconds offered
+            // after a failed attempt still wake the thread
+            mWaiting = true;
+            if(feed()) {
+                mWaiting = false;
+                continue;
+            }
+        }
+        mWake.acquire();
+    }
+}
+
+bool AudioFeeder::feed() {
+    if(mNextSample > mLastSample) return false;
+    while(!mOffered.isEmpty() &&
+          mOffered.first()->fSampleRange.fMax < mNextSample) {
+        mOffered.erase(mOffered.begin());
+    }
+    if(mOffered.isEmpty()) return feedSilence(mLastSample - mNextSample + 1);
+    const auto& samples = mOffered.first();
+    const auto range = samples->fSampleRange;
+    if(mNextSample < range.fMin) return feedSilence(range.fMin - mNextSample);
+    const int freeFrames = mRing.bytesFree()/mFrameBytes;
+    const int lastSample = qMin(range.fMax, mLastSample);
+    const int nFrames = qMin(freeFrames, lastSample - mNextSample + 1);
+    if(nFrames <= 0) return false;
+    const int displ = (mNextSample - range.fMin)*mFrameBytes;
+    const auto src = reinterpret_cast<const char*>(samples->fData[0]) + displ;
+    mRing.write(src, nFrames*mFrameBytes);
+    mNextSample += nFrames;
+    return true;
+}
+
+bool AudioFeeder::feedSilence(const int maxFrames) {
+    // the missing second may still arrive, wait while the ring
+    // holds enough to play
+    if(mRing.bytesAvailable() >= mRing.capacity()/2) return false;
+    const int freeFrames = qMin(mRing.bytesFree(), mSilence.size())/mFrameBytes;
+    const int nFrames = qMin(freeFrames, maxFrames);
+    if(nFrames <= 0) return false;
+    mRing.write(mSilence.constData(), nFrames*mFrameBytes);
+    mNextSample += nFrames;
+    return true;
+}
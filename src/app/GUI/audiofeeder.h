@@ -0,0 +1,104 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef AUDIOFEEDER_H
+#define AUDIOFEEDER_H
+#include <QThread>
+#include <QMutex>
+#include <QMap>
+#include <QSemaphore>
+#include <QIODevice>
+#include <atomic>
+#include "audioringbuffer.h"
+#include "CacheHandlers/samples.h"
+
+//! @brief Fills the ring with queued sound seconds on its own thread.
+//! The thread runs between startFeeding and stopFeeding and sleeps
+//! until a second is queued or the consumer frees space in the ring.
+//! Only interleaved sample formats are supported.
+class AudioFeeder : public QThread {
+public:
+    AudioFeeder(AudioRingBuffer& ring, QObject * const parent = nullptr);
+    ~AudioFeeder();
+
+    //! @brief Main thread, feeds samples [firstSample, lastSample],
+    //! frameBytes is the size of one interleaved frame.
+    void startFeeding(const int firstSample, const int lastSample,
+                      const int frameBytes);
+    //! @brief Main thread, stops the thread, drops the offered seconds
+    //! and clears the ring. The ring consumer has to be stopped.
+    void stopFeeding();
+    //! @brief Main thread, seconds can be offered in any order,
+    //! the thread takes them once it reaches them.
+    void offerSecond(const stdsptr<Samples>& samples);
+    //! @brief Ring consumer, wakes the thread once enough space is free.
+    //! Lock-free unless the thread is waiting.
+    void spaceFreed();
+protected:
+    void run() override;
+private:
+    //! @brief Returns false if there was nothing to feed.
+    bool feed();
+    //! @brief Fills a missing part with silence once the ring runs low.
+    bool feedSilence(const int maxFrames);
+    void wake();
+
+    AudioRingBuffer& mRing;
+    const QByteArray mSilence;
+    //! @brief Set by the thread before it tries to feed,
+    //! whoever clears it releases mWake
+    std::atomic<bool> mWaiting{false};
+    QSemaphore mWake;
+    // guards everything below, the ring consumer never locks
+    QMutex mMutex;
+    bool mFeeding = false;
+    //! @brief Offered seconds by their first sample
+    QMap<int, stdsptr<Samples>> mOffered;
+    int mNextSample = 0;
+    int mLastSample = -1;
+    int mFrameBytes = 0;
+};
+
+//! @brief Audio output device pulling from the ring.
+class AudioRingDevice : public QIODevice {
+public:
+    AudioRingDevice(AudioRingBuffer& ring, AudioFeeder& feeder,
+                    QObject * const parent = nullptr) :
+        QIODevice(parent), mRing(ring), mFeeder(feeder) {}
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override {
+        return mRing.bytesAvailable() + QIODevice::bytesAvailable();
+    }
+protected:
+    qint64 readData(char *data, qint64 maxLen) override {
+        const int len = static_cast<int>(qMin(maxLen, qint64(mRing.capacity())));
+        const int read = mRing.read(data, len);
+        if(read > 0) mFeeder.spaceFreed();
+        return read;
+    }
+
+    qint64 writeData(const char *data, qint64 len) override {
+        Q_UNUSED(data)
+        Q_UNUSED(len)
+        return -1;
+    }
+private:
+    AudioRingBuffer& mRing;
+    AudioFeeder& mFeeder;
+};
+
+#endif // AUDIOFEEDER_H
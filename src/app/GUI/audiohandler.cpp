@@ -18,12 +18,32 @@
 #include "Sound/soundcomposition.h"
 AudioHandler* AudioHandler::sInstance = nullptr;
 
-AudioHandler::AudioHandler() {
+// about 1.3 s of stereo float samples at 48 kHz
+const int RingSize = 1 << 19;
+
+AudioHandler::AudioHandler() :
+    mRing(RingSize), mFeeder(mRing), mRingDevice(mRing, mFeeder) {
     Q_ASSERT(!sInstance);
     sInstance = this;
+    mAudioContext.moveToThread(&mAudioThread);
+    mRingDevice.moveToThread(&mAudioThread);
+    mAudioThread.start(QThread::TimeCriticalPriority);
+}
+
+AudioHandler::~AudioHandler() {
+    stopAudio();
+    runOnAudioThread([this]() {
+        delete mAudioOutput;
+        mAudioOutput = nullptr;
+    });
+    mAudioThread.quit();
+    mAudioThread.wait();
 }
 
-const int BufferSize = 32768;
+void AudioHandler::runOnAudioThread(const std::function<void()>& func) {
+    QMetaObject::invokeMethod(&mAudioContext, func,
+                              Qt::BlockingQueuedConnection);
+}
 
 QAudioFormat::SampleType toQtAudioFormat(const AVSampleFormat avFormat) {
     if(avFormat == AV_SAMPLE_FMT_S32) {
@@ -35,9 +55,7 @@ QAudioFormat::SampleType toQtAudioFormat(const AVSampleFormat avFormat) {
 }
 
 void AudioHandler::initializeAudio(const eSoundSettingsData& soundSettings) {
-    if(mAudioOutput) delete mAudioOutput;
-
-    mAudioBuffer = QByteArray(BufferSize, 0);
+    stopAudio();
 
     mAudioDevice = QAudioDeviceInfo::defaultOutputDevice();
     mAudioFormat.setSampleRate(soundSettings.fSampleRate);
@@ -53,21 +71,67 @@ void AudioHandler::initializeAudio(const eSoundSettingsData& soundSettings) {
         mAudioFormat = info.nearestFormat(mAudioFormat);
     }
 
-    mAudioOutput = new QAudioOutput(mAudioDevice, mAudioFormat, this);
+    runOnAudioThread([this]() {
+        delete mAudioOutput;
+        mAudioOutput = new QAudioOutput(mAudioDevice, mAudioFormat);
+        mAudioOutput->setNotifyInterval(10);
+        connect(mAudioOutput, &QAudioOutput::notify,
+                &mAudioContext, [this]() { updatePlayedUSecs(); });
+    });
 }
 
-void AudioHandler::startAudio() {
-    mAudioIOOutput = mAudioOutput->start();
+void AudioHandler::startAudio(const int firstSample, const int lastSample) {
+    if(!mAudioOutput) return;
+    const int frameBytes = eSoundSettings::sChannelCount()*
+                           eSoundSettings::sBytesPerSample();
+    mFeeder.startFeeding(firstSample, lastSample, frameBytes);
+    mPlayedUSecs = 0;
+    runOnAudioThread([this]() {
+        mRingDevice.open(QIODevice::ReadOnly);
+        // pull mode, the output reads the ring from the audio thread
+        // event loop, the feeder thread keeps the ring filled
+        mAudioOutput->start(&mRingDevice);
+    });
 }
 
 void AudioHandler::stopAudio() {
-    //mAudioOutput->suspend();
-    //mCurrentSoundComposition->stop();
-    mAudioIOOutput = nullptr;
-    mAudioOutput->stop();
-    mAudioOutput->reset();
+    if(!mAudioOutput) return;
+    runOnAudioThread([this]() {
+        mAudioOutput->stop();
+        mAudioOutput->reset();
+        mRingDevice.close();
+    });
+    mFeeder.stopFeeding();
+    mPlayedUSecs = 0;
+}
+
+void AudioHandler::pauseAudio() {
+    if(!mAudioOutput) return;
+    runOnAudioThread([this]() {
+        mAudioOutput->suspend();
+        updatePlayedUSecs();
+    });
+}
+
+void AudioHandler::resumeAudio() {
+    if(!mAudioOutput) return;
+    runOnAudioThread([this]() { mAudioOutput->resume(); });
 }
 
 void AudioHandler::setVolume(const int value) {
-    if(mAudioOutput) mAudioOutput->setVolume(qreal(value)/100);
+    if(!mAudioOutput) return;
+    const qreal volume = qreal(value)/100;
+    QMetaObject::invokeMethod(&mAudioContext, [this, volume]() {
+        mAudioOutput->setVolume(volume);
+    }, Qt::QueuedConnection);
+}
+
+void AudioHandler::offerSecond(const stdsptr<Samples>& samples) {
+    if(mAudioOutput) mFeeder.offerSecond(samples);
+}
+
+void AudioHandler::updatePlayedUSecs() {
+    const int buffered = mAudioOutput->bufferSize() - mAudioOutput->bytesFree();
+    const qint64 bufferedUSecs = mAudioFormat.durationForBytes(qMax(0, buffered));
+    mPlayedUSecs = qMax(qint64(0), mAudioOutput->processedUSecs() - bufferedUSecs);
 }
@@ -17,47 +17,54 @@
 #ifndef AUDIOHANDLER_H
 #define AUDIOHANDLER_H
 #include <QAudioOutput>
+#include <functional>
+#include "audiofeeder.h"
 class eSoundSettingsData;
 
+//! @brief The output and its ring device live on a dedicated audio thread,
+//! stalls of the main thread do not starve the device.
 class AudioHandler : public QObject {
 public:
     AudioHandler();
+    ~AudioHandler();
 
     static AudioHandler* sInstance;
 
-    struct DataRequest {
-        char* fData;
-        int fSize;
-
-        operator bool() const {
-            return fSize > 0;
-        }
-    };
-
-    DataRequest dataRequest() {
-        if(mAudioOutput && mAudioOutput->state() != QAudio::StoppedState) {
-            if(mAudioOutput->bytesFree() >= mAudioOutput->periodSize())
-                return {mAudioBuffer.data(), mAudioOutput->periodSize()};
-        }
-        return {nullptr, 0};
-    }
-
-    void provideData(const DataRequest& request) {
-        if(!request || !mAudioIOOutput) return;
-        mAudioIOOutput->write(request.fData, request.fSize);
-    }
-
     void initializeAudio(const eSoundSettingsData &soundSettings);
-    void startAudio();
+    //! @brief Plays samples [firstSample, lastSample],
+    //! seconds are taken from the ones offered.
+    void startAudio(const int firstSample, const int lastSample);
     void stopAudio();
+    void pauseAudio();
+    void resumeAudio();
     void setVolume(const int value);
+
+    //! @brief Makes a rendered second available to the feeder thread.
+    void offerSecond(const stdsptr<Samples>& samples);
+
+    bool isAudioAvailable() const { return mAudioOutput; }
+    //! @brief Microseconds actually played by the device since startAudio,
+    //! excludes data still waiting in the device buffer.
+    qint64 playedUSecs() const { return mPlayedUSecs; }
 private:
+    //! @brief Runs func on the audio thread and waits for it to finish.
+    void runOnAudioThread(const std::function<void()>& func);
+    //! @brief Audio thread only.
+    void updatePlayedUSecs();
+
     QAudioDeviceInfo mAudioDevice;
-    QAudioOutput *mAudioOutput = nullptr;
-    QIODevice *mAudioIOOutput = nullptr; // not owned
     QAudioFormat mAudioFormat;
 
-    QByteArray mAudioBuffer;
+    QThread mAudioThread;
+    //! @brief Lives on mAudioThread, context for the queued calls
+    QObject mAudioContext;
+    //! @brief Created and used on mAudioThread only
+    QAudioOutput *mAudioOutput = nullptr;
+    std::atomic<qint64> mPlayedUSecs{0};
+
+    AudioRingBuffer mRing;
+    AudioFeeder mFeeder;
+    AudioRingDevice mRingDevice;
 };
 
 #endif // AUDIOHANDLER_H
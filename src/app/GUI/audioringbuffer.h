@@ -0,0 +1,88 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <QtGlobal>
+
+//! @brief Lock-free single producer, single consumer byte ring.
+//! Capacity has to be a power of two.
+class AudioRingBuffer {
+public:
+    AudioRingBuffer(const int capacity) :
+        mCapacity(capacity), mMask(capacity - 1),
+        mData(new char[static_cast<size_t>(capacity)]) {
+        Q_ASSERT((capacity & mMask) == 0);
+    }
+
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    int capacity() const { return mCapacity; }
+
+    int bytesAvailable() const {
+        const auto w = mWritePos.load(std::memory_order_acquire);
+        const auto r = mReadPos.load(std::memory_order_acquire);
+        return static_cast<int>(w - r);
+    }
+
+    int bytesFree() const { return mCapacity - bytesAvailable(); }
+
+    //! @brief Producer only, returns the number of bytes written.
+    int write(const char * const data, const int len) {
+        const auto w = mWritePos.load(std::memory_order_relaxed);
+        const auto r = mReadPos.load(std::memory_order_acquire);
+        const int n = qMin(len, mCapacity - static_cast<int>(w - r));
+        if(n <= 0) return 0;
+        const int start = static_cast<int>(w & mMask);
+        const int first = qMin(n, mCapacity - start);
+        memcpy(mData.get() + start, data, static_cast<size_t>(first));
+        memcpy(mData.get(), data + first, static_cast<size_t>(n - first));
+        mWritePos.store(w + n, std::memory_order_release);
+        return n;
+    }
+
+    //! @brief Consumer only, returns the number of bytes read.
+    int read(char * const data, const int len) {
+        const auto r = mReadPos.load(std::memory_order_relaxed);
+        const auto w = mWritePos.load(std::memory_order_acquire);
+        const int n = qMin(len, static_cast<int>(w - r));
+        if(n <= 0) return 0;
+        const int start = static_cast<int>(r & mMask);
+        const int first = qMin(n, mCapacity - start);
+        memcpy(data, mData.get() + start, static_cast<size_t>(first));
+        memcpy(data + first, mData.get(), static_cast<size_t>(n - first));
+        mReadPos.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+    //! @brief Neither the producer nor the consumer can be active.
+    void clear() {
+        mReadPos.store(0, std::memory_order_relaxed);
+        mWritePos.store(0, std::memory_order_relaxed);
+    }
+private:
+    const int mCapacity;
+    const int mMask;
+    const std::unique_ptr<char[]> mData;
+    alignas(64) std::atomic<qint64> mWritePos{0};
+    alignas(64) std::atomic<qint64> mReadPos{0};
+};
+
+#endif // AUDIORINGBUFFER_H
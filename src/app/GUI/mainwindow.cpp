@@ -660,6 +660,11 @@ void MainWindow::setupStatusBar() {
     mUsageWidget = new UsageWidget(this);
     mUsageWidget->setStyleSheet("QStatusBar { border-top: 1px solid black; }");
     setStatusBar(mUsageWidget);
+    connect(MemoryHandler::sInstance, &MemoryHandler::memoryChecked,
+            mUsageWidget, [this](const intKB memKb, const intKB totMemKb) {
+        mUsageWidget->setTotalRam(totMemKb.fValue/(1024*1024));
+        mUsageWidget->setRamUsage((totMemKb - memKb).fValue/(1024*1024));
+    });
 }
 
 void MainWindow::setupToolBar() {
@@ -76,6 +76,7 @@ SOURCES += main.cpp\
     GUI/Settings/settingsdialog.cpp \
     GUI/Settings/settingswidget.cpp \
     GUI/audiohandler.cpp \
+    GUI/audiofeeder.cpp \
     GUI/bookmarkedwidget.cpp \
     GUI/buttonbase.cpp \
     GUI/canvasbasewrappernode.cpp \
@@ -179,6 +180,8 @@ HEADERS  += \
     GUI/Settings/settingsdialog.h \
     GUI/Settings/settingswidget.h \
     GUI/audiohandler.h \
+    GUI/audiofeeder.h \
+    GUI/audioringbuffer.h \
     GUI/bookmarkedwidget.h \
     GUI/buttonbase.h \
     GUI/canvasbasewrappernode.h \
@@ -25,6 +25,7 @@
 EffectsLoader::EffectsLoader() {}
 
 EffectsLoader::~EffectsLoader() {
+    if(!mGpuInitialized) return;
     makeCurrent();
     glDeleteBuffers(1, &GL_PLAIN_SQUARE_VBO);
     glDeleteVertexArrays(1, &mPlainSquareVAO);
@@ -63,6 +64,7 @@ void EffectsLoader::initializeGpu() {
     OffscreenQGL33c::initialize();
     try {
         makeCurrent();
+        mGpuInitialized = true;
 
         try {
             iniPlainVShaderVBO(this);
@@ -43,6 +43,7 @@ private:
     void iniCustomRasterEffect(const QString &soPath);
     void iniIfCustomRasterEffect(const QString &path);
 
+    bool mGpuInitialized = false;
     QStringList mLoadedGREPaths;
     GLuint mPlainSquareVAO;
     GLuint mTexturedSquareVAO;
@@ -72,7 +72,12 @@ GpuVendor gpuVendor() {
 void HardwareInfo::sUpdateInfo() {
     mCpuThreads = QThread::idealThreadCount();
     mRamKB = getTotalRamBytes();
-    mGpuVendor = gpuVendor();
+    try {
+        mGpuVendor = gpuVendor();
+    } catch(const std::exception& e) {
+        qWarning() << "Could not detect gpu vendor:" << e.what();
+        mGpuVendor = GpuVendor::unrecognized;
+    }
     eSettings::sInstance->fRamKB = mRamKB;
     eSettings::sInstance->fCpuThreads = mCpuThreads;
     eSettings::sInstance->fGpuVendor = mGpuVendor;
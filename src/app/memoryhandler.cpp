@@ -16,11 +16,10 @@
 
 #include "memoryhandler.h"
 #include "Boxes/boxrendercontainer.h"
+#include "skia/pixelbufferpool.h"
 #include <gperftools/malloc_extension.h>
 #include <malloc.h>
-#include "GUI/mainwindow.h"
 #include <QMetaType>
-#include "GUI/usagewidget.h"
 
 MemoryHandler *MemoryHandler::sInstance = nullptr;
 Q_DECLARE_METATYPE(MemoryState)
@@ -69,18 +68,12 @@ void MemoryHandler::freeMemory(const MemoryState &state,
 
     if(minFreeBytes.fValue <= 0) return;
     long memToFree = minFreeBytes.fValue;
+    // idle pooled buffers go first, they hold no cached data
+    memToFree -= PixelBufferPool::sTrim(memToFree);
     while(memToFree > 0 && !mDataHandler.isEmpty()) {
-        const auto cont = mDataHandler.takeFirst();
+        const auto cont = mDataHandler.takeNextToFree();
         memToFree -= cont->free_RAM_k();
     }
     if(memToFree > 0/* || state == VERY_LOW_MEMORY_STATE*/) emit allMemoryUsed();
     emit memoryFreed();
 }
-
-void MemoryHandler::memoryChecked(const intKB memKb, const intKB totMemKb) {
-    if(!MainWindow::sGetInstance()) return;
-    const auto usageWidget = MainWindow::sGetInstance()->getUsageWidget();
-    if(!usageWidget) return;
-    usageWidget->setTotalRam(totMemKb.fValue/(1024*1024));
-    usageWidget->setRamUsage((totMemKb - memKb).fValue/(1024*1024));
-}
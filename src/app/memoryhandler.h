@@ -30,9 +30,9 @@ public:
 signals:
     void allMemoryUsed();
     void memoryFreed();
+    void memoryChecked(const intKB memKb, const intKB totMemKb);
 private:
     void freeMemory(const MemoryState &state, const longB &minFreeBytes);
-    void memoryChecked(const intKB memKb, const intKB totMemKb);
 
     MemoryDataHandler mDataHandler;
     MemoryState mCurrentMemoryState = NORMAL_MEMORY_STATE;
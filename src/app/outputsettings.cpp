@@ -126,6 +126,9 @@ void OutputSettingsProfile::save() {
 
             stream << "Video bitrate: ";
             stream << QString::number(mSettings.videoBitrate) << endl;
+
+            stream << "Video threads: ";
+            stream << QString::number(mSettings.videoThreads) << endl;
         }
 
         stream << "Audio enabled: ";
@@ -183,6 +186,8 @@ void OutputSettingsProfile::load(const QString &path) {
                             val.toUtf8().data());
             } else if(var == "Video bitrate") {
                 mSettings.videoBitrate = val.toInt();
+            } else if(var == "Video threads") {
+                mSettings.videoThreads = val.toInt();
             } else if(var == "Audio enabled") {
                 mSettings.audioEnabled = (val == "true");
             } else if(var == "Audio codec") {
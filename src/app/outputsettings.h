@@ -43,6 +43,8 @@ struct OutputSettings {
     const AVCodec *videoCodec = nullptr;
     AVPixelFormat videoPixelFormat = AV_PIX_FMT_NONE;
     int videoBitrate = 0;
+    //! @brief Encoder frame/slice threads, 0 picks automatically
+    int videoThreads = 0;
 
     bool audioEnabled = false;
     const AVCodec *audioCodec = nullptr;
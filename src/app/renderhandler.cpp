@@ -40,10 +40,9 @@ RenderHandler::RenderHandler(Document &document,
             this, &RenderHandler::outOfMemory);
 
     mPreviewFPSTimer = new QTimer(this);
+    mPreviewFPSTimer->setTimerType(Qt::PreciseTimer);
     connect(mPreviewFPSTimer, &QTimer::timeout,
             this, &RenderHandler::nextPreviewFrame);
-    connect(mPreviewFPSTimer, &QTimer::timeout,
-            this, &RenderHandler::audioPushTimerExpired);
 
     const auto vidEmitter = videoEncoder.getEmitter();
 //    connect(vidEmitter, &VideoEncoderEmitter::encodingStarted,
@@ -56,6 +55,10 @@ RenderHandler::RenderHandler(Document &document,
             this, &RenderHandler::interruptOutputRendering);
     connect(vidEmitter, &VideoEncoderEmitter::encodingStartFailed,
             this, &RenderHandler::interruptOutputRendering);
+    connect(vidEmitter, &VideoEncoderEmitter::queueSpaceAvailable,
+            this, [this]() {
+        if(mCurrentRenderSettings) nextSaveOutputFrame();
+    });
 }
 
 void RenderHandler::renderFromSettings(RenderInstanceSettings * const settings) {
@@ -80,34 +83,55 @@ void RenderHandler::renderFromSettings(RenderInstanceSettings * const settings)
         TaskScheduler::sSetFreeThreadsForCpuTasksAvailableFunc(nextFrameFunc);
         TaskScheduler::sSetAllTasksFinishedFunc(nextFrameFunc);
 
-        mCurrentRenderFrame = renderSettings.fMinFrame;
-        mCurrRenderRange = {mCurrentRenderFrame, mCurrentRenderFrame};
+        mCurrentEncodeFrame = renderSettings.fMinFrame;
+        // nothing scheduled yet
+        mCurrentRenderFrame = mCurrentEncodeFrame - 1;
+        mCurrRenderRange = {mCurrentEncodeFrame, mCurrentEncodeFrame};
 
-        mCurrentEncodeFrame = mCurrentRenderFrame;
-        mFirstEncodeSoundSecond = qFloor(mCurrentRenderFrame/fps);
+        mFirstEncodeSoundSecond = qFloor(mCurrentEncodeFrame/fps);
         mCurrentEncodeSoundSecond = mFirstEncodeSoundSecond;
         if(!VideoEncoder::sEncodeAudio())
             mMaxSoundSec = mCurrentEncodeSoundSecond - 1;
-        mCurrentScene->setMinFrameUseRange(mCurrentRenderFrame);
-        mCurrentSoundComposition->setMinFrameUseRange(mCurrentRenderFrame);
-        mCurrentSoundComposition->scheduleFrameRange({mCurrentRenderFrame,
-                                                      mCurrentRenderFrame});
-        mCurrentScene->anim_setAbsFrame(mCurrentRenderFrame);
+        mCurrentScene->setMinFrameUseRange(mCurrentEncodeFrame);
+        mCurrentSoundComposition->setMinFrameUseRange(mCurrentEncodeFrame);
         mCurrentScene->setOutputRendering(true);
         TaskScheduler::sInstance->setAlwaysQue(true);
         //fitSceneToSize();
         if(!isZero6Dec(mSavedResolutionFraction - resolutionFraction)) {
             mCurrentScene->setResolutionFraction(resolutionFraction);
-            mDocument.actionFinished();
-        } else {
-            nextCurrentRenderFrame();
-            if(TaskScheduler::sAllQuedCpuTasksFinished()) {
-                nextSaveOutputFrame();
-            }
+        }
+        queOutputFrames();
+        mDocument.actionFinished();
+        if(TaskScheduler::sAllQuedCpuTasksFinished()) {
+            nextSaveOutputFrame();
         }
     }
 }
 
+void RenderHandler::queOutputFrames() {
+    const int framesInFlight = eSettings::sOutputFramesInFlight();
+    const int lastFrame = qMin(mMaxRenderFrame,
+                               mCurrentEncodeFrame + framesInFlight - 1);
+    if(mCurrentRenderFrame >= lastFrame) return;
+    const int firstFrame = mCurrentRenderFrame + 1;
+    int frame = firstFrame;
+    // render data is set up for the given frame,
+    // the current scene frame is never changed
+    while(frame <= lastFrame) {
+        mCurrentScene->queOutputFrame(frame);
+        const auto idRange = mCurrentScene->prp_getIdenticalRelRange(frame);
+        frame = qMax(frame, idRange.fMax) + 1;
+    }
+    const int newCurrentRenderFrame = qMin(mMaxRenderFrame, frame - 1);
+    mCurrentSoundComposition->scheduleFrameRange({firstFrame,
+                                                  newCurrentRenderFrame});
+    mCurrentSoundComposition->setMaxFrameUseRange(newCurrentRenderFrame);
+    mCurrentScene->setMaxFrameUseRange(newCurrentRenderFrame);
+
+    mCurrentRenderFrame = newCurrentRenderFrame;
+    mCurrRenderRange.fMax = mCurrentRenderFrame;
+}
+
 void RenderHandler::setFrameAction(const int frame) {
     if(mCurrentScene) mCurrentScene->anim_setAbsFrame(frame);
     mDocument.actionFinished();
@@ -213,12 +237,17 @@ void RenderHandler::stopPreview() {
 void RenderHandler::pausePreview() {
     if(mPreviewing) {
         mPreviewFPSTimer->stop();
+        mPreviewElapsedMs += mPreviewTimer.elapsed();
+        mPreviewTimer.invalidate();
+        mAudioHandler.pauseAudio();
         emit previewPaused();
     }
 }
 
 void RenderHandler::resumePreview() {
     if(mPreviewing) {
+        mAudioHandler.resumeAudio();
+        mPreviewTimer.start();
         mPreviewFPSTimer->start();
         emit previewBeingPlayed();
     }
@@ -246,6 +275,7 @@ void RenderHandler::playPreview() {
     const int maxPreviewFrame = qMin(mMaxRenderFrame, mCurrentRenderFrame);
     if(minPreviewFrame >= maxPreviewFrame) return;
     mMaxPreviewFrame = maxPreviewFrame;
+    mFirstPreviewFrame = minPreviewFrame;
     mCurrentPreviewFrame = minPreviewFrame;
     mCurrentScene->setSceneFrame(mCurrentPreviewFrame);
     mCurrentScene->setPreviewing(true);
@@ -254,7 +284,10 @@ void RenderHandler::playPreview() {
     setPreviewing(true);
 
     startAudio();
-    const int mSecInterval = qRound(1000/mCurrentScene->getFps());
+    mPreviewElapsedMs = 0;
+    mPreviewTimer.start();
+    // frames follow the clock, poll it twice per frame
+    const int mSecInterval = qMax(1, qRound(500/mCurrentScene->getFps()));
     mPreviewFPSTimer->setInterval(mSecInterval);
     mPreviewFPSTimer->start();
     emit previewBeingPlayed();
@@ -280,7 +313,12 @@ void RenderHandler::clearPreview() {
 
 void RenderHandler::nextPreviewFrame() {
     if(!mCurrentScene) return;
-    mCurrentPreviewFrame++;
+    const qreal fps = mCurrentScene->getFps();
+    const int clockFrame = mFirstPreviewFrame + qFloor(previewSeconds()*fps);
+    // hold the current frame until the clock reaches the next one,
+    // late frames are skipped
+    if(clockFrame <= mCurrentPreviewFrame) return;
+    mCurrentPreviewFrame = clockFrame;
     if(mCurrentPreviewFrame > mMaxPreviewFrame) {
         clearPreview();
     } else {
@@ -309,6 +347,8 @@ void RenderHandler::nextSaveOutputFrame() {
     const qreal fps = mCurrentScene->getFps();
     const int sampleRate = eSoundSettings::sSampleRate();
     while(mCurrentEncodeSoundSecond <= mMaxSoundSec) {
+        // resumed on VideoEncoderEmitter::queueSpaceAvailable
+        if(VideoEncoder::sAudioQueueFull()) break;
         const auto cont = sCacheHandler.atFrame(mCurrentEncodeSoundSecond);
         if(!cont) break;
         const auto sCont = cont->ref<SoundCacheContainer>();
@@ -328,14 +368,16 @@ void RenderHandler::nextSaveOutputFrame() {
 
     const auto& cacheHandler = mCurrentScene->getSceneFramesHandler();
     while(mCurrentEncodeFrame <= mMaxRenderFrame) {
+        if(VideoEncoder::sVideoQueueFull()) break;
         const auto cont = cacheHandler.atFrame(mCurrentEncodeFrame);
         if(!cont) break;
         VideoEncoder::sAddCacheContainerToEncoder(cont->ref<SceneFrameContainer>());
         mCurrentEncodeFrame = cont->getRangeMax() + 1;
     }
 
-    //mCurrentScene->renderCurrentFrameToOutput(*mCurrentRenderSettings);
-    if(mCurrentRenderFrame >= mMaxRenderFrame) {
+    mCurrentRenderSettings->setCurrentRenderFrame(
+                qMin(mCurrentEncodeFrame, mMaxRenderFrame));
+    if(mCurrentEncodeFrame > mMaxRenderFrame) {
         if(mCurrentEncodeSoundSecond <= mMaxSoundSec) return;
         TaskScheduler::sSetFreeThreadsForCpuTasksAvailableFunc(nullptr);
         Document::sInstance->actionFinished();
@@ -347,8 +389,10 @@ void RenderHandler::nextSaveOutputFrame() {
             });
         }
     } else {
-        mCurrentRenderSettings->setCurrentRenderFrame(mCurrentRenderFrame);
-        nextCurrentRenderFrame();
+        const int prevRenderFrame = mCurrentRenderFrame;
+        queOutputFrames();
+        if(prevRenderFrame == mCurrentRenderFrame) return;
+        Document::sInstance->actionFinished();
         if(TaskScheduler::sAllTasksFinished()) {
             nextSaveOutputFrame();
         }
@@ -356,22 +400,45 @@ void RenderHandler::nextSaveOutputFrame() {
 }
 
 void RenderHandler::startAudio() {
-    mAudioHandler.startAudio();
+    const qreal fps = mCurrentScene->getFps();
+    const int sampleRate = eSoundSettings::sSampleRate();
+    const int firstSample = qRound(mCurrentPreviewFrame*sampleRate/fps);
+    const int maxSample = qRound((mMaxPreviewFrame + 1)*sampleRate/fps);
+    mAudioClock = mCurrentSoundComposition &&
+                  mCurrentSoundComposition->hasAnySounds() &&
+                  mAudioHandler.isAudioAvailable();
     if(mCurrentSoundComposition) mCurrentSoundComposition->start(mCurrentPreviewFrame);
+    if(!mAudioClock) return;
+    mAudioHandler.startAudio(firstSample, maxSample);
+    // the feeder thread takes the seconds it needs from the offered ones
+    // and fills the missing ones with silence itself
+    const auto& sCacheHandler = mCurrentSoundComposition->getCacheHandler();
+    const int firstSecond = qFloor(qreal(firstSample)/sampleRate);
+    const int maxSecond = qFloor(qreal(maxSample)/sampleRate);
+    for(int sec = firstSecond; sec <= maxSecond; sec++) {
+        const auto cont = sCacheHandler.atFrame(sec);
+        if(!cont) continue;
+        const auto samples = cont->ref<SoundCacheContainer>()->getSamples();
+        mAudioHandler.offerSecond(samples);
+    }
+    mCurrentSoundComposition->setSecondReadyFunc(
+                [this](const stdsptr<Samples>& samples) {
+        mAudioHandler.offerSecond(samples);
+    });
 }
 
 void RenderHandler::stopAudio() {
+    mAudioClock = false;
+    if(mCurrentSoundComposition) {
+        mCurrentSoundComposition->setSecondReadyFunc(nullptr);
+    }
     mAudioHandler.stopAudio();
     if(mCurrentSoundComposition) mCurrentSoundComposition->stop();
 }
 
-void RenderHandler::audioPushTimerExpired() {
-    if(!mCurrentSoundComposition) return;
-    while(auto request = mAudioHandler.dataRequest()) {
-        const qint64 len = mCurrentSoundComposition->read(
-                    request.fData, request.fSize);
-        if(len <= 0) break;
-        request.fSize = int(len);
-        mAudioHandler.provideData(request);
-    }
+qreal RenderHandler::previewSeconds() const {
+    if(mAudioClock) return mAudioHandler.playedUSecs()*0.000001;
+    qint64 elapsedMs = mPreviewElapsedMs;
+    if(mPreviewTimer.isValid()) elapsedMs += mPreviewTimer.elapsed();
+    return elapsedMs*0.001;
 }
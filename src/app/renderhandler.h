@@ -16,6 +16,7 @@
 
 #ifndef RENDERHANDLER_H
 #define RENDERHANDLER_H
+#include <QElapsedTimer>
 #include "framerange.h"
 #include "GUI/audiohandler.h"
 #include "smartPointers/ememory.h"
@@ -63,6 +64,9 @@ private:
     void playPreviewAfterAllTasksCompleted();
 
     void nextSaveOutputFrame();
+    //! @brief Keeps up to eSettings::sOutputFramesInFlight() output frames
+    //! scheduled ahead of the next frame to be encoded.
+    void queOutputFrames();
     void nextPreviewRenderFrame();
     void nextPreviewFrame();
     void nextCurrentRenderFrame();
@@ -71,10 +75,15 @@ private:
     void setPreviewing(const bool bT);
     void clearPreview();
 
+    //! @brief Offers the cached seconds to the audio feeder,
+    //! seconds finished later are offered as they come.
     void startAudio();
-    void audioPushTimerExpired();
     void stopAudio();
 
+    //! @brief Seconds played since the preview started,
+    //! the audio clock is used when there is sound to play.
+    qreal previewSeconds() const;
+
     Document& mDocument;
 
     // AUDIO
@@ -87,9 +96,14 @@ private:
     QTimer *mPreviewFPSTimer = nullptr;
     RenderInstanceSettings *mCurrentRenderSettings = nullptr;
 
+    int mFirstPreviewFrame;
     int mCurrentPreviewFrame;
     int mMaxPreviewFrame;
 
+    bool mAudioClock = false;
+    QElapsedTimer mPreviewTimer;
+    qint64 mPreviewElapsedMs = 0;
+
     //! @brief true if preview is currently playing
     bool mPreviewing = false;
     //! @brief true if currently preview is being rendered
@@ -37,23 +37,94 @@ VideoEncoder *VideoEncoder::sInstance = nullptr;
 VideoEncoder::VideoEncoder() {
     Q_ASSERT(!sInstance);
     sInstance = this;
+
+    mExecController = new EncoderExecController;
+    QObject::connect(mExecController, &ExecController::finishedTaskSignal,
+                     &mEmitter, [](const stdsptr<eTask>& task) {
+        task->finishedProcessing();
+    });
+    QObject::connect(&mEmitter, &VideoEncoderEmitter::dataEncoded,
+                     &mEmitter, [this]() { releaseEncoded(); },
+                     Qt::QueuedConnection);
+}
+
+VideoEncoder::~VideoEncoder() {
+    mExecController->quit();
+    mExecController->wait();
+    delete mExecController;
+}
+
+void VideoEncoder::queTaskNow() {
+    aboutToProcess(Hardware::cpu);
+    mExecController->processTask(ref<eTask>());
 }
 
 void VideoEncoder::addContainer(const stdsptr<SceneFrameContainer>& cont) {
     if(!cont) return;
-    mNextContainers.append(cont);
-    if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mNextContainers.append(cont);
+    }
+    mQueueChanged.wakeAll();
+    mQueuedFrames++;
+    mStats.fMaxQueuedFrames = qMax(mStats.fMaxQueuedFrames, mQueuedFrames);
+    mQueueDepthSum += mQueuedFrames;
+    mQueueDepthCount++;
 }
 
 void VideoEncoder::addContainer(const stdsptr<Samples>& cont) {
     if(!cont) return;
-    mNextSoundConts.append(cont);
-    if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mNextSoundConts.append(cont);
+    }
+    mQueueChanged.wakeAll();
+    mQueuedSamples += cont->fSampleRange.span();
 }
 
 void VideoEncoder::allAudioProvided() {
-    mAllAudioProvided = true;
-    if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mAllAudioProvided = true;
+    }
+    mQueueChanged.wakeAll();
+}
+
+bool VideoEncoder::videoQueueFull() {
+    const bool full = mQueuedFrames >= sMaxQueuedFrames;
+    if(full && !mRenderBlockedTimer.isValid()) mRenderBlockedTimer.start();
+    return full;
+}
+
+bool VideoEncoder::audioQueueFull() {
+    if(!mEncodeAudio) return false;
+    const qint64 queued = mQueuedSamples - mEncodedSamples;
+    const qint64 maxQueued = qint64(sMaxQueuedSeconds)*
+                             mInSoundSettings.fSampleRate;
+    const bool full = queued >= maxQueued;
+    if(full && !mRenderBlockedTimer.isValid()) mRenderBlockedTimer.start();
+    return full;
+}
+
+void VideoEncoder::interruptCurrentEncoding() {
+    if(isActive()) {
+        {
+            QMutexLocker lock(&mQueueMutex);
+            mInterruptEncoding = true;
+        }
+        mQueueChanged.wakeAll();
+    } else interrupEncoding();
+}
+
+void VideoEncoder::finishCurrentEncoding() {
+    if(!mCurrentlyEncoding) return;
+    if(isActive()) {
+        {
+            QMutexLocker lock(&mQueueMutex);
+            mEncodingFinished = true;
+        }
+        mQueueChanged.wakeAll();
+    } else finishEncodingSuccess();
 }
 
 static AVFrame *allocPicture(enum AVPixelFormat pix_fmt,
@@ -72,6 +143,85 @@ static AVFrame *allocPicture(enum AVPixelFormat pix_fmt,
     return picture;
 }
 
+//! @brief Gives the frame its own buffers if the encoder still references
+//! the current ones. The frame contents are not preserved.
+static void makeFrameWritable(AVFrame * const frame) {
+    if(av_frame_is_writable(frame)) return;
+    const int format = frame->format;
+    const int width = frame->width;
+    const int height = frame->height;
+    const int nbSamples = frame->nb_samples;
+    const uint64_t channelLayout = frame->channel_layout;
+    const int channels = frame->channels;
+    const int sampleRate = frame->sample_rate;
+    av_frame_unref(frame);
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->nb_samples = nbSamples;
+    frame->channel_layout = channelLayout;
+    frame->channels = channels;
+    frame->sample_rate = sampleRate;
+    const int ret = av_frame_get_buffer(frame, 32);
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not allocate frame data")
+}
+
+static void writePacket(AVFormatContext * const oc,
+                        OutputStream * const ost,
+                        AVPacket * const pkt) {
+    av_packet_rescale_ts(pkt, ost->fCodec->time_base, ost->fStream->time_base);
+    pkt->stream_index = ost->fStream->index;
+
+    // Write the compressed frame to the media file.
+    const int interRet = av_interleaved_write_frame(oc, pkt);
+    if(interRet < 0) AV_RuntimeThrow(interRet, "Error while writing encoded frame")
+}
+
+//! @brief Writes all the packets the encoder has ready,
+//! returns false once the encoder is fully drained
+static bool writeEncodedPackets(AVFormatContext * const oc,
+                                OutputStream * const ost) {
+    AVCodecContext * const c = ost->fCodec;
+    while(true) {
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        pkt.data = nullptr;
+        pkt.size = 0;
+
+        const int recRet = avcodec_receive_packet(c, &pkt);
+        if(recRet == AVERROR(EAGAIN)) return true;
+        else if(recRet == AVERROR_EOF) return false;
+        else if(recRet < 0) AV_RuntimeThrow(recRet, "Error encoding a frame")
+
+        const auto repeat = ost->fPacketRepeats.find(pkt.pts);
+        if(repeat == ost->fPacketRepeats.end()) {
+            writePacket(oc, ost, &pkt);
+            continue;
+        }
+        // held frame of an intra-only codec, duplicate the packet
+        const int repeats = repeat->second;
+        ost->fPacketRepeats.erase(repeat);
+        AVPacket src;
+        av_init_packet(&src);
+        const int refRet = av_packet_ref(&src, &pkt);
+        writePacket(oc, ost, &pkt);
+        if(refRet < 0) AV_RuntimeThrow(refRet, "Could not duplicate packet")
+        for(int i = 1; i <= repeats; i++) {
+            AVPacket dupl;
+            av_init_packet(&dupl);
+            const int duplRet = av_packet_ref(&dupl, &src);
+            if(duplRet < 0) {
+                av_packet_unref(&src);
+                AV_RuntimeThrow(duplRet, "Could not duplicate packet")
+            }
+            if(dupl.pts != AV_NOPTS_VALUE) dupl.pts += i;
+            if(dupl.dts != AV_NOPTS_VALUE) dupl.dts += i;
+            writePacket(oc, ost, &dupl);
+        }
+        av_packet_unref(&src);
+    }
+}
+
 static void openVideo(const AVCodec * const codec, OutputStream * const ost) {
     AVCodecContext * const c = ost->fCodec;
     ost->fNextPts = 0;
@@ -79,6 +229,9 @@ static void openVideo(const AVCodec * const codec, OutputStream * const ost) {
     int ret = avcodec_open2(c, codec, nullptr);
     if(ret < 0) AV_RuntimeThrow(ret, "Could not open codec")
 
+    const auto desc = avcodec_descriptor_get(c->codec_id);
+    ost->fIntraOnly = desc && (desc->props & AV_CODEC_PROP_INTRA_ONLY);
+
     /* Allocate the encoded raw picture. */
     ost->fDstFrame = allocPicture(c->pix_fmt, c->width, c->height);
     if(!ost->fDstFrame) RuntimeThrow("Could not allocate picture");
@@ -125,6 +278,10 @@ static void addVideoStream(OutputStream * const ost,
 
     c->gop_size      = 12; /* emit one intra frame every twelve frames at most */
     c->pix_fmt       = outSettings.videoPixelFormat;//RGBA;
+    /* Let the codec use whichever threading it supports,
+     * zero threads picks the count automatically. */
+    c->thread_count  = qMax(0, outSettings.videoThreads);
+    c->thread_type   = FF_THREAD_FRAME | FF_THREAD_SLICE;
     if(c->codec_id == AV_CODEC_ID_MPEG2VIDEO) {
         /* just for testing, we also add B-frames */
         c->max_b_frames = 2;
@@ -148,8 +305,7 @@ static void copyImageToFrame(AVFrame * const pict,
      * internally;
      * make sure we do not overwrite it here
      */
-    const int ret = av_frame_make_writable(pict);
-    if(ret < 0) AV_RuntimeThrow(ret, "Could not make AVFrame writable")
+    makeFrameWritable(pict);
 
     SkPixmap pixmap;
     skiaImg->peekPixels(&pixmap);
@@ -169,7 +325,7 @@ static void copyImageToFrame(AVFrame * const pict,
     }
 }
 
-static AVFrame *getVideoFrame(OutputStream * const ost,
+static void convertVideoFrame(OutputStream * const ost,
                               const sk_sp<SkImage> &image) {
     AVCodecContext *c = ost->fCodec;
 
@@ -196,9 +352,7 @@ static AVFrame *getVideoFrame(OutputStream * const ost,
         int linesizesSk[4];
 
         av_image_fill_linesizes(linesizesSk, AV_PIX_FMT_RGBA, image->width());
-        const int ret = av_frame_make_writable(ost->fDstFrame) ;
-        if(ret < 0)
-            AV_RuntimeThrow(ret, "Could not make AVFrame writable")
+        makeFrameWritable(ost->fDstFrame);
 
         sws_scale(ost->fSwsCtx, dstSk,
                   linesizesSk, 0, c->height, ost->fDstFrame->data,
@@ -210,51 +364,38 @@ static AVFrame *getVideoFrame(OutputStream * const ost,
             RuntimeThrow("Failed to copy image to frame");
         }
     }
-
-    ost->fDstFrame->pts = ost->fNextPts++;
-
-    return ost->fDstFrame;
 }
 
+/* convert is false if fDstFrame already holds the image, repeats is the
+ * number of following frames the encoded packet is to be duplicated for
+ */
 static void writeVideoFrame(AVFormatContext * const oc,
                             OutputStream * const ost,
                             const sk_sp<SkImage> &image,
-                            bool * const encodeVideo) {
+                            const bool convert, const int repeats) {
     AVCodecContext * const c = ost->fCodec;
 
-    AVFrame * frame;
-    try {
-        frame = getVideoFrame(ost, image);
-    } catch(...) {
-        RuntimeThrow("Failed to retrieve video frame");
+    if(convert) {
+        try {
+            convertVideoFrame(ost, image);
+        } catch(...) {
+            RuntimeThrow("Failed to retrieve video frame");
+        }
     }
 
+    // reference the converted frame,
+    // the encoder may hold on to it for lookahead
+    AVFrame * frame = av_frame_clone(ost->fDstFrame);
+    if(!frame) RuntimeThrow("Could not reference video frame");
+    frame->pts = ost->fNextPts;
+    if(repeats > 0) ost->fPacketRepeats[frame->pts] = repeats;
+    ost->fNextPts += 1 + repeats;
 
-    // encode the image
     const int ret = avcodec_send_frame(c, frame);
+    av_frame_free(&frame);
     if(ret < 0) AV_RuntimeThrow(ret, "Error submitting a frame for encoding")
 
-    while(ret >= 0) {
-        AVPacket pkt;
-        av_init_packet(&pkt);
-
-        const int recRet = avcodec_receive_packet(c, &pkt);
-        if(recRet >= 0) {
-            av_packet_rescale_ts(&pkt, c->time_base, ost->fStream->time_base);
-            pkt.stream_index = ost->fStream->index;
-
-            // Write the compressed frame to the media file.
-            const int interRet = av_interleaved_write_frame(oc, &pkt);
-            if(interRet < 0) AV_RuntimeThrow(interRet, "Error while writing video frame")
-        } else if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) {
-            *encodeVideo = ret != AVERROR_EOF;
-            break;
-        } else {
-            AV_RuntimeThrow(recRet, "Error encoding a video frame")
-        }
-
-        av_packet_unref(&pkt);
-    }
+    writeEncodedPackets(oc, ost);
 }
 
 static void addAudioStream(OutputStream * const ost,
@@ -378,8 +519,8 @@ static void openAudio(const AVCodec * const codec, OutputStream * const ost,
     if(parRet < 0) AV_RuntimeThrow(parRet, "Could not copy the stream parameters")
 }
 
-/* if a frame is provided, send it to the encoder, otherwise flush the encoder;
- * return 1 when encoding is finished, 0 otherwise
+/* send the frame to the encoder and write the packets it has ready;
+ * encodeAudio is set to false once the encoder is drained
  */
 static void encodeAudioFrame(AVFormatContext * const oc,
                              OutputStream * const ost,
@@ -388,31 +529,14 @@ static void encodeAudioFrame(AVFormatContext * const oc,
     const int ret = avcodec_send_frame(ost->fCodec, frame);
     if(ret < 0) AV_RuntimeThrow(ret, "Error submitting a frame for encoding")
 
-    while(true) {
-        AVPacket pkt;
-        av_init_packet(&pkt);
-
-        const int recRet = avcodec_receive_packet(ost->fCodec, &pkt);
-        if(recRet >= 0) {
-            av_packet_rescale_ts(&pkt, ost->fCodec->time_base, ost->fStream->time_base);
-            pkt.stream_index = ost->fStream->index;
-
-            /* Write the compressed frame to the media file. */
-            const int interRet = av_interleaved_write_frame(oc, &pkt);
-            if(interRet < 0) AV_RuntimeThrow(interRet, "Error while writing audio frame")
-        } else if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) {
-            *encodeAudio = recRet == AVERROR(EAGAIN);
-            break;
-        } else {
-            AV_RuntimeThrow(recRet, "Error encoding an audio frame")
-        }
-    }
+    *encodeAudio = writeEncodedPackets(oc, ost);
 }
 
 static void processAudioStream(AVFormatContext * const oc,
                                OutputStream * const ost,
                                SoundIterator &iterator,
                                bool * const audioEnabled) {
+    makeFrameWritable(ost->fSrcFrame);
     iterator.fillFrame(ost->fSrcFrame);
     bool gotOutput = ost->fSrcFrame;
 
@@ -518,6 +642,7 @@ void VideoEncoder::startEncodingNow() {
 
 bool VideoEncoder::startEncoding(RenderInstanceSettings * const settings) {
     if(mCurrentlyEncoding) return false;
+    if(isActive()) return false;
     mRenderInstanceSettings = settings;
     mRenderInstanceSettings->renderingAboutToStart();
     mOutputSettings = mRenderInstanceSettings->getOutputRenderSettings();
@@ -526,12 +651,22 @@ bool VideoEncoder::startEncoding(RenderInstanceSettings * const settings) {
 
     mOutputFormat = mOutputSettings.outputFormat;
     mSoundIterator = SoundIterator();
+    mQueuedFrames = 0;
+    mQueuedSamples = 0;
+    mEncodedSamples = 0;
+    mQueueDepthSum = 0;
+    mQueueDepthCount = 0;
+    mRenderBlockedTimer.invalidate();
+    mStats = VideoEncoderStats();
     try {
         startEncodingNow();
         mCurrentlyEncoding = true;
         mEncodingFinished = false;
+        mInterruptEncoding = false;
         mRenderInstanceSettings->setCurrentState(RenderState::rendering);
         mEmitter.encodingStarted();
+        // the encoder thread waits for data until the encoding ends
+        queTask();
         return true;
     } catch(const std::exception& e) {
         gPrintExceptionCritical(e);
@@ -552,6 +687,7 @@ void VideoEncoder::finishEncodingSuccess() {
     mRenderInstanceSettings->setCurrentState(RenderState::finished);
     mEncodingSuccesfull = true;
     finishEncodingNow();
+    printStats();
     mEmitter.encodingFinished();
 }
 
@@ -559,27 +695,13 @@ static void flushStream(OutputStream * const ost,
                         AVFormatContext * const formatCtx) {
     if(!ost) return;
     if(!ost->fCodec) return;
-    AVPacket pkt;
-    av_init_packet(&pkt);
-    int ret = avcodec_send_frame(ost->fCodec, nullptr);
-    while(ret >= 0) {
-        ret = avcodec_receive_packet(ost->fCodec, &pkt);
-        if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            // Write packet
-            avcodec_flush_buffers(ost->fCodec);
-            break;
-        }
-        if(pkt.pts != AV_NOPTS_VALUE)
-            pkt.pts = av_rescale_q(pkt.pts, ost->fCodec->time_base,
-                                   ost->fStream->time_base);
-        if(pkt.dts != AV_NOPTS_VALUE)
-            pkt.dts = av_rescale_q(pkt.dts, ost->fCodec->time_base,
-                                   ost->fStream->time_base);
-        if(pkt.duration > 0)
-            pkt.duration = av_rescale_q(pkt.duration, ost->fCodec->time_base,
-                                        ost->fStream->time_base);
-        pkt.stream_index = ost->fStream->index;
-        ret = av_interleaved_write_frame(formatCtx, &pkt);
+    // enter draining mode and write out the delayed packets
+    const int ret = avcodec_send_frame(ost->fCodec, nullptr);
+    if(ret < 0) return;
+    try {
+        writeEncodedPackets(formatCtx, ost);
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
     }
 }
 
@@ -624,8 +746,16 @@ void VideoEncoder::finishEncodingNow() {
     mEncodeVideo = false;
     mCurrentlyEncoding = false;
     mEncodingSuccesfull = false;
-    mNextContainers.clear();
-    mNextSoundConts.clear();
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mNextContainers.clear();
+        mNextSoundConts.clear();
+        mEncoded.clear();
+    }
+    mQueuedFrames = 0;
+    updateRenderBlocked();
+    if(mQueueDepthCount > 0)
+        mStats.fAvgQueuedFrames = qreal(mQueueDepthSum)/mQueueDepthCount;
     clearContainers();
 
     eSoundSettings::sRestore();
@@ -637,106 +767,170 @@ void VideoEncoder::clearContainers() {
 }
 
 void VideoEncoder::process() {
-    bool hasVideo = !_mContainers.isEmpty(); // local encode
-    bool hasAudio;
-    if(mEncodeAudio) {
-        if(_mAllAudioProvided) {
-            hasAudio = mSoundIterator.hasValue();
-        } else {
-            hasAudio = mSoundIterator.hasSamples(mAudioStream.fSrcFrame->nb_samples);
-        }
-    } else hasAudio = false;
-    while((mEncodeVideo && hasVideo) || (mEncodeAudio && hasAudio)) {
-        bool videoAligned = true;
-        if(mEncodeVideo && mEncodeAudio) {
-            videoAligned = av_compare_ts(mVideoStream.fNextPts,
-                                         mVideoStream.fCodec->time_base,
-                                         mAudioStream.fNextPts,
-                                         mAudioStream.fCodec->time_base) <= 0;
-        }
-        const bool encodeVideo = mEncodeVideo && hasVideo && videoAligned;
-        if(encodeVideo) {
-            const auto cacheCont = _mContainers.at(_mCurrentContainerId);
-            const auto contRage = cacheCont->getRange()*_mRenderRange;
-            const int nFrames = contRage.span();
-            try {
-                writeVideoFrame(mFormatContext, &mVideoStream,
-                                cacheCont->getImageSk(), &hasVideo);
-                avcodec_flush_buffers(mVideoStream.fCodec);
-            } catch(...) {
-                RuntimeThrow("Failed to write video frame");
+    while(takeQueued()) {
+        bool hasVideo = !_mContainers.isEmpty(); // local encode
+        bool hasAudio;
+        if(mEncodeAudio) {
+            if(_mAllAudioProvided) {
+                hasAudio = mSoundIterator.hasValue();
+            } else {
+                hasAudio = mSoundIterator.hasSamples(mAudioStream.fSrcFrame->nb_samples);
             }
-            if(++_mCurrentContainerFrame >= nFrames) {
-                _mCurrentContainerId++;
-                _mCurrentContainerFrame = 0;
-                hasVideo = _mCurrentContainerId < _mContainers.count();
+        } else hasAudio = false;
+        while((mEncodeVideo && hasVideo) || (mEncodeAudio && hasAudio)) {
+            bool videoAligned = true;
+            if(mEncodeVideo && mEncodeAudio) {
+                videoAligned = av_compare_ts(mVideoStream.fNextPts,
+                                             mVideoStream.fCodec->time_base,
+                                             mAudioStream.fNextPts,
+                                             mAudioStream.fCodec->time_base) <= 0;
             }
-        }
-        bool audioAligned = true;
-        if(mEncodeVideo && mEncodeAudio) {
-            audioAligned = av_compare_ts(mVideoStream.fNextPts,
-                                         mVideoStream.fCodec->time_base,
-                                         mAudioStream.fNextPts,
-                                         mAudioStream.fCodec->time_base) >= 0;
-        }
-        const bool encodeAudio = mEncodeAudio && hasAudio && audioAligned;
-        if(encodeAudio) {
-            try {
-                processAudioStream(mFormatContext, &mAudioStream,
-                                   mSoundIterator, &hasAudio);
-                avcodec_flush_buffers(mAudioStream.fCodec);
-            } catch(...) {
-                RuntimeThrow("Failed to process audio stream");
+            const bool encodeVideo = mEncodeVideo && hasVideo && videoAligned;
+            if(encodeVideo) {
+                const auto cacheCont = _mContainers.at(_mCurrentContainerId);
+                const auto contRage = cacheCont->getRange()*_mRenderRange;
+                const int nFrames = contRage.span();
+                // the container image is converted once for its whole range
+                const bool convert = _mCurrentContainerFrame == 0;
+                // intra-only codecs encode a hold once and duplicate the packet
+                const int repeats = mVideoStream.fIntraOnly ?
+                            nFrames - _mCurrentContainerFrame - 1 : 0;
+                try {
+                    writeVideoFrame(mFormatContext, &mVideoStream,
+                                    cacheCont->getImageSk(), convert, repeats);
+                } catch(...) {
+                    RuntimeThrow("Failed to write video frame");
+                }
+                _mCurrentContainerFrame += 1 + repeats;
+                if(_mCurrentContainerFrame >= nFrames) {
+                    _mCurrentContainerId++;
+                    _mCurrentContainerFrame = 0;
+                    hasVideo = _mCurrentContainerId < _mContainers.count();
+                }
+            }
+            bool audioAligned = true;
+            if(mEncodeVideo && mEncodeAudio) {
+                audioAligned = av_compare_ts(mVideoStream.fNextPts,
+                                             mVideoStream.fCodec->time_base,
+                                             mAudioStream.fNextPts,
+                                             mAudioStream.fCodec->time_base) >= 0;
+            }
+            const bool encodeAudio = mEncodeAudio && hasAudio && audioAligned;
+            if(encodeAudio) {
+                try {
+                    processAudioStream(mFormatContext, &mAudioStream,
+                                       mSoundIterator, &hasAudio);
+                } catch(...) {
+                    RuntimeThrow("Failed to process audio stream");
+                }
+                hasAudio = _mAllAudioProvided ? mSoundIterator.hasValue() :
+                                                mSoundIterator.hasSamples(mAudioStream.fSrcFrame->nb_samples);
+                mEncodedSamples = mAudioStream.fNextPts;
             }
-            hasAudio = _mAllAudioProvided ? mSoundIterator.hasValue() :
-                                            mSoundIterator.hasSamples(mAudioStream.fSrcFrame->nb_samples);
+            if(!encodeVideo && !encodeAudio) break;
+            if(mInterruptEncoding) break;
         }
-        if(!encodeVideo && !encodeAudio) break;
+        passEncoded();
     }
 }
 
+bool VideoEncoder::takeQueued() {
+    QMutexLocker lock(&mQueueMutex);
+    while(!mInterruptEncoding) {
+        const bool newData = !mNextContainers.isEmpty() ||
+                             !mNextSoundConts.isEmpty() ||
+                             mAllAudioProvided != _mAllAudioProvided;
+        if(newData) {
+            for(const auto& cont : mNextContainers)
+                _mContainers.append(cont);
+            mNextContainers.clear();
+            for(const auto& sound : mNextSoundConts)
+                mSoundIterator.add(sound);
+            mNextSoundConts.clear();
+            _mAllAudioProvided = mAllAudioProvided;
+            return true;
+        }
+        if(mEncodingFinished) return false;
+        QElapsedTimer timer;
+        timer.start();
+        mQueueChanged.wait(&mQueueMutex);
+        mStats.fEncoderStarvedMs += timer.elapsed();
+    }
+    return false;
+}
 
-void VideoEncoder::beforeProcessing(const Hardware) {
-    _mCurrentContainerId = 0;
-    _mAllAudioProvided = mAllAudioProvided;
-    if(_mContainers.isEmpty()) {
-        _mContainers.swap(mNextContainers);
-    } else {
-        for(const auto& cont : mNextContainers)
-            _mContainers.append(cont);
-        mNextContainers.clear();
+void VideoEncoder::passEncoded() {
+    bool wasEmpty;
+    {
+        QMutexLocker lock(&mQueueMutex);
+        wasEmpty = mEncoded.isEmpty();
+        for(int i = 0; i < _mCurrentContainerId; i++)
+            mEncoded << _mContainers.takeFirst();
     }
-    for(const auto& sound : mNextSoundConts)
-        mSoundIterator.add(sound);
-    mNextSoundConts.clear();
-    _mRenderRange = {mRenderSettings.fMinFrame, mRenderSettings.fMaxFrame};
-    if(!mCurrentlyEncoding) clearContainers();
+    _mCurrentContainerId = 0;
+    // a single queued call releases everything encoded until it runs
+    if(wasEmpty) emit mEmitter.dataEncoded();
 }
 
-void VideoEncoder::afterProcessing() {
-    const auto currCanvas = mRenderInstanceSettings->getTargetCanvas();
-    if(_mCurrentContainerId != 0) {
-        const auto lastEncoded = _mContainers.at(_mCurrentContainerId - 1);
+void VideoEncoder::releaseEncoded() {
+    QList<stdsptr<SceneFrameContainer>> encoded;
+    {
+        QMutexLocker lock(&mQueueMutex);
+        encoded.swap(mEncoded);
+    }
+    if(!mCurrentlyEncoding) return;
+    if(!encoded.isEmpty()) {
+        const auto currCanvas = mRenderInstanceSettings->getTargetCanvas();
+        const auto lastEncoded = encoded.last();
         currCanvas->setSceneFrame(lastEncoded);
         currCanvas->setMinFrameUseRange(lastEncoded->getRange().fMax + 1);
+        mQueuedFrames -= encoded.count();
     }
+    if(!mRenderBlockedTimer.isValid()) return;
+    if(videoQueueFull() || audioQueueFull()) return;
+    updateRenderBlocked();
+    emit mEmitter.queueSpaceAvailable();
+}
 
-    for(int i = _mContainers.count() - 1; i >= _mCurrentContainerId; i--) {
-        const auto &cont = _mContainers.at(i);
-        mNextContainers.prepend(cont);
-    }
+void VideoEncoder::updateRenderBlocked() {
+    if(!mRenderBlockedTimer.isValid()) return;
+    mStats.fRenderBlockedMs += mRenderBlockedTimer.elapsed();
+    mRenderBlockedTimer.invalidate();
+}
+
+void VideoEncoder::printStats() const {
+    qInfo().noquote() <<
+        QString("Encoder queue: max %1 frames (avg %2), "
+                "encoder waited %3 s, rendering blocked %4 s").
+        arg(mStats.fMaxQueuedFrames).
+        arg(mStats.fAvgQueuedFrames, 0, 'f', 1).
+        arg(mStats.fEncoderStarvedMs*0.001, 0, 'f', 2).
+        arg(mStats.fRenderBlockedMs*0.001, 0, 'f', 2);
+}
+
+void VideoEncoder::beforeProcessing(const Hardware) {
+    _mCurrentContainerId = 0;
+    _mCurrentContainerFrame = 0;
+    _mAllAudioProvided = false;
+    _mRenderRange = {mRenderSettings.fMinFrame, mRenderSettings.fMaxFrame};
     _mContainers.clear();
+    mSoundIterator.clear();
+}
 
+void VideoEncoder::afterProcessing() {
+    releaseEncoded();
     if(mInterruptEncoding) {
         interrupEncoding();
         mInterruptEncoding = false;
-    } else if(unhandledException()) {
-        gPrintExceptionCritical(takeException());
-        mRenderInstanceSettings->setCurrentState(RenderState::error, "Error");
-        finishEncodingNow();
-        mEmitter.encodingFailed();
     } else if(mEncodingFinished) finishEncodingSuccess();
-    else if(!mNextContainers.isEmpty()) queTask();
+}
+
+void VideoEncoder::handleException() {
+    releaseEncoded();
+    gPrintExceptionCritical(takeException());
+    mRenderInstanceSettings->setCurrentState(RenderState::error, "Error");
+    finishEncodingNow();
+    mEmitter.encodingFailed();
 }
 
 void VideoEncoder::sFinishEncoding() {
@@ -751,6 +945,14 @@ bool VideoEncoder::sEncodeAudio() {
     return sInstance->mEncodeAudio;
 }
 
+bool VideoEncoder::sVideoQueueFull() {
+    return sInstance->videoQueueFull();
+}
+
+bool VideoEncoder::sAudioQueueFull() {
+    return sInstance->audioQueueFull();
+}
+
 void VideoEncoder::sInterruptEncoding() {
     sInstance->interruptCurrentEncoding();
 }
@@ -18,8 +18,14 @@
 #define VIDEOENCODER_H
 #include <QString>
 #include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <atomic>
+#include <map>
 #include "skia/skiaincludes.h"
 #include "Tasks/updatable.h"
+#include "Private/Tasks/taskexecutor.h"
 #include "renderinstancesettings.h"
 #include "framerange.h"
 #include "CacheHandlers/samples.h"
@@ -154,6 +160,10 @@ typedef struct OutputStream {
     AVFrame *fSrcFrame = nullptr;
     struct SwsContext *fSwsCtx = nullptr;
     struct SwrContext *fSwrCtx = nullptr;
+    // every frame is a keyframe, packets can be duplicated
+    bool fIntraOnly = false;
+    // pts of packets to be duplicated for the following frames
+    std::map<int64_t, int> fPacketRepeats;
 } OutputStream;
 
 class VideoEncoderEmitter : public QObject {
@@ -167,36 +177,59 @@ signals:
 
     void encodingStartFailed();
     void encodingFailed();
+
+    //! @brief Emitted from the encoder thread, data was encoded.
+    void dataEncoded();
+    //! @brief The encoder queue is no longer full.
+    void queueSpaceAvailable();
 };
 
+//! @brief Runs the encoder on its own thread,
+//! apart from the hdd cache tasks.
+class EncoderExecController : public ExecController {
+public:
+    EncoderExecController(QObject * const parent = nullptr) :
+        ExecController(new TaskExecutor, parent) {}
+};
+
+struct VideoEncoderStats {
+    int fMaxQueuedFrames = 0;
+    qreal fAvgQueuedFrames = 0;
+    //! @brief Time the encoder waited for rendered data
+    qint64 fEncoderStarvedMs = 0;
+    //! @brief Time the rendering was held back by a full queue
+    qint64 fRenderBlockedMs = 0;
+};
+
+//! @brief Encodes on a dedicated thread for the whole encoding.
+//! Scene frames and samples are queued in order, the queue is bounded
+//! and RenderHandler stops providing data while it is full.
 class VideoEncoder : public eHddTask {
     e_OBJECT
 protected:
     VideoEncoder();
 public:
+    ~VideoEncoder();
+
     void process();
     void beforeProcessing(const Hardware);
     void afterProcessing();
+    void handleException();
 
     bool startNewEncoding(RenderInstanceSettings * const settings) {
         return startEncoding(settings);
     }
 
-    void interruptCurrentEncoding() {
-        if(isActive()) mInterruptEncoding = true;
-        else interrupEncoding();
-    }
-
-    void finishCurrentEncoding() {
-        if(!mCurrentlyEncoding) return;
-        if(isActive()) mEncodingFinished = true;
-        else finishEncodingSuccess();
-    }
+    void interruptCurrentEncoding();
+    void finishCurrentEncoding();
 
     void addContainer(const stdsptr<SceneFrameContainer> &cont);
     void addContainer(const stdsptr<Samples> &cont);
     void allAudioProvided();
 
+    bool videoQueueFull();
+    bool audioQueueFull();
+
     static VideoEncoder *sInstance;
 
     static void sInterruptEncoding();
@@ -207,6 +240,12 @@ public:
     static void sFinishEncoding();
     static bool sEncodingSuccessfulyStarted();
     static bool sEncodeAudio();
+    static bool sVideoQueueFull();
+    static bool sAudioQueueFull();
+
+    //! @brief Number of scene frame containers held by the queue
+    static const int sMaxQueuedFrames = 16;
+    static const int sMaxQueuedSeconds = 4;
 
     VideoEncoderEmitter *getEmitter() {
         return &mEmitter;
@@ -215,6 +254,21 @@ public:
     bool getCurrentlyEncoding() const {
         return mCurrentlyEncoding;
     }
+
+    const VideoEncoderStats& getStats() const {
+        return mStats;
+    }
+protected:
+    void queTaskNow();
+private:
+    //! @brief Waits for queued data, false if the encoding should end.
+    bool takeQueued();
+    //! @brief Hands encoded containers back to the main thread.
+    void passEncoded();
+    //! @brief Releases encoded containers, main thread only.
+    void releaseEncoded();
+    void updateRenderBlocked();
+    void printStats() const;
 protected:
     void clearContainers();
     VideoEncoderEmitter mEmitter;
@@ -225,8 +279,8 @@ protected:
     void startEncodingNow();
 
     bool mEncodingSuccesfull = false;
-    bool mEncodingFinished = false;
-    bool mInterruptEncoding = false;
+    std::atomic<bool> mEncodingFinished{false};
+    std::atomic<bool> mInterruptEncoding{false};
 
     eSoundSettingsData mInSoundSettings;
     OutputStream mVideoStream;
@@ -234,8 +288,23 @@ protected:
     AVFormatContext *mFormatContext = nullptr;
     const AVOutputFormat *mOutputFormat = nullptr;
     bool mCurrentlyEncoding = false;
+
+    EncoderExecController* mExecController = nullptr;
+    // guards the queue shared with the encoder thread
+    QMutex mQueueMutex;
+    QWaitCondition mQueueChanged;
     QList<stdsptr<SceneFrameContainer>> mNextContainers;
     QList<stdsptr<Samples>> mNextSoundConts;
+    QList<stdsptr<SceneFrameContainer>> mEncoded;
+
+    // main thread queue accounting
+    int mQueuedFrames = 0;
+    qint64 mQueuedSamples = 0;
+    std::atomic<qint64> mEncodedSamples{0};
+    qint64 mQueueDepthSum = 0;
+    int mQueueDepthCount = 0;
+    QElapsedTimer mRenderBlockedTimer;
+    VideoEncoderStats mStats;
 
     RenderSettings mRenderSettings;
     OutputSettings mOutputSettings;
@@ -243,7 +312,7 @@ protected:
     QByteArray mPathByteArray;
     bool mEncodeVideo = false;
     bool mEncodeAudio = false;
-    bool mAllAudioProvided = false;
+    std::atomic<bool> mAllAudioProvided{false};
 
     bool _mAllAudioProvided = false;
     int _mCurrentContainerId = 0;
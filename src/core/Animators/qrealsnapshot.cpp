@@ -16,6 +16,7 @@
 
 #include "qrealsnapshot.h"
 #include "qrealkey.h"
+#include <QtMath>
 
 void QrealSnapshot::appendKey(const QrealKey * const key) {
     mKeys.append({key->getStartFrame()*mFrameMultiplier,
@@ -129,6 +130,28 @@ qreal QrealSnapshot::Iterator::getValueAndProgress(const qreal progress) {
     return result;
 }
 
+int QrealSnapshot::Iterator::getRampAndProgress(const int maxSamples,
+                                                qreal& value, qreal& step) {
+    if(mStaticValue) {
+        value = mPrevValue;
+        step = 0;
+        return maxSamples;
+    }
+    // steps that stay within the current interpolation span
+    const int spanSamples = qFloor(mNextFrame - mCurrentFrame) + 1;
+    const int nSamples = qBound(1, spanSamples, maxSamples);
+    if(mInterpolate) {
+        step = (mNextValue - mPrevValue)*mInvFrameSpan;
+        value = mPrevValue + (mCurrentFrame - mPrevFrame)*step;
+    } else {
+        value = mPrevValue;
+        step = 0;
+    }
+    mCurrentFrame += nSamples;
+    if(mCurrentFrame > mNextFrame) updateSamples();
+    return nSamples;
+}
+
 bool QrealSnapshot::Iterator::staticValue() const {
     return mStaticValue;
 }
@@ -39,6 +39,10 @@ public:
                  const QrealSnapshot * const snap);
 
         qreal getValueAndProgress(const qreal progress);
+        //! @brief Gets the linear volume ramp for up to maxSamples steps
+        //! of one, returns the number of steps covered and progresses.
+        int getRampAndProgress(const int maxSamples,
+                               qreal& value, qreal& step);
 
         bool staticValue() const;
     private:
@@ -18,6 +18,7 @@
 #include "RasterEffects/rastereffect.h"
 #include "Boxes/boundingbox.h"
 #include "Boxes/containerbox.h"
+#include "Private/Tasks/taskscheduler.h"
 
 RasterEffectAnimators::RasterEffectAnimators(BoundingBox * const parentBox) :
     RasterEffectAnimatorsBase("raster effects"), mParentBox_k(parentBox) {
@@ -61,12 +62,16 @@ void RasterEffectAnimators::updateMaxForcedMargin() {
 
 void RasterEffectAnimators::addEffects(const qreal relFrame,
                                        BoxRenderData * const data) {
+    const bool gpuAvailable = TaskScheduler::sGpuAvailable();
     for(const auto& effect : ca_mChildAnimators) {
         auto rasterEffect = static_cast<RasterEffect*>(effect.get());
         if(rasterEffect->isVisible()) {
             const auto effectRenderData =
                     rasterEffect->getEffectCaller(relFrame, data->fResolution);
             if(!effectRenderData) continue;
+            // gpu only effects are skipped when rendering without a gpu
+            if(!gpuAvailable && effectRenderData->hardwareSupport() ==
+                                HardwareSupport::gpuOnly) continue;
             data->addEffect(effectRenderData);
         }
     }
@@ -237,9 +237,10 @@ void AnimationBox::setupRenderData(const qreal relFrame,
     const auto imageData = static_cast<AnimationBoxRenderData*>(data);
     const int animationFrame = getAnimationFrameForRelFrame(relFrame);
     imageData->fAnimationFrame = animationFrame;
+    mSrcFramesCache->setResolution(data->fResolution);
     const auto upd = mSrcFramesCache->scheduleFrameLoad(animationFrame);
     if(upd) upd->addDependent(imageData);
-    else imageData->fImage = mSrcFramesCache->getFrameCopyAtFrame(animationFrame);
+    else imageData->setImage(mSrcFramesCache->getFrameCopyAtFrame(animationFrame));
 }
 
 stdsptr<BoxRenderData> AnimationBox::createRenderData() {
@@ -247,5 +248,10 @@ stdsptr<BoxRenderData> AnimationBox::createRenderData() {
 }
 
 void AnimationBoxRenderData::loadImageFromHandler() {
-    fImage = fSrcCacheHandler->getFrameCopyAtOrBeforeFrame(fAnimationFrame);
+    setImage(fSrcCacheHandler->getFrameCopyAtOrBeforeFrame(fAnimationFrame));
+}
+
+void AnimationBoxRenderData::setImage(const sk_sp<SkImage>& image) {
+    fImage = image;
+    fImageScale = image ? fSrcCacheHandler->getImageScale(*image) : 1;
 }
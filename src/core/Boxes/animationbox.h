@@ -30,6 +30,7 @@ struct AnimationBoxRenderData : public ImageRenderData {
     }
 
     void loadImageFromHandler();
+    void setImage(const sk_sp<SkImage>& image);
 
     AnimationFrameHandler *fSrcCacheHandler;
     int fAnimationFrame;
@@ -34,6 +34,7 @@
 #include "typemenu.h"
 #include "patheffectsmenu.h"
 #include "RasterEffects/rastereffectsinclude.h"
+#include "CacheHandlers/boxframecontainer.h"
 
 int BoundingBox::sNextDocumentId = 0;
 QList<BoundingBox*> BoundingBox::sDocumentBoxes;
@@ -104,6 +105,8 @@ BoundingBox *BoundingBox::sGetBoxByDocumentId(const int documentId) {
 void BoundingBox::prp_afterChangedAbsRange(const FrameRange &range, const bool clip) {
     const auto croppedRange = clip ? prp_absInfluenceRange()*range : range;
     StaticComplexAnimator::prp_afterChangedAbsRange(croppedRange, clip);
+    if(croppedRange.isValid())
+        mBoxFramesHandler.remove(prp_absRangeToRelRange(croppedRange));
     if(croppedRange.inRange(anim_getCurrentAbsFrame())) {
         planUpdate(UpdateReason::userChange);
     }
@@ -298,6 +301,19 @@ bool BoundingBox::diffsIncludingInherited(const qreal relFrame1,
     return diffsIncludingInherited(prevFrame, nextFrame);
 }
 
+FrameRange BoundingBox::getIdenticalRelRangeIncludingInherited(
+        const int relFrame) const {
+    const auto range = prp_getIdenticalRelRange(relFrame);
+    if(!mParentGroup || range.isUnary()) return range;
+    const int absFrame = prp_relFrameToAbsFrame(relFrame);
+    const int parentRelFrame = mParentGroup->prp_absFrameToRelFrame(absFrame);
+    const auto parentRange =
+            mParentGroup->getIdenticalRelRangeAffectingContainedBoxes(
+                parentRelFrame);
+    const auto absParentRange = mParentGroup->prp_relRangeToAbsRange(parentRange);
+    return range*prp_absRangeToRelRange(absParentRange);
+}
+
 void BoundingBox::setParentTransform(BasicTransformAnimator *parent) {
     if(parent == mParentTransform) return;
     mParentTransform = parent;
@@ -360,6 +376,7 @@ void BoundingBox::planUpdate(const UpdateReason reason) {
     if(reason == UpdateReason::userChange) {
         mStateId++;
         mRenderDataHandler.clear();
+        mBoxFramesHandler.clear();
     }
 
     mDrawRenderContainer.setExpired(true);
@@ -411,17 +428,50 @@ stdsptr<BoxRenderData> BoundingBox::getCurrentRenderData(const qreal relFrame) c
     const auto currentRenderData =
             mRenderDataHandler.getItemAtRelFrame(relFrame);
     if(currentRenderData) return currentRenderData->ref<BoxRenderData>();
+    if(const auto cached = getCachedRenderData(relFrame)) return cached;
     if(mDrawRenderContainer.isExpired()) return nullptr;
     const auto drawData = mDrawRenderContainer.getSrcRenderData();
     if(!drawData) return nullptr;
     if(!diffsIncludingInherited(drawData->fRelFrame, relFrame)) {
-        const auto copy = drawData->makeCopy();
+        // rendered images are immutable, sharing keeps their identity
+        const auto copy = drawData->makeCopy(drawData->fRenderedImage);
         copy->fRelFrame = relFrame;
         return copy;
     }
     return nullptr;
 }
 
+stdsptr<BoxRenderData> BoundingBox::getCachedRenderData(
+        const qreal relFrame) const {
+    const auto cont = mBoxFramesHandler.atFrame<BoxFrameContainer>(
+                qFloor(relFrame));
+    if(!cont || !cont->inRange(qCeil(relFrame))) return nullptr;
+    const auto scene = getParentScene();
+    if(!scene) return nullptr;
+    const qreal resolution = scene->getResolutionFraction();
+    if(!isZero4Dec(cont->fResolution - resolution)) return nullptr;
+    if(diffsIncludingInherited(cont->fRelFrame, relFrame)) return nullptr;
+    if(!cont->storesDataInMemory()) {
+        // rendered anew this time, available for the following frames
+        cont->scheduleLoadFromTmpFile();
+        return nullptr;
+    }
+    return cont->renderDataAt(relFrame);
+}
+
+void BoundingBox::addCachedRenderData(BoxRenderData * const renderData) {
+    if(!renderData->fRenderedImage) return;
+    if(!isInteger4Dec(renderData->fRelFrame)) return;
+    const int relFrame = qRound(renderData->fRelFrame);
+    const auto range = getIdenticalRelRangeIncludingInherited(relFrame);
+    // frames of animated boxes are kept by the scene frame cache only
+    if(range.isUnary()) return;
+    mBoxFramesHandler.remove(range);
+    const auto cont = enve::make_shared<BoxFrameContainer>(
+                renderData, range, &mBoxFramesHandler);
+    mBoxFramesHandler.add(cont);
+}
+
 bool BoundingBox::isContainedIn(const QRectF &absRect) const {
     return absRect.contains(getTotalTransform().mapRect(mRelRect));
 }
@@ -982,8 +1032,10 @@ bool BoundingBox::SWT_drop(const QMimeData * const data) {
 
 void BoundingBox::renderDataFinished(BoxRenderData *renderData) {
     const qreal relFrame = renderData->fRelFrame;
-    if(renderData->fBoxStateId == mStateId)
+    if(renderData->fBoxStateId == mStateId) {
         mRenderDataHandler.removeItemAtRelFrame(relFrame);
+        addCachedRenderData(renderData);
+    }
     auto currentRenderData = mDrawRenderContainer.getSrcRenderData();
     bool newerSate = true;
     bool closerFrame = true;
@@ -21,6 +21,7 @@
 #include "boxrendercontainer.h"
 #include "skia/skiaincludes.h"
 #include "renderdatahandler.h"
+#include "CacheHandlers/hddcachablecachehandler.h"
 #include "smartPointers/ememory.h"
 #include "colorhelpers.h"
 #include "waitingforboxload.h"
@@ -321,6 +322,7 @@ public:
 
     bool diffsIncludingInherited(const int relFrame1, const int relFrame2) const;
     bool diffsIncludingInherited(const qreal relFrame1, const qreal relFrame2) const;
+    FrameRange getIdenticalRelRangeIncludingInherited(const int relFrame) const;
 
     bool hasCurrentRenderData(const qreal relFrame) const;
     stdsptr<BoxRenderData> getCurrentRenderData(const qreal relFrame) const;
@@ -354,6 +356,9 @@ public:
 protected:
     void setRelBoundingRect(const QRectF& relRect);
 
+    stdsptr<BoxRenderData> getCachedRenderData(const qreal relFrame) const;
+    void addCachedRenderData(BoxRenderData * const renderData);
+
     void prp_updateCanvasProps() {
         mCanvasProps.clear();
         ca_execOnDescendants([this](Property * prop) {
@@ -384,6 +389,9 @@ protected:
 
     RenderDataHandler mRenderDataHandler;
     RenderContainer mDrawRenderContainer;
+    //! @brief Rendered images reused for frames over which the box,
+    //! and everything it inherits, stays identical.
+    HddCachableCacheHandler mBoxFramesHandler;
 
     const qsptr<BoxTransformAnimator> mTransformAnimator;
     const qsptr<RasterEffectAnimators> mRasterEffectsAnimators;
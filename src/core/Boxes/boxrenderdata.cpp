@@ -17,6 +17,8 @@
 #include "boxrenderdata.h"
 #include "boundingbox.h"
 #include "skia/skiahelpers.h"
+#include "skia/pixelbufferpool.h"
+#include <QElapsedTimer>
 #include "efiltersettings.h"
 #include "Private/Tasks/taskscheduler.h"
 
@@ -44,16 +46,21 @@ void BoxRenderData::copyFrom(BoxRenderData *src) {
     fOpacity = src->fOpacity;
     fResolution = src->fResolution;
     fResolutionScale = src->fResolutionScale;
-    fRenderedImage = SkiaHelpers::makeCopy(src->fRenderedImage);
     fBoxStateId = src->fBoxStateId;
+    fProcessingUs = src->totalProcessingUs();
     mState = eTaskState::finished;
     fRelBoundingRectSet = true;
 }
 
 stdsptr<BoxRenderData> BoxRenderData::makeCopy() {
+    return makeCopy(SkiaHelpers::makeCopy(fRenderedImage));
+}
+
+stdsptr<BoxRenderData> BoxRenderData::makeCopy(const sk_sp<SkImage>& image) {
     if(!fParentBox) return nullptr;
     stdsptr<BoxRenderData> copy = fParentBox->createRenderData();
     copy->copyFrom(this);
+    copy->fRenderedImage = image;
     return copy;
 }
 
@@ -80,8 +87,24 @@ void BoxRenderData::drawRenderedImageForParent(SkCanvas * const canvas) {
     canvas->drawImage(fRenderedImage, fGlobalRect.x(), fGlobalRect.y(), &paint);
 }
 
+namespace {
+    //! @brief Adds the time spent in scope to the counter
+    class ScopedTimerUs {
+    public:
+        ScopedTimerUs(qint64& counter) : mCounter(counter) {
+            mTimer.start();
+        }
+        ~ScopedTimerUs() { mCounter += mTimer.nsecsElapsed()/1000; }
+    private:
+        qint64& mCounter;
+        QElapsedTimer mTimer;
+    };
+}
+
 void BoxRenderData::processGpu(QGL33 * const gl,
                                SwitchableContext &context) {
+    const ScopedTimerUs timer(fProcessingUs);
+    if(mStep == Step::SUB_TASKS) return;
     if(mStep == Step::EFFECTS)
         return mEffectsRenderer.processGpu(gl, context, this);
     updateGlobalRect();
@@ -114,14 +137,20 @@ void BoxRenderData::processGpu(QGL33 * const gl,
 }
 
 void BoxRenderData::process() {
-    if(mStep == Step::EFFECTS) return;
+    const ScopedTimerUs timer(fProcessingUs);
+    if(mStep != Step::BOX_IMAGE) return;
     updateGlobalRect();
     if(fOpacity < 0.001) return;
     if(fGlobalRect.width() <= 0 || fGlobalRect.height() <= 0) return;
 
+    drawImageCpu();
+}
+
+void BoxRenderData::drawImageCpu() {
     const auto info = SkiaHelpers::getPremulRGBAInfo(fGlobalRect.width(),
                                                      fGlobalRect.height());
-    mBitmap.allocPixels(info);
+    if(!PixelBufferPool::sAllocPixels(mBitmap, info))
+        RuntimeThrow("Failed to allocate pixels");
     mBitmap.eraseColor(eraseColor());
     SkCanvas canvas(mBitmap);
     transformRenderCanvas(canvas);
@@ -131,7 +160,18 @@ void BoxRenderData::process() {
     fRenderedImage = SkiaHelpers::transferDataToSkImage(mBitmap);
 }
 
+void BoxRenderData::subTasksFinished() {
+    if(mState == eTaskState::canceled) return;
+    if(nextStep()) queTask();
+    else finishedProcessing();
+}
+
 void BoxRenderData::beforeProcessing(const Hardware hw) {
+    if(mStep == Step::SUB_TASKS) {
+        mState = eTaskState::waiting;
+        spawnSubTasks();
+        return;
+    }
     if(mStep == Step::EFFECTS) {
         if(hw == Hardware::cpu) {
             mState = eTaskState::waiting;
@@ -160,7 +200,9 @@ void BoxRenderData::afterQued() {
 #include "Private/esettings.h"
 
 HardwareSupport BoxRenderData::hardwareSupport() const {
-    if(mStep == Step::EFFECTS) {
+    if(mStep == Step::SUB_TASKS) {
+        return HardwareSupport::cpuOnly;
+    } else if(mStep == Step::EFFECTS) {
         return mEffectsRenderer.nextHardwareSupport();
     } else {
         if(fParentBox) return fParentBox->hardwareSupport();
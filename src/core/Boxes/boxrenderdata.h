@@ -31,7 +31,7 @@ class RenderDataCustomizerFunctor;
 struct BoxRenderData : public eTask {
     e_OBJECT
 protected:
-    enum class Step { BOX_IMAGE, EFFECTS };
+    enum class Step { BOX_IMAGE, SUB_TASKS, EFFECTS };
 
     BoxRenderData(BoundingBox * const parent);
 
@@ -42,6 +42,12 @@ protected:
     virtual void updateRelBoundingRect() = 0;
     virtual void updateGlobalRect();
 
+    //! @brief Checked after drawSk, return true to finish
+    //! the box image in parallel with spawnSubTasks.
+    virtual bool hasSubTasks() const { return false; }
+    //! @brief The last sub-task has to call subTasksFinished.
+    virtual void spawnSubTasks() {}
+
     HardwareSupport hardwareSupport() const;
 
     void afterCanceled() {}
@@ -64,6 +70,10 @@ public:
 
     bool nextStep() {
         if(mState == eTaskState::waiting) mState = eTaskState::processing;
+        if(mStep == Step::BOX_IMAGE && hasSubTasks()) {
+            mStep = Step::SUB_TASKS;
+            return true;
+        }
         const bool result = !mEffectsRenderer.isEmpty();
         if(result) mStep = Step::EFFECTS;
         return result;
@@ -72,9 +82,19 @@ public:
     void processGpu(QGL33 * const gl, SwitchableContext &context);
     void process();
 
+    //! @brief Continues with the next step on the main thread.
+    void subTasksFinished();
+
     stdsptr<BoxRenderData> makeCopy();
+    //! @brief Finished copy sharing the given (immutable) image.
+    stdsptr<BoxRenderData> makeCopy(const sk_sp<SkImage>& image);
+
+    //! @brief Includes the time spent rendering children, if any
+    virtual qint64 totalProcessingUs() const { return fProcessingUs; }
 
     uint fBoxStateId = 0;
+    //! @brief Time spent in process and processGpu
+    qint64 fProcessingUs = 0;
 
     QMatrix fResolutionScale;
     QMatrix fScaledTransform;
@@ -116,6 +136,8 @@ public:
     }
 protected:
     bool hasEffects() const { return !mEffectsRenderer.isEmpty(); }
+    //! @brief Draws fRenderedImage on the cpu, fGlobalRect is not empty.
+    virtual void drawImageCpu();
 
     void setBaseGlobalRect(const QRectF &baseRectF);
 
@@ -0,0 +1,143 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "brushstrokesubtaskspawner.h"
+#include "pathboxrenderdata.h"
+#include "Paint/autotiledsurface.h"
+#include "Paint/simplebrushwrapper.h"
+#include <QThread>
+#include <atomic>
+#include <climits>
+
+class BrushStrokeSubTaskSpawner_priv {
+public:
+    BrushStrokeSubTaskSpawner_priv(const stdsptr<PathBoxRenderData>& data,
+                                   const QList<BrushStrokeSet>& sets);
+private:
+    //! @brief Owns the tile rows [fMinRow, fMaxRow] of the result.
+    //! Every band replays all the strokes with its own brush,
+    //! so that dabs crossing band edges match on both sides.
+    struct Band {
+        int fMinRow;
+        int fMaxRow;
+        stdsptr<SimpleBrushWrapper> fBrush;
+        QList<BrushStrokeSet> fSets;
+        AutoTiledSurface fSurface;
+    };
+
+    void spawn(const QList<BrushStrokeSet>& sets);
+    void paintBand(Band& band);
+    void merge();
+    void decRemaining_k();
+
+    int mRemaining = 0;
+    std::atomic<int> mPainting{0};
+    const stdsptr<PathBoxRenderData> mData;
+    sk_sp<SkImage> mSrcImage;
+    SkBitmap mSrcBitmap;
+    QRect mPixelClamp;
+    QList<stdsptr<Band>> mBands;
+};
+
+BrushStrokeSubTaskSpawner_priv::BrushStrokeSubTaskSpawner_priv(
+        const stdsptr<PathBoxRenderData>& data,
+        const QList<BrushStrokeSet>& sets) :
+    mData(data), mSrcImage(data->fRenderedImage) {
+    SkPixmap pixmap;
+    if(mSrcImage && mSrcImage->peekPixels(&pixmap))
+        mSrcBitmap.installPixels(pixmap);
+    mPixelClamp = data->fMaxBoundsRect.translated(-data->fGlobalRect.topLeft());
+    spawn(sets);
+}
+
+void BrushStrokeSubTaskSpawner_priv::spawn(const QList<BrushStrokeSet>& sets) {
+    QRectF bounds;
+    for(const auto& set : sets) {
+        for(const auto& stroke : set.fStrokes)
+            bounds = bounds.united(stroke.fStrokePath.ptsBoundingRect());
+    }
+    const int minRow = qFloor(bounds.top()/TILE_SIZE);
+    const int nRows = qFloor(bounds.bottom()/TILE_SIZE) - minRow + 1;
+
+    const auto& brush = mData->fStrokeSettings.fStrokeBrush;
+    const auto myPaintBrush = brush->getBrush();
+    // smudging reads paint from across band edges
+    const bool smudge =
+            brush->getBaseValue(MYPAINT_BRUSH_SETTING_SMUDGE) > 0 ||
+            !mypaint_brush_is_constant(myPaintBrush, MYPAINT_BRUSH_SETTING_SMUDGE);
+    const int maxBands = smudge ? 1 : qBound(1, nRows, QThread::idealThreadCount());
+    // fresh snapshots share the random generator seed, the brush itself
+    // might have advanced it and dabs would not match across band edges
+    QList<stdsptr<SimpleBrushWrapper>> brushes;
+    while(brushes.count() < maxBands) {
+        const auto snapshot = brush->createSnapshot();
+        if(!snapshot) break;
+        brushes << snapshot;
+    }
+    if(brushes.isEmpty()) brushes << brush;
+
+    const int nBands = brushes.count();
+    for(int i = 0; i < nBands; i++) {
+        const auto band = std::make_shared<Band>();
+        band->fMinRow = i == 0 ? INT_MIN : minRow + nRows*i/nBands;
+        band->fMaxRow = i == nBands - 1 ? INT_MAX :
+                                          minRow + nRows*(i + 1)/nBands - 1;
+        band->fBrush = brushes.at(i);
+        band->fSets = sets;
+        mBands << band;
+    }
+
+    mRemaining = nBands;
+    mPainting = nBands;
+    for(const auto& band : mBands) {
+        const auto subTask = enve::make_shared<eCustomCpuTask>(nullptr,
+            [this, band]() {
+                paintBand(*band);
+                // the last band to finish merges them all
+                if(--mPainting == 0) merge();
+            }, [this]() { decRemaining_k(); });
+        subTask->queTask();
+    }
+}
+
+void BrushStrokeSubTaskSpawner_priv::paintBand(Band& band) {
+    auto& surface = band.fSurface;
+    surface.setPixelClamp(mPixelClamp);
+    surface.loadBitmap(mSrcBitmap, band.fMinRow, band.fMaxRow);
+    surface.setDabRows(band.fMinRow, band.fMaxRow);
+    const auto brush = band.fBrush->getBrush();
+    for(auto& set : band.fSets) surface.execute(brush, set);
+}
+
+void BrushStrokeSubTaskSpawner_priv::merge() {
+    AutoTiledSurface surface;
+    surface.setPixelClamp(mPixelClamp);
+    for(const auto& band : mBands) {
+        surface.takeTiles(band->fSurface, band->fMinRow, band->fMaxRow);
+    }
+    mData->setBrushStrokesResult(surface);
+}
+
+void BrushStrokeSubTaskSpawner_priv::decRemaining_k() {
+    if(--mRemaining > 0) return;
+    mData->subTasksFinished();
+    delete this;
+}
+
+void BrushStrokeSubTaskSpawner::sSpawn(const stdsptr<PathBoxRenderData>& data,
+                                       const QList<BrushStrokeSet>& sets) {
+    new BrushStrokeSubTaskSpawner_priv(data, sets);
+}
@@ -0,0 +1,31 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BRUSHSTROKESUBTASKSPAWNER_H
+#define BRUSHSTROKESUBTASKSPAWNER_H
+#include "smartPointers/ememory.h"
+#include "Paint/brushstroke.h"
+
+struct PathBoxRenderData;
+
+namespace BrushStrokeSubTaskSpawner {
+    //! @brief Paints the stroke sets over the rendered box image
+    //! in horizontal tile bands processed in parallel.
+    void sSpawn(const stdsptr<PathBoxRenderData>& data,
+                const QList<BrushStrokeSet>& sets);
+};
+
+#endif // BRUSHSTROKESUBTASKSPAWNER_H
@@ -16,6 +16,48 @@
 
 #include "canvasrenderdata.h"
 #include "skia/skiahelpers.h"
+#include "skia/skqtconversions.h"
+
+bool SceneRenderBase::Child::operator==(const Child &other) const {
+    return fBox == other.fBox && fImageId == other.fImageId &&
+           fBounds == other.fBounds && fTransform == other.fTransform &&
+           fBlendMode == other.fBlendMode &&
+           fFilterQuality == other.fFilterQuality &&
+           fAntiAlias == other.fAntiAlias &&
+           qFuzzyCompare(fOpacity, other.fOpacity);
+}
+
+bool SceneRenderBase::Child::clearsOutside() const {
+    return fBlendMode == SkBlendMode::kDstIn ||
+           fBlendMode == SkBlendMode::kSrcIn ||
+           fBlendMode == SkBlendMode::kDstATop;
+}
+
+SceneRenderBase::Child SceneRenderBase::sChild(
+        const BoxRenderData * const data) {
+    Child child;
+    child.fBox = data->fParentBox.data();
+    const auto& img = data->fRenderedImage;
+    child.fImageId = img ? img->uniqueID() : 0;
+    child.fBounds = data->fUseRenderTransform ?
+                data->fRenderTransform.mapRect(data->fGlobalRect) :
+                data->fGlobalRect;
+    child.fTransform = data->fUseRenderTransform ?
+                data->fRenderTransform : QMatrix();
+    child.fOpacity = data->fOpacity;
+    child.fBlendMode = data->fBlendMode;
+    child.fFilterQuality = data->fFilterQuality;
+    child.fAntiAlias = data->fAntiAlias;
+    return child;
+}
+
+sk_sp<SkSurface> SceneRenderBase::takeSurface(const QSize& size) {
+    QMutexLocker lock(&mSurfaceMutex);
+    if(!mSurface) return nullptr;
+    if(mSurface->width() != size.width() ||
+       mSurface->height() != size.height()) return nullptr;
+    return std::move(mSurface);
+}
 
 CanvasRenderData::CanvasRenderData(BoundingBox * const parentBoxT) :
     ContainerBoxRenderData(parentBoxT) {}
@@ -34,3 +76,85 @@ void CanvasRenderData::updateGlobalRect() {
 void CanvasRenderData::updateRelBoundingRect() {
     fRelBoundingRect = QRectF(0, 0, fCanvasWidth, fCanvasHeight);
 }
+
+stdsptr<SceneRenderBase> CanvasRenderData::makeRenderBase() const {
+    if(!mBaseUsable || !fRenderedImage) return nullptr;
+    const auto base = std::make_shared<SceneRenderBase>();
+    base->fImage = fRenderedImage;
+    base->fGlobalRect = fGlobalRect;
+    base->fBgColor = fBgColor;
+    base->mSurface = mSurface;
+    for(const auto& child : fChildrenRenderData)
+        base->fChildren << SceneRenderBase::sChild(child.get());
+    return base;
+}
+
+bool CanvasRenderData::damagedRect(QRect& damage) const {
+    if(!fRenderBase || !fRenderBase->fImage) return false;
+    if(fRenderBase->fGlobalRect != fGlobalRect) return false;
+    if(fRenderBase->fBgColor != fBgColor) return false;
+    if(fRenderBase->fImage->width() != fGlobalRect.width() ||
+       fRenderBase->fImage->height() != fGlobalRect.height()) return false;
+    const auto& oldChildren = fRenderBase->fChildren;
+    if(oldChildren.count() != fChildrenRenderData.count()) return false;
+    damage = QRect();
+    for(int i = 0; i < oldChildren.count(); i++) {
+        const auto& oldChild = oldChildren.at(i);
+        const auto newChild = SceneRenderBase::sChild(
+                    fChildrenRenderData.at(i).get());
+        if(oldChild.fBox != newChild.fBox) return false;
+        if(oldChild.clearsOutside() || newChild.clearsOutside()) return false;
+        if(oldChild == newChild) continue;
+        damage |= oldChild.fBounds;
+        damage |= newChild.fBounds;
+    }
+    // margin for antialiased and filtered edges
+    if(!damage.isEmpty()) damage = damage.adjusted(-2, -2, 2, 2) & fGlobalRect;
+    return true;
+}
+
+void CanvasRenderData::drawSk(SkCanvas * const canvas) {
+    mBaseUsable = !hasEffects();
+    QRect damage;
+    if(!mBaseUsable || !damagedRect(damage))
+        return ContainerBoxRenderData::drawSk(canvas);
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    canvas->drawImage(fRenderBase->fImage, fGlobalRect.x(), fGlobalRect.y(),
+                      &paint);
+    if(damage.isEmpty()) return;
+    canvas->clipRect(toSkRect(damage));
+    canvas->clear(fBgColor);
+    ContainerBoxRenderData::drawSk(canvas);
+}
+
+void CanvasRenderData::drawImageCpu() {
+    mBaseUsable = !hasEffects();
+    if(!mBaseUsable) return BoxRenderData::drawImageCpu();
+    QRect damage;
+    const bool partial = damagedRect(damage);
+    if(fRenderBase) mSurface = fRenderBase->takeSurface(fGlobalRect.size());
+    if(!mSurface) {
+        const auto info = SkiaHelpers::getPremulRGBAInfo(fGlobalRect.width(),
+                                                         fGlobalRect.height());
+        mSurface = SkSurface::MakeRaster(info);
+        if(!mSurface) RuntimeThrow("Failed to allocate pixels");
+        damage = fGlobalRect;
+    } else if(!partial) {
+        // the previous content is not needed, skip the copy on write
+        mSurface->notifyContentWillChange(SkSurface::kDiscard_ContentChangeMode);
+        damage = fGlobalRect;
+    }
+    // the surface holds the previous render, drawing over it copies
+    // the pixels only if that image is still in use
+    if(!damage.isEmpty()) {
+        const auto canvas = mSurface->getCanvas();
+        canvas->save();
+        transformRenderCanvas(*canvas);
+        canvas->clipRect(toSkRect(damage));
+        canvas->clear(fBgColor);
+        ContainerBoxRenderData::drawSk(canvas);
+        canvas->restore();
+    }
+    fRenderedImage = mSurface->makeImageSnapshot();
+}
@@ -17,17 +17,69 @@
 #ifndef CANVASRENDERDATA_H
 #define CANVASRENDERDATA_H
 #include "layerboxrenderdata.h"
+#include <QMutex>
+
+//! @brief Rendered scene image along with the state of the children
+//! it was composited from.
+struct SceneRenderBase {
+    struct Child {
+        const BoundingBox* fBox;
+        uint32_t fImageId;
+        QRect fBounds;
+        QMatrix fTransform;
+        qreal fOpacity;
+        SkBlendMode fBlendMode;
+        SkFilterQuality fFilterQuality;
+        bool fAntiAlias;
+
+        bool operator==(const Child& other) const;
+        //! @brief Blend modes clearing the scene outside of the child image
+        bool clearsOutside() const;
+    };
+
+    static Child sChild(const BoxRenderData * const data);
+
+    //! @brief Returns the surface fImage was snapshot from, only once.
+    sk_sp<SkSurface> takeSurface(const QSize& size);
+
+    sk_sp<SkImage> fImage;
+    QRect fGlobalRect;
+    SkColor fBgColor;
+    QList<Child> fChildren;
+private:
+    QMutex mSurfaceMutex;
+    sk_sp<SkSurface> mSurface;
+
+    friend struct CanvasRenderData;
+};
+
 struct CanvasRenderData : public ContainerBoxRenderData {
     CanvasRenderData(BoundingBox * const parentBoxT);
 
     int fCanvasWidth;
     int fCanvasHeight;
     SkColor fBgColor;
+    //! @brief Previous render, only the region that differs is redrawn
+    stdsptr<SceneRenderBase> fRenderBase;
 
     SkColor eraseColor() const { return fBgColor; }
+
+    //! @brief Returns nullptr if the result can not serve as a base.
+    stdsptr<SceneRenderBase> makeRenderBase() const;
 protected:
+    void drawSk(SkCanvas * const canvas);
+    void drawImageCpu();
     void updateGlobalRect();
     void updateRelBoundingRect();
+private:
+    //! @brief Returns false if the whole scene has to be redrawn.
+    bool damagedRect(QRect& damage) const;
+
+    //! @brief Raster effects applied after drawSk alter the composite
+    bool mBaseUsable = false;
+    //! @brief Surface fRenderedImage was snapshot from, drawn over
+    //! by the next render unless the image is still in use
+    sk_sp<SkSurface> mSurface;
 };
 
 #endif // CANVASRENDERDATA_H
@@ -569,6 +569,19 @@ bool ContainerBox::diffsAffectingContainedBoxes(
     return diffThis || diffInherited;
 }
 
+FrameRange ContainerBox::getIdenticalRelRangeAffectingContainedBoxes(
+        const int relFrame) const {
+    const auto range = BoundingBox::prp_getIdenticalRelRange(relFrame);
+    if(!mParentGroup || range.isUnary()) return range;
+    const int absFrame = prp_relFrameToAbsFrame(relFrame);
+    const int parentRelFrame = mParentGroup->prp_absFrameToRelFrame(absFrame);
+    const auto parentRange =
+            mParentGroup->getIdenticalRelRangeAffectingContainedBoxes(
+                parentRelFrame);
+    const auto absParentRange = mParentGroup->prp_relRangeToAbsRange(parentRange);
+    return range*prp_absRangeToRelRange(absParentRange);
+}
+
 BoundingBox *ContainerBox::getBoxAt(const QPointF &absPos) {
     BoundingBox* boxAtPos = nullptr;
 
@@ -116,6 +116,8 @@ public:
 
     bool diffsAffectingContainedBoxes(const int relFrame1,
                                       const int relFrame2);
+    FrameRange getIdenticalRelRangeAffectingContainedBoxes(
+            const int relFrame) const;
 
     void deselectAllBoxesFromBoxesGroup();
     void selectAllBoxesFromBoxesGroup();
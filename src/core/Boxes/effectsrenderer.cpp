@@ -37,11 +37,6 @@ void EffectsRenderer::processGpu(QGL33 * const gl,
     renderData.fPosY = static_cast<int>(gPos.y());
     renderData.fWidth = static_cast<uint>(srcWidth);
     renderData.fHeight = static_cast<uint>(srcHeight);
-    auto& engine = renderData.fJSEngine;
-    engine.evaluate("eTexSize = [" + QString::number(srcWidth) + "," +
-                    QString::number(srcHeight) + "]");
-    engine.evaluate("eGlobalPos = [" + QString::number(gPos.x()) + "," +
-                    QString::number(gPos.y()) + "]");
 
     GpuRenderTools renderTools(gl, context, srcImage);
     while(!mEffects.isEmpty()) {
@@ -18,6 +18,7 @@
 #include "boxrenderdata.h"
 #include "Private/Tasks/taskscheduler.h"
 #include "skia/skiaincludes.h"
+#include "skia/pixelbufferpool.h"
 #include "RasterEffects/rastereffect.h"
 #include "RasterEffects/rastereffectcaller.h"
 
@@ -46,7 +47,8 @@ EffectSubTaskSpawner_priv::EffectSubTaskSpawner_priv(
     SkPixmap pixmap;
     data->fRenderedImage->peekPixels(&pixmap);
     mSrcBitmap.installPixels(pixmap);
-    mDstBitmap.allocPixels(mSrcBitmap.info());
+    if(!PixelBufferPool::sAllocPixels(mDstBitmap, mSrcBitmap.info()))
+        mDstBitmap.allocPixels(mSrcBitmap.info());
     spawn();
 }
 
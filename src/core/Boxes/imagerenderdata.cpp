@@ -23,7 +23,8 @@ ImageRenderData::ImageRenderData(BoundingBox * const parentBoxT) :
 
 void ImageRenderData::updateRelBoundingRect() {
     if(fImage) fRelBoundingRect =
-            QRectF(0, 0, fImage->width(), fImage->height());
+            QRectF(0, 0, fImage->width()/fImageScale,
+                   fImage->height()/fImageScale);
     else fRelBoundingRect = QRectF(0, 0, 0, 0);
 }
 
@@ -38,6 +39,7 @@ void ImageRenderData::setupDirectDraw() {
     updateGlobalRect();
     fRenderTransform.reset();
     fRenderTransform.translate(fRelBoundingRect.x(), fRelBoundingRect.y());
+    fRenderTransform.scale(1/fImageScale, 1/fImageScale);
     fRenderTransform *= fScaledTransform;
     fRenderTransform.translate(-fGlobalRect.x(), -fGlobalRect.y());
     fUseRenderTransform = true;
@@ -49,10 +51,15 @@ void ImageRenderData::setupDirectDraw() {
 void ImageRenderData::drawSk(SkCanvas * const canvas) {
     const float x = static_cast<float>(fRelBoundingRect.x());
     const float y = static_cast<float>(fRelBoundingRect.y());
+    const float invScale = static_cast<float>(1/fImageScale);
+    canvas->save();
+    canvas->translate(x, y);
+    canvas->scale(invScale, invScale);
     if(fFilterQuality > kNone_SkFilterQuality) {
         SkPaint paint;
         paint.setAntiAlias(true);
         paint.setFilterQuality(fFilterQuality);
-        canvas->drawImage(fImage, x, y, &paint);
-    } else if(fImage) canvas->drawImage(fImage, x, y);
+        canvas->drawImage(fImage, 0, 0, &paint);
+    } else if(fImage) canvas->drawImage(fImage, 0, 0);
+    canvas->restore();
 }
@@ -28,6 +28,9 @@ struct ImageRenderData : public BoxRenderData {
     void setupRenderData() final;
 
     sk_sp<SkImage> fImage;
+    //! @brief Scale of fImage relative to the source,
+    //! below one for frames loaded at a lower resolution
+    qreal fImageScale = 1;
 private:
     void setupDirectDraw();
 
@@ -17,6 +17,13 @@
 #include "layerboxrenderdata.h"
 #include "skia/skqtconversions.h"
 
+qint64 ContainerBoxRenderData::totalProcessingUs() const {
+    qint64 result = fProcessingUs;
+    for(const auto& child : fChildrenRenderData)
+        result += child->totalProcessingUs();
+    return result;
+}
+
 ContainerBoxRenderData::ContainerBoxRenderData(BoundingBox * const parentBoxT) :
     BoxRenderData(parentBoxT) {
     mDelayDataSet = true;
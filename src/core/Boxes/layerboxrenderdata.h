@@ -23,6 +23,8 @@ struct ContainerBoxRenderData : public BoxRenderData {
 public:
     QList<stdsptr<BoxRenderData>> fChildrenRenderData;
     ContainerBoxRenderData(BoundingBox * const parentBoxT);
+
+    qint64 totalProcessingUs() const;
 protected:
     void drawSk(SkCanvas * const canvas);
     void transformRenderCanvas(SkCanvas& canvas) const final;
@@ -36,7 +36,7 @@ public:
 
     void updateRelBoundingRect() final {
         Q_ASSERT(fSurface);
-        fRelBoundingRect = fSurface->surface().pixelBoundingRect();
+        fRelBoundingRect = fSurface->surfacePixelBoundingRect();
     }
 
     qptr<AnimatedSurface> fASurface;
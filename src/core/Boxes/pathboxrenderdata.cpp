@@ -16,6 +16,9 @@
 
 #include "pathboxrenderdata.h"
 #include "pathbox.h"
+#include "brushstrokesubtaskspawner.h"
+#include "Paint/autotiledsurface.h"
+#include "skia/skiahelpers.h"
 
 PathBoxRenderData::PathBoxRenderData(BoundingBox * const parentBox) :
     BoxRenderData(parentBox) {}
@@ -44,10 +47,6 @@ void PathBoxRenderData::drawSk(SkCanvas * const canvas) {
         paint.setShader(nullptr);
         if(fStrokeSettings.fPaintType == PaintType::BRUSHPAINT) {
             if(!fStrokeSettings.fStrokeBrush) return;
-            AutoTiledSurface surf;
-            surf.setPixelClamp(fMaxBoundsRect.translated(-fGlobalRect.topLeft()));
-            surf.loadBitmap(mBitmap);
-
             SkPath pathT;
             QMatrix trans;
             trans.translate(-fGlobalRect.x(), -fGlobalRect.y());
@@ -65,9 +64,8 @@ void PathBoxRenderData::drawSk(SkCanvas * const canvas) {
         //                for(auto& set : fillBrushSet)
         //                    surf.execute(fillBrush, set);
 
-            const auto strokeBrush = fStrokeSettings.fStrokeBrush->getBrush();
             auto strokeWidthCurve = fStrokeSettings.fWidthCurve*fResolution;
-            auto strokeBrushSet = BrushStrokeSet::outlineStrokesForSkPath(
+            mStrokeSets = BrushStrokeSet::outlineStrokesForSkPath(
                         pathT,
                         fStrokeSettings.fTimeCurve,
                         fStrokeSettings.fPressureCurve,
@@ -76,26 +74,31 @@ void PathBoxRenderData::drawSk(SkCanvas * const canvas) {
                         toSkScalar(fStrokeSettings.fPaintColor.hueF()),
                         toSkScalar(fStrokeSettings.fPaintColor.saturationF()),
                         toSkScalar(fStrokeSettings.fPaintColor.valueF()));
-            //const auto brush = fStrokeSettings.fStrokeBrush->getBrush();
-            for(auto& set : strokeBrushSet)
-                surf.execute(strokeBrush, set);
-
-            mBitmap.reset();
-
-            QRect baseRect = fGlobalRect;
-            baseRect.translate(-surf.zeroTilePos());
-            const auto pixRect = surf.pixelBoundingRect();
-            baseRect.setSize(QSize(pixRect.width(), pixRect.height()));
-            setBaseGlobalRect(baseRect);
-
-            const QMargins iMargins(baseRect.left() - fGlobalRect.left(),
-                                    baseRect.top() - fGlobalRect.top(),
-                                    fGlobalRect.right() - baseRect.right(),
-                                    fGlobalRect.bottom() - baseRect.bottom());
-            mBitmap = surf.toBitmap(iMargins);
+            // the strokes are painted over the rendered fill by sub-tasks
         } else {
             fStrokeSettings.applyPainterSettingsSk(&paint);
             canvas->drawPath(fOutlinePath, paint);
         }
     }
 }
+
+void PathBoxRenderData::spawnSubTasks() {
+    QList<BrushStrokeSet> sets;
+    sets.swap(mStrokeSets);
+    BrushStrokeSubTaskSpawner::sSpawn(ref<PathBoxRenderData>(), sets);
+}
+
+void PathBoxRenderData::setBrushStrokesResult(const AutoTiledSurface& surf) {
+    QRect baseRect = fGlobalRect;
+    baseRect.translate(-surf.zeroTilePos());
+    const auto pixRect = surf.pixelBoundingRect();
+    baseRect.setSize(QSize(pixRect.width(), pixRect.height()));
+    setBaseGlobalRect(baseRect);
+
+    const QMargins iMargins(baseRect.left() - fGlobalRect.left(),
+                            baseRect.top() - fGlobalRect.top(),
+                            fGlobalRect.right() - baseRect.right(),
+                            fGlobalRect.bottom() - baseRect.bottom());
+    mBitmap = surf.toBitmap(iMargins);
+    fRenderedImage = SkiaHelpers::transferDataToSkImage(mBitmap);
+}
@@ -18,6 +18,8 @@
 #define PATHBOXRENDERDATA_H
 #include "boxrenderdata.h"
 #include "Animators/paintsettingsanimator.h"
+#include "Paint/brushstroke.h"
+struct AutoTiledSurface;
 
 struct PathBoxRenderData : public BoxRenderData {
     PathBoxRenderData(BoundingBox * const parentBox);
@@ -33,8 +35,17 @@ struct PathBoxRenderData : public BoxRenderData {
 
     void updateRelBoundingRect();
     QPointF getCenterPosition();
+
+    //! @brief Replaces the rendered image with the brush painted surface.
+    void setBrushStrokesResult(const AutoTiledSurface& surf);
 protected:
     void drawSk(SkCanvas * const canvas);
+
+    bool hasSubTasks() const { return !mStrokeSets.isEmpty(); }
+    void spawnSubTasks();
+private:
+    //! @brief Brush outline, painted in parallel bands after the fill
+    QList<BrushStrokeSet> mStrokeSets;
 };
 
 #endif // PATHBOXRENDERDATA_H
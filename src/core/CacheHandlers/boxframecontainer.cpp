@@ -0,0 +1,44 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "boxframecontainer.h"
+#include "../Boxes/boxrenderdata.h"
+#include "../Boxes/boundingbox.h"
+
+BoxFrameContainer::BoxFrameContainer(
+        BoxRenderData * const data,
+        const FrameRange &range,
+        HddCachableCacheHandler * const parent) :
+    ImageCacheContainer(data->fRenderedImage, range, parent),
+    fResolution(data->fResolution),
+    fRelFrame(data->fRelFrame),
+    mData(data->makeCopy(nullptr)) {
+    setRecreateCostUs(data->totalProcessingUs());
+}
+
+bool BoxFrameContainer::currentRelFrame(int& frame) const {
+    if(!mData || !mData->fParentBox) return false;
+    frame = mData->fParentBox->anim_getCurrentRelFrame();
+    return true;
+}
+
+stdsptr<BoxRenderData> BoxFrameContainer::renderDataAt(
+        const qreal relFrame) const {
+    if(!mData || !mImageSk) return nullptr;
+    const auto copy = mData->makeCopy(mImageSk);
+    if(copy) copy->fRelFrame = relFrame;
+    return copy;
+}
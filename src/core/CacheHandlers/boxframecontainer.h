@@ -0,0 +1,42 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOXFRAMECONTAINER_H
+#define BOXFRAMECONTAINER_H
+#include "imagecachecontainer.h"
+struct BoxRenderData;
+
+//! @brief Rendered image of a single box, valid for a range of frames
+//! over which the box and its ancestors do not change.
+class BoxFrameContainer : public ImageCacheContainer {
+public:
+    BoxFrameContainer(BoxRenderData * const data,
+                      const FrameRange &range,
+                      HddCachableCacheHandler * const parent);
+
+    //! @brief Returns finished render data drawing the cached image.
+    stdsptr<BoxRenderData> renderDataAt(const qreal relFrame) const;
+
+    const qreal fResolution;
+    const qreal fRelFrame;
+protected:
+    bool currentRelFrame(int& frame) const;
+private:
+    //! @brief Render data copy holding the geometry, without pixels.
+    const stdsptr<BoxRenderData> mData;
+};
+
+#endif // BOXFRAMECONTAINER_H
@@ -0,0 +1,173 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cachearena.h"
+#include "Private/esettings.h"
+#include <QDir>
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+#define ARENA_FILE_SIZE (qint64(256)*1024*1024)
+#define EXTENT_ALIGNMENT qint64(4096)
+
+static qint64 alignedSize(const qint64 size) {
+    const qint64 nonZero = qMax(qint64(1), size);
+    return (nonZero + EXTENT_ALIGNMENT - 1)/EXTENT_ALIGNMENT*EXTENT_ALIGNMENT;
+}
+
+//! @brief Allocates the disk blocks of the whole file. Writes through
+//! the mapping of a sparse file raise SIGBUS once the disk is full.
+static bool reserveSpace(QFile& file, const qint64 size) {
+#ifdef Q_OS_LINUX
+    if(posix_fallocate(file.handle(), 0, size) != 0) return false;
+    return file.size() == size;
+#else
+    // write zeroes, resize would leave the file sparse
+    const qint64 chunkSize = 1024*1024;
+    const QByteArray zeroes(static_cast<int>(chunkSize), '\0');
+    for(qint64 written = 0; written < size; written += chunkSize) {
+        const qint64 len = qMin(chunkSize, size - written);
+        if(file.write(zeroes.constData(), len) != len) return false;
+    }
+    return file.flush();
+#endif
+}
+
+CacheExtent::CacheExtent(const stdsptr<CacheArenaFile>& file,
+                         const qint64 offset, const qint64 capacity,
+                         const qint64 size, uchar* const data) :
+    mFile(file), mOffset(offset), mCapacity(capacity),
+    mSize(size), mData(data) {}
+
+CacheExtent::~CacheExtent() {
+    if(mFile->release(mOffset, mCapacity)) CacheArena::sReleaseUnused();
+}
+
+CacheArenaFile::CacheArenaFile(const QString& folder, const qint64 size) :
+    mFile(QDir(folder).filePath("enve_cache_XXXXXX")) {
+    if(!mFile.open()) return;
+    // refuse the arena if the disk space can not be reserved,
+    // the cached data then stays in memory
+    if(!reserveSpace(mFile, size)) {
+        mFile.resize(0);
+        return;
+    }
+    mData = mFile.map(0, size);
+    if(!mData) return;
+    mSize = size;
+    mFree.insert(0, size);
+}
+
+CacheArenaFile::~CacheArenaFile() {
+    // the temporary file is removed with mFile
+    if(mData) mFile.unmap(mData);
+}
+
+bool CacheArenaFile::isUnused() {
+    QMutexLocker lock(&mMutex);
+    return mFree.count() == 1 && mFree.first() == mSize;
+}
+
+stdsptr<CacheExtent> CacheArenaFile::allocate(const qint64 size) {
+    const qint64 capacity = alignedSize(size);
+    QMutexLocker lock(&mMutex);
+    for(auto it = mFree.begin(); it != mFree.end(); it++) {
+        if(it.value() < capacity) continue;
+        const qint64 offset = it.key();
+        const qint64 remaining = it.value() - capacity;
+        mFree.erase(it);
+        if(remaining > 0) mFree.insert(offset + capacity, remaining);
+        const auto data = mData + offset;
+        return stdsptr<CacheExtent>(new CacheExtent(ref<CacheArenaFile>(),
+                                                    offset, capacity,
+                                                    size, data));
+    }
+    return nullptr;
+}
+
+bool CacheArenaFile::release(const qint64 offset, const qint64 capacity) {
+    QMutexLocker lock(&mMutex);
+    qint64 start = offset;
+    qint64 end = offset + capacity;
+    // merge with the following free extent
+    const auto next = mFree.find(end);
+    if(next != mFree.end()) {
+        end += next.value();
+        mFree.erase(next);
+    }
+    // merge with the preceding free extent
+    auto prev = mFree.lowerBound(start);
+    if(prev != mFree.begin()) {
+        prev--;
+        if(prev.key() + prev.value() == start) {
+            start = prev.key();
+            mFree.erase(prev);
+        }
+    }
+    mFree.insert(start, end - start);
+    return start == 0 && end == mSize;
+}
+
+stdsptr<CacheExtent> CacheArena::sAllocate(const qint64 size) {
+    return sInstance().allocate(size);
+}
+
+void CacheArena::sReleaseUnused() {
+    sInstance().releaseUnused();
+}
+
+CacheArena& CacheArena::sInstance() {
+    static CacheArena instance;
+    return instance;
+}
+
+stdsptr<CacheExtent> CacheArena::allocate(const qint64 size) {
+    QMutexLocker lock(&mMutex);
+    for(const auto& file : mFiles) {
+        if(const auto extent = file->allocate(size)) return extent;
+    }
+    const auto& sett = *eSettings::sInstance;
+    const qint64 fileSize = qMax(ARENA_FILE_SIZE, alignedSize(size));
+    if(sett.fHddCacheMBCap.fValue > 0) {
+        const qint64 cap = qint64(sett.fHddCacheMBCap.fValue)*1024*1024;
+        if(mTotalSize + fileSize > cap) return nullptr;
+    }
+    const QString folder = sett.fHddCacheFolder.isEmpty() ?
+                QDir::tempPath() : sett.fHddCacheFolder;
+    const auto file = enve::make_shared<CacheArenaFile>(folder, fileSize);
+    if(!file->isValid()) return nullptr;
+    mFiles << file;
+    mTotalSize += file->capacity();
+    return file->allocate(size);
+}
+
+void CacheArena::releaseUnused() {
+    QMutexLocker lock(&mMutex);
+    bool spareKept = false;
+    for(int i = 0; i < mFiles.count(); i++) {
+        const auto& file = mFiles.at(i);
+        if(!file->isUnused()) continue;
+        // oversized files are never kept as the spare
+        if(!spareKept && file->capacity() == ARENA_FILE_SIZE) {
+            spareKept = true;
+            continue;
+        }
+        // the last reference, extents hold the file while in use
+        mTotalSize -= file->capacity();
+        mFiles.removeAt(i--);
+    }
+}
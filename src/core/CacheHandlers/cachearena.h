@@ -0,0 +1,98 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CACHEARENA_H
+#define CACHEARENA_H
+#include <QTemporaryFile>
+#include <QMutex>
+#include <QMap>
+#include "smartPointers/ememory.h"
+
+class CacheArenaFile;
+
+//! @brief Region of the hdd cache arena, released on destruction.
+class CacheExtent {
+    friend class CacheArenaFile;
+public:
+    ~CacheExtent();
+
+    const uchar* data() const { return mData; }
+    uchar* data() { return mData; }
+    qint64 size() const { return mSize; }
+private:
+    CacheExtent(const stdsptr<CacheArenaFile>& file,
+                const qint64 offset, const qint64 capacity,
+                const qint64 size, uchar* const data);
+
+    const stdsptr<CacheArenaFile> mFile;
+    const qint64 mOffset;
+    const qint64 mCapacity;
+    const qint64 mSize;
+    uchar* const mData;
+};
+
+//! @brief Memory-mapped file divided into extents.
+class CacheArenaFile : public StdSelfRef {
+    e_OBJECT
+    friend class CacheExtent;
+protected:
+    CacheArenaFile(const QString& folder, const qint64 size);
+public:
+    ~CacheArenaFile();
+
+    bool isValid() const { return mData; }
+    qint64 capacity() const { return mSize; }
+    //! @brief True if no extent is in use.
+    bool isUnused();
+
+    //! @brief Returns nullptr if no free extent is large enough.
+    stdsptr<CacheExtent> allocate(const qint64 size);
+private:
+    //! @brief Returns true if the file became unused.
+    bool release(const qint64 offset, const qint64 capacity);
+
+    QTemporaryFile mFile;
+    qint64 mSize = 0;
+    uchar* mData = nullptr;
+
+    QMutex mMutex;
+    //! @brief Free extents, offset -> capacity
+    QMap<qint64, qint64> mFree;
+};
+
+//! @brief Hdd cache in a few large memory-mapped files
+//! located in eSettings::fHddCacheFolder and capped at fHddCacheMBCap.
+class CacheArena {
+public:
+    //! @brief Returns nullptr if the cap has been reached
+    //! or no arena file could be created.
+    static stdsptr<CacheExtent> sAllocate(const qint64 size);
+    //! @brief Unmaps and removes unused files, keeps one spare.
+    static void sReleaseUnused();
+private:
+    CacheArena() {}
+
+    static CacheArena& sInstance();
+
+    stdsptr<CacheExtent> allocate(const qint64 size);
+    void releaseUnused();
+
+    QMutex mMutex;
+    QList<stdsptr<CacheArenaFile>> mFiles;
+    qint64 mTotalSize = 0;
+};
+
+#endif // CACHEARENA_H
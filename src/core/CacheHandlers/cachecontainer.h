@@ -19,6 +19,7 @@
 #include "smartPointers/stdselfref.h"
 
 class CacheContainer : public StdSelfRef {
+    friend class MemoryDataHandler;
 protected:
     CacheContainer();
 public:
@@ -48,6 +49,15 @@ public:
     }
 
     bool inUse() const { return mInUse; }
+
+    //! @brief Estimated time needed to recreate the data, in microseconds
+    qint64 recreateCostUs() const { return mRecreateCostUs; }
+    void setRecreateCostUs(const qint64 us) { mRecreateCostUs = us; }
+
+    //! @brief Data can be brought back without recreating it
+    virtual bool hasHddCopy() const { return false; }
+    //! @brief Distance in frames from the range of frames currently in use
+    virtual int frameDistance() const { return 0; }
 protected:
     void addToMemoryManagment();
     void removeFromMemoryManagment();
@@ -55,6 +65,11 @@ protected:
 private:
     bool mHandledByMemoryHandler = false;
     int mInUse = 0;
+    qint64 mRecreateCostUs = 0;
+
+    //! @brief Intrusive MemoryDataHandler list links
+    CacheContainer* mLruPrev = nullptr;
+    CacheContainer* mLruNext = nullptr;
 };
 
 #endif // MINIMALCACHECONTAINER_H
@@ -86,6 +86,10 @@ public:
         mUsedRange.clearRange();
     }
 
+    const iValueRange& useRange() const {
+        return mUsedRange.range();
+    }
+
     auto begin() const { return mConts.begin(); }
     auto end() const { return mConts.begin(); }
 private:
@@ -28,27 +28,27 @@ protected:
     virtual stdsptr<eHddTask> createTmpFileDataLoader() = 0;
 public:
     ~HddCachable() {
-        if(mTmpFile) scheduleDeleteTmpFile();
+        if(mTmpData) scheduleDeleteTmpFile();
     }
 
     int free_RAM_k() final {
         const int bytes = clearMemory();
         setDataInMemory(false);
-        if(!mTmpFile && !mTmpSaveTask) noDataLeft_k();
+        if(!mTmpData && !mTmpSaveTask) noDataLeft_k();
         return bytes;
     }
 
     eTask* scheduleDeleteTmpFile() {
-        if(!mTmpFile) return nullptr;
+        if(!mTmpData) return nullptr;
         const auto updatable =
-                enve::make_shared<TmpDeleter>(mTmpFile);
-        mTmpFile.reset();
+                enve::make_shared<TmpDeleter>(mTmpData);
+        mTmpData.reset();
         updatable->queTask();
         return updatable.get();
     }
 
     eTask* scheduleSaveToTmpFile() {
-        if(mTmpSaveTask || mTmpFile) return nullptr;
+        if(mTmpSaveTask || mTmpData) return nullptr;
         mTmpSaveTask = createTmpFileDataSaver();
         mTmpSaveTask->queTask();
         return mTmpSaveTask.get();
@@ -57,7 +57,7 @@ public:
     eTask* scheduleLoadFromTmpFile() {
         if(storesDataInMemory()) return nullptr;
         if(mTmpLoadTask) return mTmpLoadTask.get();
-        if(!mTmpSaveTask && !mTmpFile) return nullptr;
+        if(!mTmpSaveTask && !mTmpData) return nullptr;
 
         mTmpLoadTask = createTmpFileDataLoader();
         if(mTmpSaveTask)
@@ -66,16 +66,18 @@ public:
         return mTmpLoadTask.get();
     }
 
-    void setDataSavedToTmpFile(const qsptr<QTemporaryFile> &tmpFile) {
+    void setDataSavedToTmpFile(const stdsptr<CacheExtent> &tmpData) {
         mTmpSaveTask.reset();
-        mTmpFile = tmpFile;
+        mTmpData = tmpData;
     }
 
     bool storesDataInMemory() const {
         return mDataInMemory;
     }
 
-    qsptr<QTemporaryFile> getTmpFile() const { return mTmpFile; }
+    stdsptr<CacheExtent> getTmpData() const { return mTmpData; }
+
+    bool hasHddCopy() const { return static_cast<bool>(mTmpData); }
 protected:
     void afterDataLoadedFromTmpFile() {
         setDataInMemory(true);
@@ -86,14 +88,14 @@ protected:
     void afterDataReplaced() {
         setDataInMemory(true);
         updateInMemoryManagment();
-        if(mTmpFile) scheduleDeleteTmpFile();
+        if(mTmpData) scheduleDeleteTmpFile();
     }
 
     void setDataInMemory(const bool dataInMemory) {
         mDataInMemory = dataInMemory;
     }
 
-    qsptr<QTemporaryFile> mTmpFile;
+    stdsptr<CacheExtent> mTmpData;
 private:
     bool mDataInMemory = false;
     stdsptr<eTask> mTmpLoadTask;
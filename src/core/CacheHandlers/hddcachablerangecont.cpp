@@ -35,6 +35,19 @@ bool HddCachableRangeCont::inRange(const int unary) const {
     return mRange.inRange(unary);
 }
 
+int HddCachableRangeCont::frameDistance() const {
+    FrameRange ref{1, 0};
+    if(mParentCacheHandler_k) ref = mParentCacheHandler_k->useRange();
+    if(!ref.isValid()) {
+        int frame;
+        if(!currentRelFrame(frame)) return 0;
+        ref = {frame, frame};
+    }
+    if(mRange.fMax < ref.fMin) return ref.fMin - mRange.fMax;
+    if(mRange.fMin > ref.fMax) return mRange.fMin - ref.fMax;
+    return 0;
+}
+
 void HddCachableRangeCont::setUnaryRange(const int unary) {
     mRange.fMin = unary;
     mRange.fMax = unary;
@@ -46,6 +46,14 @@ public:
     void setRangeMin(const int min);
     void setRange(const FrameRange &range);
     bool inRange(const int unary) const;
+
+    int frameDistance() const;
+protected:
+    //! @brief Frame of reference when the cache handler has no use range
+    virtual bool currentRelFrame(int& frame) const {
+        Q_UNUSED(frame)
+        return false;
+    }
 private:
     FrameRange mRange;
     HddCachableCacheHandler * const mParentCacheHandler_k;
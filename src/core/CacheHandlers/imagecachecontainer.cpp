@@ -18,6 +18,7 @@
 #include "tmpdeleter.h"
 #include "canvas.h"
 #include "skia/skiahelpers.h"
+#include "skia/pixelruncodec.h"
 
 ImageCacheContainer::ImageCacheContainer(const FrameRange &range,
                                          HddCachableCacheHandler * const parent) :
@@ -32,6 +33,7 @@ ImageCacheContainer::ImageCacheContainer(const sk_sp<SkImage> &img,
 
 void ImageCacheContainer::replaceImageSk(const sk_sp<SkImage> &img) {
     mImageSk = img;
+    if(img) mImageWidth = img->width();
     afterDataReplaced();
 }
 
@@ -73,8 +75,39 @@ stdsptr<eHddTask> ImageCacheContainer::createTmpFileDataSaver() {
 }
 
 stdsptr<eHddTask> ImageCacheContainer::createTmpFileDataLoader() {
-    const ImgLoader::Func func = [this](sk_sp<SkImage> img) {
-        setDataLoadedFromTmpFile(img);
+    const stdptr<ImageCacheContainer> ptr = this;
+    // the container might be removed from its handler while loading
+    const ImgLoader::Func func = [ptr](sk_sp<SkImage> img) {
+        if(ptr) ptr->setDataLoadedFromTmpFile(img);
     };
-    return enve::make_shared<ImgLoader>(mTmpFile, this, func);
+    return enve::make_shared<ImgLoader>(mTmpData, this, func);
+}
+
+void ImgSaver::encode() {
+    SkPixmap pix;
+    if(!mImage->peekPixels(&pix)) {
+        mImage = mImage->makeRasterImage();
+        if(!mImage || !mImage->peekPixels(&pix))
+            RuntimeThrow("Could not peek image pixels");
+    }
+    mEncoded = PixelRunCodec::encode(pix);
+    mImage.reset();
+}
+
+void ImgSaver::write(eWriteStream& dst) {
+    const int size = mEncoded.size();
+    dst << size;
+    dst.write(mEncoded.constData(), size);
+    mEncoded.clear();
+}
+
+void ImgLoader::read(eReadStream& src) {
+    int size;
+    src >> size;
+    QByteArray encoded(size, Qt::Uninitialized);
+    if(src.read(encoded.data(), size) != size)
+        RuntimeThrow("Could not read temporary file.");
+    // decoding continues on a backup thread, freeing the hdd thread
+    hddPartFinished();
+    mImage = PixelRunCodec::decodeImage(encoded);
 }
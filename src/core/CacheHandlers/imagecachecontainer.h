@@ -38,11 +38,14 @@ public:
     void drawSk(SkCanvas * const canvas, const SkFilterQuality filter);
 
     sk_sp<SkImage> getImageSk();
+    //! @brief Width of the image, known also when stored on hdd
+    int getImageWidth() const { return mImageWidth; }
 
     void setDataLoadedFromTmpFile(const sk_sp<SkImage> &img);
     void replaceImageSk(const sk_sp<SkImage> &img);
 protected:
     sk_sp<SkImage> mImageSk;
+    int mImageWidth = 0;
 };
 
 
@@ -52,17 +55,18 @@ protected:
 class ImgSaver : public TmpSaver {
     e_OBJECT
 public:
-    typedef std::function<void(const qsptr<QTemporaryFile>&)> Func;
+    typedef std::function<void(const stdsptr<CacheExtent>&)> Func;
 protected:
     ImgSaver(ImageCacheContainer* const target,
              const sk_sp<SkImage> &image) :
         TmpSaver(target), mImage(image) {}
 
-    void write(eWriteStream& dst) {
-        SkiaHelpers::writeImg(mImage, dst);
-    }
+    bool hasEncodeStep() const { return true; }
+    void encode();
+    void write(eWriteStream& dst);
 private:
-    const sk_sp<SkImage> mImage;
+    sk_sp<SkImage> mImage;
+    QByteArray mEncoded;
 };
 
 class ImgLoader : public TmpLoader {
@@ -70,14 +74,12 @@ class ImgLoader : public TmpLoader {
 public:
     typedef std::function<void(sk_sp<SkImage> img)> Func;
 protected:
-    ImgLoader(const qsptr<QTemporaryFile> &file,
+    ImgLoader(const stdsptr<CacheExtent> &data,
               ImageCacheContainer* const target,
               const Func& finishedFunc) :
-        TmpLoader(file, target), mFinishedFunc(finishedFunc) {}
+        TmpLoader(data, target), mFinishedFunc(finishedFunc) {}
 
-    void read(eReadStream& src) {
-        mImage = SkiaHelpers::readImg(src);
-    }
+    void read(eReadStream& src);
     void afterProcessing() {
         if(mFinishedFunc) mFinishedFunc(mImage);
     }
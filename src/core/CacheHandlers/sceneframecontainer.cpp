@@ -26,12 +26,20 @@ SceneFrameContainer::SceneFrameContainer(
     ImageCacheContainer(data->fRenderedImage, range, parent),
     fBoxState(data->fBoxStateId),
     fResolution(data->fResolution),
-    mScene(scene) {}
+    mScene(scene) {
+    setRecreateCostUs(data->totalProcessingUs());
+}
+
+bool SceneFrameContainer::currentRelFrame(int& frame) const {
+    if(!mScene) return false;
+    frame = mScene->anim_getCurrentRelFrame();
+    return true;
+}
 
 stdsptr<eHddTask> SceneFrameContainer::createTmpFileDataLoader() {
     const ImgLoader::Func func = [this](sk_sp<SkImage> img) {
         setDataLoadedFromTmpFile(img);
         if(mScene) mScene->setSceneFrame(ref<SceneFrameContainer>());
     };
-    return enve::make_shared<ImgLoader>(mTmpFile, this, func);
+    return enve::make_shared<ImgLoader>(mTmpData, this, func);
 }
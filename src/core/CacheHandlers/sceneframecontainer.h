@@ -30,6 +30,7 @@ public:
     const qreal fResolution;
 protected:
     stdsptr<eHddTask> createTmpFileDataLoader();
+    bool currentRelFrame(int& frame) const;
 private:
     const qptr<Canvas> mScene;
 };
@@ -33,7 +33,7 @@ stdsptr<eHddTask> SoundCacheContainer::createTmpFileDataSaver() {
 }
 
 stdsptr<eHddTask> SoundCacheContainer::createTmpFileDataLoader() {
-    return enve::make_shared<SoundContainerTmpFileDataLoader>(mTmpFile, this);
+    return enve::make_shared<SoundContainerTmpFileDataLoader>(mTmpData, this);
 }
 
 int SoundCacheContainer::clearMemory() {
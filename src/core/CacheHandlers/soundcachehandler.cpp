@@ -50,6 +50,21 @@ void SoundDataHandler::afterSourceChanged() {
     for(const auto& handler : mSoundHandlers) {
         handler->afterSourceChanged();
     }
+    readPeaks();
+}
+
+void SoundDataHandler::readPeaks() {
+    mPeaks.reset();
+    mPeaksReader.reset();
+    if(mFileMissing) return;
+    try {
+        // own stream, reading peaks must not disturb the second readers
+        const auto audio = AudioStreamsData::sOpen(mFilePath);
+        mPeaksReader = enve::make_shared<SoundPeaksReader>(this, audio);
+        mPeaksReader->queTask();
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+    }
 }
 
 #include <QFileDialog>
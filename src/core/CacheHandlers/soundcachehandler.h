@@ -21,6 +21,7 @@
 #include "CacheHandlers/soundcachecontainer.h"
 #include "FileCacheHandlers/audiostreamsdata.h"
 #include "FileCacheHandlers/soundreader.h"
+#include "FileCacheHandlers/soundpeaksreader.h"
 class SoundHandler;
 class SingleSound;
 
@@ -70,11 +71,26 @@ public:
                               samples, iValueRange{secondId, secondId},
                               &mSecondsCache));
     }
+
+    //! @brief Waveform pyramid, nullptr until read in the background.
+    const stdsptr<const SoundPeaks>& getPeaks() const { return mPeaks; }
+
+    void peaksReaderFinished(SoundPeaksReader * const reader,
+                             const stdsptr<SoundPeaks>& peaks) {
+        if(reader != mPeaksReader.get()) return;
+        mPeaksReader.reset();
+        mPeaks = peaks;
+    }
 private:
+    void readPeaks();
+
     QList<SoundHandler*> mSoundHandlers;
     QList<int> mSecondsBeingRead;
     QList<stdsptr<SoundReaderForMerger>> mSecondReaders;
     HddCachableCacheHandler mSecondsCache;
+
+    stdsptr<const SoundPeaks> mPeaks;
+    stdsptr<SoundPeaksReader> mPeaksReader;
 };
 
 class SoundHandler : public StdSelfRef {
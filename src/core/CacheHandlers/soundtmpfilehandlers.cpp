@@ -18,9 +18,9 @@
 #include "soundcachecontainer.h"
 
 SoundContainerTmpFileDataLoader::SoundContainerTmpFileDataLoader(
-        const qsptr<QTemporaryFile> &file,
+        const stdsptr<CacheExtent> &data,
         SoundCacheContainer *target) :
-    TmpLoader(file, target), mTarget(target) {}
+    TmpLoader(data, target), mTarget(target) {}
 
 void SoundContainerTmpFileDataLoader::read(eReadStream& src) {
     mSamples = Samples::sRead(src);
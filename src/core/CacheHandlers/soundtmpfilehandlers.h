@@ -19,7 +19,7 @@
 #include "tmpdeleter.h"
 #include "soundcachecontainer.h"
 #include "Tasks/updatable.h"
-#include <QTemporaryFile>
+#include "cachearena.h"
 #include "skia/skiaincludes.h"
 #include "tmpsaver.h"
 #include "tmploader.h"
@@ -28,7 +28,7 @@ class SoundCacheContainer;
 class SoundContainerTmpFileDataLoader : public TmpLoader {
     e_OBJECT
 public:
-    SoundContainerTmpFileDataLoader(const qsptr<QTemporaryFile> &file,
+    SoundContainerTmpFileDataLoader(const stdsptr<CacheExtent> &data,
                                     SoundCacheContainer *target);
     void read(eReadStream& src);
     void afterProcessing();
@@ -18,7 +18,7 @@
 #include "imagecachecontainer.h"
 #include "skia/skiahelpers.h"
 
-TmpDeleter::TmpDeleter(const qsptr<QTemporaryFile> &file) :
-    mTmpFile(file) {}
+TmpDeleter::TmpDeleter(const stdsptr<CacheExtent> &data) :
+    mTmpData(data) {}
 
-void TmpDeleter::process() { mTmpFile.reset(); }
+void TmpDeleter::process() { mTmpData.reset(); }
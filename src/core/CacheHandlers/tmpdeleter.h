@@ -17,16 +17,16 @@
 #ifndef TMPFILEHANDLERS_H
 #define TMPFILEHANDLERS_H
 #include "Tasks/updatable.h"
-#include <QTemporaryFile>
+#include "cachearena.h"
 
 class TmpDeleter : public eHddTask {
     e_OBJECT
 protected:
-    TmpDeleter(const qsptr<QTemporaryFile> &file);
+    TmpDeleter(const stdsptr<CacheExtent> &data);
 public:
     void process();
 private:
-    qsptr<QTemporaryFile> mTmpFile;
+    stdsptr<CacheExtent> mTmpData;
 };
 
 
@@ -15,22 +15,25 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "tmploader.h"
+#include <QBuffer>
 
-TmpLoader::TmpLoader(const qsptr<QTemporaryFile> &file,
+TmpLoader::TmpLoader(const stdsptr<CacheExtent> &data,
                      HddCachable * const target) :
-    mTmpFile(file), mTarget(target) {}
+    mTmpData(data), mTarget(target) {}
 
 void TmpLoader::process() {
-    if(!mTmpFile) return;
-    if(mTmpFile->open()) {
-        eReadStream src(mTmpFile.get());
-        read(src);
-        mTmpFile->close();
-    } else {
-        RuntimeThrow("Could not open temporary file for reading.");
-    }
+    if(!mTmpData) return;
+    const auto data = reinterpret_cast<const char*>(mTmpData->data());
+    const int size = static_cast<int>(mTmpData->size());
+    // reads straight from the mapped arena, without copying
+    QByteArray bytes = QByteArray::fromRawData(data, size);
+    QBuffer buffer(&bytes);
+    if(!buffer.open(QIODevice::ReadOnly))
+        RuntimeThrow("Could not open cached data for reading.");
+    eReadStream src(&buffer);
+    read(src);
 }
 
 void TmpLoader::beforeProcessing(const Hardware) {
-    if(mTarget && !mTmpFile) mTmpFile = mTarget->getTmpFile();
+    if(mTarget && !mTmpData) mTmpData = mTarget->getTmpData();
 }
@@ -17,19 +17,19 @@
 #ifndef TMPLOADER_H
 #define TMPLOADER_H
 #include "Tasks/updatable.h"
-#include <QTemporaryFile>
+#include "cachearena.h"
 #include "hddcachablecont.h"
 
 class TmpLoader : public eHddTask {
 public:
-    TmpLoader(const qsptr<QTemporaryFile> &file,
+    TmpLoader(const stdsptr<CacheExtent> &data,
               HddCachable * const target);
 
     virtual void read(eReadStream& src) = 0;
     void process();
     void beforeProcessing(const Hardware);
 private:
-    qsptr<QTemporaryFile> mTmpFile;
+    stdsptr<CacheExtent> mTmpData;
     const stdptr<HddCachable> mTarget;
 };
 
@@ -15,24 +15,46 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "tmpsaver.h"
+#include "Private/Tasks/taskscheduler.h"
+#include <QBuffer>
 
 TmpSaver::TmpSaver(HddCachable* const target) :
     mTarget(target) {}
 
 void TmpSaver::process() {
-    mTmpFile = qsptr<QTemporaryFile>(new QTemporaryFile());
-    if(mTmpFile->open()) {
-        eWriteStream dst(mTmpFile.get());
+    if(hasEncodeStep() && !mEncoded) return encode();
+    // serialized once, write() does not have to be repeatable
+    QByteArray bytes;
+    {
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        eWriteStream dst(&buffer);
         write(dst);
-        mTmpFile->close();
-        mSavingSuccessful = true;
-    } else {
-        mSavingSuccessful = false;
     }
+    mTmpData = CacheArena::sAllocate(bytes.size());
+    // data stays in memory if the cache is full
+    mSavingSuccessful = static_cast<bool>(mTmpData);
+    if(!mSavingSuccessful) return;
+    memcpy(mTmpData->data(), bytes.constData(),
+           static_cast<size_t>(bytes.size()));
 }
 
 void TmpSaver::afterProcessing() {
     if(!mTarget) return;
     if(!mSavingSuccessful) return;
-    mTarget->setDataSavedToTmpFile(mTmpFile);
+    mTarget->setDataSavedToTmpFile(mTmpData);
+}
+
+bool TmpSaver::nextStep() {
+    if(!hasEncodeStep() || mEncoded) return false;
+    mEncoded = true;
+    return true;
+}
+
+void TmpSaver::queTaskNow() {
+    if(hasEncodeStep() && !mEncoded) {
+        TaskScheduler::sGetInstance()->queCpuTask(ref<eTask>());
+    } else {
+        TaskScheduler::sGetInstance()->queHddTask(ref<eTask>());
+    }
 }
@@ -17,7 +17,7 @@
 #ifndef TMPSAVER_H
 #define TMPSAVER_H
 #include "Tasks/updatable.h"
-#include <QTemporaryFile>
+#include "cachearena.h"
 #include "hddcachablecont.h"
 
 class TmpSaver : public eHddTask {
@@ -29,10 +29,20 @@ public:
 
     void process();
     void afterProcessing();
+    //! @brief True once, after the encode step, to move on to the write.
+    bool nextStep();
+protected:
+    void queTaskNow();
+
+    //! @brief Optional step run on a cpu thread before the data is written,
+    //! e.g., compression. Keeps the hdd thread busy with i/o only.
+    virtual void encode() {}
+    virtual bool hasEncodeStep() const { return false; }
 private:
     const stdptr<HddCachable> mTarget;
+    bool mEncoded = false;
     bool mSavingSuccessful = false;
-    qsptr<QTemporaryFile> mTmpFile;
+    stdsptr<CacheExtent> mTmpData;
 };
 
 
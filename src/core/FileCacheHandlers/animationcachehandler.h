@@ -30,8 +30,22 @@ public:
     virtual int getFrameCount() const = 0;
     virtual void reload() = 0;
 
+    //! @brief Scale of the image relative to the source frames,
+    //! below one if the handler loaded a downscaled frame
+    virtual qreal getImageScale(const SkImage& image) const {
+        Q_UNUSED(image)
+        return 1;
+    }
+
     sk_sp<SkImage> getFrameCopyAtFrame(const int relFrame);
     sk_sp<SkImage> getFrameCopyAtOrBeforeFrame(const int relFrame);
+
+    //! @brief Resolution fraction the frames are needed at,
+    //! handlers may load downscaled frames accordingly
+    void setResolution(const qreal resolution) {
+        mResolution = qBound(0.01, resolution, 1.);
+    }
 protected:
+    qreal mResolution = 1;
 };
 #endif // ANIMATIONCACHEHANDLER_H
@@ -60,6 +60,48 @@ void AudioStreamsData::updateSwrContext() {
     if(!swr_is_initialized(fSwrContext)) {
         RuntimeThrow("Resampler has not been properly initialized");
     }
+    // decoded samples depend on the output settings
+    fCarry.reset();
+    fLastDstSample = -10*eSoundSettings::sSampleRate();
+}
+
+void AudioStreamsData::resetSession() {
+    fCarry.reset();
+    fLastDstSample = -10*eSoundSettings::sSampleRate();
+    mPrevPacketPts = AV_NOPTS_VALUE;
+    mPrevPrevPacketPts = AV_NOPTS_VALUE;
+    // drop the delayed samples of the previous position
+    if(fSwrContext) swr_init(fSwrContext);
+}
+
+void AudioStreamsData::indexPacket(const AVPacket * const packet) {
+    const int64_t pts = packet->pts;
+    if(pts == AV_NOPTS_VALUE) return;
+    const auto timeBase = fAudioStream->time_base;
+    if(mPrevPacketPts != AV_NOPTS_VALUE) {
+        const int prevSecond = qFloor(mPrevPacketPts*av_q2d(timeBase));
+        const int second = qFloor(pts*av_q2d(timeBase));
+        // the previous packet contains the start of the following seconds
+        const int64_t seekPts = mPrevPrevPacketPts == AV_NOPTS_VALUE ?
+                                mPrevPacketPts : mPrevPrevPacketPts;
+        for(int i = qMax(0, prevSecond + 1); i <= second; i++) {
+            if(!mSecondIndex.contains(i)) mSecondIndex.insert(i, seekPts);
+        }
+    }
+    mPrevPrevPacketPts = mPrevPacketPts;
+    mPrevPacketPts = pts;
+}
+
+bool AudioStreamsData::seekIndexed(const int secondId) {
+    const auto it = mSecondIndex.find(secondId);
+    if(it == mSecondIndex.end()) return false;
+    const int64_t pts = it.value();
+    // never land past the indexed packet
+    const int ret = avformat_seek_file(fFormatContext, fAudioStreamIndex,
+                                       INT64_MIN, pts, pts, 0);
+    if(ret < 0) return false;
+    avcodec_flush_buffers(fCodecContext);
+    return true;
 }
 
 stdsptr<AudioStreamsData> AudioStreamsData::sOpen(const QString &path) {
@@ -17,6 +17,7 @@
 #ifndef AUDIOSTREAMSDATA_H
 #define AUDIOSTREAMSDATA_H
 #include "soundreader.h"
+#include <QMap>
 
 struct AudioStreamsData : public QObject {
 private:
@@ -56,10 +57,22 @@ public:
     AVFrame *fDecodedFrame = nullptr;
     AVCodecContext * fCodecContext = nullptr;
     struct SwrContext * fSwrContext = nullptr;
+    //! @brief Last sample decoded by the session, the next read continues
+    //! without a seek if it starts within a second after it
     int fLastDstSample = 0;
+    //! @brief Decoded samples past the last read second
+    stdsptr<Samples> fCarry;
 
     void updateSwrContext();
 
+    //! @brief Drops the decode session state, call after seeking.
+    void resetSession();
+    //! @brief Adds the packet to the second index, packets have to be
+    //! passed in the decode order.
+    void indexPacket(const AVPacket * const packet);
+    //! @brief Seeks using the second index, false if not indexed yet.
+    bool seekIndexed(const int secondId);
+
     static stdsptr<AudioStreamsData> sOpen(const QString& path);
 private:
     void open(const QString& path, AVFormatContext * const formatContext);
@@ -72,6 +85,12 @@ private:
 
     bool mLocked = false;
     bool mUpdateSwrPlanned = false;
+
+    //! @brief Packet to seek to for each second, one packet earlier than
+    //! the one containing the start of the second to prime the decoder
+    QMap<int, int64_t> mSecondIndex;
+    int64_t mPrevPacketPts = AV_NOPTS_VALUE;
+    int64_t mPrevPrevPacketPts = AV_NOPTS_VALUE;
 };
 
 #endif // AUDIOSTREAMSDATA_H
@@ -0,0 +1,149 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "soundpeaksreader.h"
+#include "audiostreamsdata.h"
+#include "CacheHandlers/soundcachehandler.h"
+
+SoundPeaksReader::SoundPeaksReader(
+        SoundDataHandler * const dataHandler,
+        const stdsptr<AudioStreamsData>& openedAudio) :
+    mDataHandler(dataHandler), mOpenedAudio(openedAudio),
+    mCachePath(SoundPeaks::sCachePath(openedAudio->fPath)) {}
+
+void SoundPeaksReader::beforeProcessing(const Hardware) {
+    mOpenedAudio->lock();
+}
+
+void SoundPeaksReader::afterProcessing() {
+    mOpenedAudio->unlock();
+    if(mDataHandler) mDataHandler->peaksReaderFinished(this, mPeaks);
+}
+
+void SoundPeaksReader::afterCanceled() {
+    mOpenedAudio->unlock();
+    if(mDataHandler) mDataHandler->peaksReaderFinished(this, nullptr);
+}
+
+void SoundPeaksReader::handleException() {
+    // no waveform is drawn for streams that cannot be decoded
+    takeException();
+    afterCanceled();
+}
+
+SoundPeaksReader::~SoundPeaksReader() {
+    if(mSwrContext) swr_free(&mSwrContext);
+}
+
+void SoundPeaksReader::process() {
+    if(!mStarted) {
+        mStarted = true;
+        mPeaks = SoundPeaks::sLoad(mCachePath);
+        if(mPeaks) {
+            mFinished = true;
+            return;
+        }
+        startDecoding();
+    }
+    try {
+        if(decodeChunk()) return;
+    } catch(...) {
+        mFinished = true;
+        throw;
+    }
+    mFinished = true;
+    if(mSwrContext) swr_free(&mSwrContext);
+    mPeaks->finish();
+    mPeaks->save(mCachePath);
+}
+
+bool SoundPeaksReader::nextStep() {
+    return !mFinished;
+}
+
+void SoundPeaksReader::startDecoding() {
+    if(!mOpenedAudio->fOpened) {
+        mFinished = true;
+        RuntimeThrow("Cannot read peaks from closed AudioStream");
+    }
+    const int sampleRate = mOpenedAudio->fAudioStream->codecpar->sample_rate;
+    avformat_seek_file(mOpenedAudio->fFormatContext,
+                       mOpenedAudio->fAudioStreamIndex,
+                       INT64_MIN, 0, 0, 0);
+    avcodec_flush_buffers(mOpenedAudio->fCodecContext);
+    mPeaks = enve::make_shared<SoundPeaks>(sampleRate);
+}
+
+bool SoundPeaksReader::decodeFrame() {
+    const auto formatContext = mOpenedAudio->fFormatContext;
+    const auto audioStreamIndex = mOpenedAudio->fAudioStreamIndex;
+    const auto packet = mOpenedAudio->fPacket;
+    const auto decodedFrame = mOpenedAudio->fDecodedFrame;
+    const auto codecContext = mOpenedAudio->fCodecContext;
+    while(true) {
+        const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
+        if(recRet == 0) return true;
+        if(recRet == AVERROR_EOF) return false;
+        if(recRet != AVERROR(EAGAIN))
+            RuntimeThrow("Did not receive frame from the decoder");
+        if(av_read_frame(formatContext, packet) < 0) {
+            // drain the frames left in the decoder
+            avcodec_send_packet(codecContext, nullptr);
+            continue;
+        }
+        if(packet->stream_index != audioStreamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        const int sendRet = avcodec_send_packet(codecContext, packet);
+        av_packet_unref(packet);
+        if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
+    }
+}
+
+bool SoundPeaksReader::decodeChunk() {
+    const auto decodedFrame = mOpenedAudio->fDecodedFrame;
+    const int sampleRate = mPeaks->sampleRate();
+    const qint64 chunkEnd = mPeaks->sampleCount() +
+                            qint64(sChunkSeconds)*sampleRate;
+    while(mPeaks->sampleCount() < chunkEnd) {
+        if(!decodeFrame()) return false;
+        if(!mSwrContext) {
+            const auto format = static_cast<AVSampleFormat>(decodedFrame->format);
+            const auto layout = decodedFrame->channel_layout ?
+                        decodedFrame->channel_layout :
+                        uint64_t(av_get_default_channel_layout(decodedFrame->channels));
+            mSwrContext = swr_alloc_set_opts(
+                        nullptr,
+                        AV_CH_LAYOUT_MONO, AV_SAMPLE_FMT_FLT, sampleRate,
+                        int64_t(layout), format, decodedFrame->sample_rate,
+                        0, nullptr);
+            if(!mSwrContext || swr_init(mSwrContext) < 0)
+                RuntimeThrow("Could not initialize the peaks resampler");
+        }
+        const int maxOut = swr_get_out_samples(mSwrContext,
+                                               decodedFrame->nb_samples);
+        if(mMono.count() < maxOut) mMono.resize(maxOut);
+        auto dst = reinterpret_cast<uint8_t*>(mMono.data());
+        const int nOut = swr_convert(
+                    mSwrContext, &dst, maxOut,
+                    const_cast<const uint8_t**>(decodedFrame->extended_data),
+                    decodedFrame->nb_samples);
+        av_frame_unref(decodedFrame);
+        if(nOut > 0) mPeaks->addSamples(mMono.constData(), nOut);
+    }
+    return true;
+}
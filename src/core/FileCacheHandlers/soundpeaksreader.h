@@ -0,0 +1,68 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SOUNDPEAKSREADER_H
+#define SOUNDPEAKSREADER_H
+#include "Tasks/updatable.h"
+#include "Sound/soundpeaks.h"
+extern "C" {
+    #include <libswresample/swresample.h>
+}
+
+class SoundDataHandler;
+struct AudioStreamsData;
+
+//! @brief Loads the peak pyramid of a sound file from the hdd cache,
+//! or decodes the whole stream once and stores it there.
+//! Decoding is split into chunks, the task re-queues itself after each
+//! so that other hdd tasks are not blocked for the whole file.
+class SoundPeaksReader : public eHddTask {
+    e_OBJECT
+protected:
+    SoundPeaksReader(SoundDataHandler * const dataHandler,
+                     const stdsptr<AudioStreamsData>& openedAudio);
+
+    void beforeProcessing(const Hardware);
+    void afterProcessing();
+    void afterCanceled();
+    void handleException();
+public:
+    ~SoundPeaksReader();
+
+    void process();
+    bool nextStep();
+private:
+    void startDecoding();
+    //! @brief Decodes about sChunkSeconds, returns false at the end.
+    bool decodeChunk();
+    bool decodeFrame();
+
+    //! @brief Seconds of audio decoded per step
+    static const int sChunkSeconds = 10;
+
+    const qptr<SoundDataHandler> mDataHandler;
+    const stdsptr<AudioStreamsData> mOpenedAudio;
+    const QString mCachePath;
+    stdsptr<SoundPeaks> mPeaks;
+
+    bool mStarted = false;
+    bool mFinished = false;
+    //! @brief Mono mixdown at the source sample rate
+    SwrContext* mSwrContext = nullptr;
+    QVector<float> mMono;
+};
+
+#endif // SOUNDPEAKSREADER_H
@@ -65,6 +65,9 @@ void SoundReader::readFrame() {
     const uint dstSampleSize = static_cast<uint>(mSettings.bytesPerSample());
     const int dstChCount = av_get_channel_layout_nb_channels(dstChLayout);
     const bool dstPlanar = mSettings.planarFormat();
+    const int nPlanes = dstPlanar ? dstChCount : 1;
+    const uint planeSampleSize = dstPlanar ? dstSampleSize :
+                                             dstSampleSize*uint(dstChCount);
 
     const auto formatContext = mOpenedAudio->fFormatContext;
     const auto audioStreamIndex = mOpenedAudio->fAudioStreamIndex;
@@ -78,51 +81,100 @@ void SoundReader::readFrame() {
     const auto swrContext = mOpenedAudio->fSwrContext;
 
     const int firstSample = mSecondId*dstSampleRate;
+    const int lastSample = mSampleRange.fMax;
 
-    int seekTry = 0;
-    if(mOpenedAudio->fLastDstSample >= firstSample ||
-       firstSample - mOpenedAudio->fLastDstSample > dstSampleRate) {
-        seek(seekTry++, mSecondId, formatContext,
-             audioStreamIndex, audioStream, codecContext);
-    }
+    // continue the decode session if this second follows the last one
+    const auto carry = mOpenedAudio->fCarry;
+    const int lastDecoded = mOpenedAudio->fLastDstSample;
+    const int sessionFirst = carry ? carry->fSampleRange.fMin : lastDecoded + 1;
+    const bool continues = firstSample >= sessionFirst &&
+                           firstSample - lastDecoded <= dstSampleRate;
 
-    bool firstFrame = true;
-    int currentDstSample = 0;
-    uchar ** audioData = nullptr;
-    if(dstPlanar) {
-        audioData = new uchar*[static_cast<ulong>(dstChCount)];
-        for(int i = 0; i < dstChCount; i++) {
-            audioData[i] = nullptr;
-        }
+    int seekTry = 0;
+    if(continues) {
+        // invalid until the read finishes
+        mOpenedAudio->fCarry.reset();
+        mOpenedAudio->fLastDstSample = -10*dstSampleRate;
     } else {
-        audioData = new uchar*[1];
-        audioData[0] = nullptr;
+        mOpenedAudio->resetSession();
+        if(mOpenedAudio->seekIndexed(mSecondId)) seekTry++;
+        else seek(seekTry++, mSecondId, formatContext,
+                  audioStreamIndex, audioStream, codecContext);
     }
+
+    uchar ** audioData = new uchar*[static_cast<ulong>(nPlanes)];
+    for(int i = 0; i < nPlanes; i++) audioData[i] = nullptr;
     SampleRange audioDataRange{mSampleRange.fMin, mSampleRange.fMin - 1};
     int nSamples = 0;
-    while(true) {
-        mOpenedAudio->fLastDstSample = -10*dstSampleRate;
-        if(av_read_frame(formatContext, packet) < 0) {
-            break;
-        } else {
-            if(packet->stream_index == audioStreamIndex) {
-                const int sendRet = avcodec_send_packet(codecContext, packet);
-                if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
-
-                const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
-                av_packet_unref(packet);
+    const auto appendSamples = [&](uchar * const * const src,
+                                   const SampleRange& srcRange) {
+        const SampleRange neededSampleRange = mSampleRange*srcRange;
+        const int nSamplesInRange = neededSampleRange.span();
+        if(nSamplesInRange <= 0) return;
+        const int firstRelSample = neededSampleRange.fMin - srcRange.fMin;
+        const int newNSamples = nSamples + nSamplesInRange;
+        const ulong newAudioDataSize = static_cast<ulong>(newNSamples)*planeSampleSize;
+        const uint srcDispl = uint(firstRelSample)*planeSampleSize;
+        const uint dstDispl = uint(nSamples)*planeSampleSize;
+        const ulong bytes = static_cast<ulong>(nSamplesInRange)*planeSampleSize;
+        for(int i = 0; i < nPlanes; i++) {
+            void * const audioDataMem = realloc(audioData[i], newAudioDataSize);
+            audioData[i] = static_cast<uchar*>(audioDataMem);
+            memcpy(audioData[i] + dstDispl, src[i] + srcDispl, bytes);
+        }
+        if(nSamples == 0) audioDataRange = neededSampleRange;
+        else audioDataRange += neededSampleRange;
+        nSamples = newNSamples;
+    };
+    // samples past this second are kept for the next read
+    stdsptr<Samples> newCarry;
+    const auto keepCarry = [&](uchar * const * const src,
+                               const SampleRange& srcRange) {
+        const SampleRange carryRange{qMax(srcRange.fMin, lastSample + 1),
+                                     srcRange.fMax};
+        if(!carryRange.isValid()) return;
+        newCarry = enve::make_shared<Samples>(carryRange, dstSampleRate,
+                                              dstSampleFormat, dstChLayout);
+        const uint srcDispl = uint(carryRange.fMin - srcRange.fMin)*planeSampleSize;
+        const ulong bytes = static_cast<ulong>(carryRange.span())*planeSampleSize;
+        for(int i = 0; i < nPlanes; i++) {
+            memcpy(newCarry->fData[i], src[i] + srcDispl, bytes);
+        }
+    };
 
-                if(recRet == AVERROR_EOF)
-                    break;
-                else if(recRet == AVERROR(EAGAIN)) {
-                    continue;
-                } else if(recRet < 0)
-                    RuntimeThrow("Did not receive frame from the decoder");
-            } else {
+    int currentDstSample = lastDecoded + 1;
+    bool firstFrame = !continues;
+    if(continues && carry) {
+        appendSamples(carry->fData, carry->fSampleRange);
+        keepCarry(carry->fData, carry->fSampleRange);
+    }
+
+    // receives the next frame, false at the end of the stream
+    const auto decodeFrame = [&]() {
+        while(true) {
+            const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
+            if(recRet == 0) return true;
+            if(recRet == AVERROR_EOF) return false;
+            if(recRet != AVERROR(EAGAIN))
+                RuntimeThrow("Did not receive frame from the decoder");
+            if(av_read_frame(formatContext, packet) < 0) {
+                // drain the frames left in the decoder
+                avcodec_send_packet(codecContext, nullptr);
+                continue;
+            }
+            if(packet->stream_index != audioStreamIndex) {
                 av_packet_unref(packet);
                 continue;
             }
+            mOpenedAudio->indexPacket(packet);
+            const int sendRet = avcodec_send_packet(codecContext, packet);
+            av_packet_unref(packet);
+            if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
         }
+    };
+
+    while(firstFrame || currentDstSample <= lastSample) {
+        if(!decodeFrame()) break;
 
         // calculate PTS:
         if(firstFrame) {
@@ -137,71 +189,51 @@ void SoundReader::readFrame() {
                     av_frame_unref(decodedFrame);
                     seek(seekTry++, mSecondId, formatContext,
                          audioStreamIndex, audioStream, codecContext);
+                    mOpenedAudio->resetSession();
                     continue;
                 }
             }
-        }
-
-        if(currentDstSample + decodedFrame->nb_samples >= mSecondId*dstSampleRate) {
-            // resample frames
-            uchar** buffer = nullptr;
-            const int bufferSamples = qCeil(decodedFrame->nb_samples*dstSamplesPerSrc);
-            int linesize;
-            const int res = av_samples_alloc_array_and_samples(
-                        &buffer, &linesize, dstChCount,
-                        bufferSamples, dstSampleFormat, 0);
-            if(res < 0) RuntimeThrow("Resampling output buffer alloc failed");
-
-            const int nDstSamples =
-                    swr_convert(swrContext, buffer, bufferSamples,
-                                const_cast<const uint8_t**>(decodedFrame->data),
-                                decodedFrame->nb_samples);
-            if(nDstSamples < 0) RuntimeThrow("Resampling failed");
-            // append resampled frames to data
-            const SampleRange frameSampleRange{currentDstSample, currentDstSample + nDstSamples - 1};
-            const SampleRange neededSampleRange = mSampleRange*frameSampleRange;
-            const int firstRelSample = neededSampleRange.fMin - frameSampleRange.fMin;
-            const int nSamplesInRange = neededSampleRange.span();
-            if(nSamplesInRange > 0) {
-                const int newNSamples = nSamples + nSamplesInRange;
-                if(dstPlanar) {
-                    const ulong newAudioDataSize = static_cast<ulong>(newNSamples) * dstSampleSize;
-                    for(int i = 0; i < dstChCount; i++) {
-                        void * const audioDataMem = realloc(audioData[i], newAudioDataSize);
-                        audioData[i] = static_cast<uchar*>(audioDataMem);
-                        const uint srcDispl = uint(firstRelSample) * dstSampleSize;
-                        const auto src = buffer[i] + srcDispl;
-                        const uint dstDispl = uint(nSamples) * dstSampleSize;
-                        uchar * const dst = audioData[i] + dstDispl;
-                        memcpy(dst, src, static_cast<ulong>(nSamplesInRange) * dstSampleSize);
-                    }
-                } else {
-                    const ulong newAudioDataSize = static_cast<ulong>(newNSamples * dstChCount) * dstSampleSize;
-                    void * const audioDataMem = realloc(audioData[0], newAudioDataSize);
-                    audioData[0] = static_cast<uchar*>(audioDataMem);
-                    const uint srcDispl = uint(firstRelSample*dstChCount) * dstSampleSize;
-                    const auto src = buffer[0] + srcDispl;
-                    const uint dstDispl = uint(nSamples*dstChCount) * dstSampleSize;
-                    uchar * const dst = audioData[0] + dstDispl;
-                    memcpy(dst, src, static_cast<ulong>(nSamplesInRange * dstChCount) * dstSampleSize);
-                }
-                nSamples = newNSamples;
-                if(firstFrame) audioDataRange = neededSampleRange;
-                else audioDataRange += neededSampleRange;
+            if(currentDstSample + decodedFrame->nb_samples < firstSample) {
+                av_frame_unref(decodedFrame);
+                continue;
             }
-
-            if(buffer) av_freep(&buffer[0]);
-            av_freep(&buffer);
             firstFrame = false;
-
-            currentDstSample += nDstSamples;
-            mOpenedAudio->fLastDstSample = currentDstSample - 1;
         }
 
-        if(currentDstSample >= mSampleRange.fMax) break;
+        // resample frames
+        uchar** buffer = nullptr;
+        const int bufferSamples = qCeil(decodedFrame->nb_samples*dstSamplesPerSrc);
+        int linesize;
+        const int res = av_samples_alloc_array_and_samples(
+                    &buffer, &linesize, dstChCount,
+                    bufferSamples, dstSampleFormat, 0);
+        if(res < 0) RuntimeThrow("Resampling output buffer alloc failed");
+
+        const int nDstSamples =
+                swr_convert(swrContext, buffer, bufferSamples,
+                            const_cast<const uint8_t**>(decodedFrame->data),
+                            decodedFrame->nb_samples);
         av_frame_unref(decodedFrame);
+        if(nDstSamples < 0) {
+            av_freep(&buffer[0]);
+            av_freep(&buffer);
+            RuntimeThrow("Resampling failed");
+        }
+        // append resampled frames to data
+        const SampleRange frameSampleRange{currentDstSample,
+                                           currentDstSample + nDstSamples - 1};
+        appendSamples(buffer, frameSampleRange);
+        keepCarry(buffer, frameSampleRange);
+
+        if(buffer) av_freep(&buffer[0]);
+        av_freep(&buffer);
+
+        currentDstSample += nDstSamples;
+    }
+    if(!firstFrame) {
+        mOpenedAudio->fLastDstSample = currentDstSample - 1;
+        mOpenedAudio->fCarry = newCarry;
     }
-    av_frame_unref(decodedFrame);
     mSamples = enve::make_shared<Samples>(audioData, audioDataRange,
                                           dstSampleRate,
                                           dstSampleFormat, dstChLayout);
@@ -214,7 +246,8 @@ void SoundReaderForMerger::afterProcessing() {
         for(const auto& ss : mSSAbsRanges) {
             merger->addSoundToMerge({ss.fSampleShift, ss.fSamplesRange,
                                      ss.fVolume, ss.fSpeed,
-                                     enve::make_shared<Samples>(getSamples())});
+                                     enve::make_shared<Samples>(getSamples()),
+                                     ss.fPrevSamples, ss.fResampler});
         }
     }
     SoundReader::afterProcessing();
@@ -70,6 +70,8 @@ class SoundReaderForMerger : public SoundReader {
         SampleRange fSamplesRange;
         QrealSnapshot fVolume;
         qreal fSpeed;
+        stdsptr<Samples> fPrevSamples;
+        stdsptr<SoundResampler> fResampler;
     };
 protected:
     SoundReaderForMerger(SoundHandler * const cacheHandler,
@@ -82,8 +84,11 @@ public:
     void addSingleSound(const int sampleShift,
                         const SampleRange& absRange,
                         const QrealSnapshot& volume,
-                        const qreal speed) {
-        mSSAbsRanges.append({sampleShift, absRange, volume, speed});
+                        const qreal speed,
+                        const stdsptr<Samples>& prevSamples,
+                        const stdsptr<SoundResampler>& resampler) {
+        mSSAbsRanges.append({sampleShift, absRange, volume,
+                             speed, prevSamples, resampler});
     }
 
     void addMerger(SoundMerger * const merger) {
@@ -66,7 +66,7 @@ VideoFrameLoader *VideoFrameHandler::getFrameLoader(const int frame) {
 
 VideoFrameLoader *VideoFrameHandler::addFrameLoader(const int frameId) {
     const auto loader = enve::make_shared<VideoFrameLoader>(
-                    this, mVideoStreamsData, frameId);
+                    this, mVideoStreamsData, frameId, getScaledFrameSize());
     mDataHandler->addFrameLoader(frameId, loader);
     for(const auto& nFrame : mNeededFrames) {
         const auto nLoader = getFrameLoader(nFrame);
@@ -81,7 +81,8 @@ VideoFrameLoader *VideoFrameHandler::addFrameLoader(const int frameId) {
 VideoFrameLoader *VideoFrameHandler::addFrameLoader(const int frameId,
                                                     AVFrame * const frame) {
     const auto loader = enve::make_shared<VideoFrameLoader>(
-                    this, mVideoStreamsData, frameId, frame);
+                    this, mVideoStreamsData, frameId,
+                    getScaledFrameSize(), frame);
     mDataHandler->addFrameLoader(frameId, loader);
     return loader.get();
 }
@@ -102,14 +103,33 @@ eTask* VideoFrameHandler::scheduleFrameLoad(const int frame) {
         RuntimeThrow("Frame outside of range " + std::to_string(frame));
     const auto currLoader = getFrameLoader(frame);
     if(currLoader) return currLoader;
-    if(mDataHandler->getFrameAtFrame(frame)) return nullptr;
-    const auto loadTask = mDataHandler->scheduleFrameHddCacheLoad(frame);
-    if(loadTask) return loadTask;
+    const int cachedWidth = mDataHandler->getFrameWidth(frame);
+    if(cachedWidth >= getScaledFrameSize().width()) {
+        if(mDataHandler->getFrameAtFrame(frame)) return nullptr;
+        const auto loadTask = mDataHandler->scheduleFrameHddCacheLoad(frame);
+        if(loadTask) return loadTask;
+    } else if(cachedWidth > 0) {
+        // cached at a lower resolution than needed now
+        mDataHandler->removeFrame(frame);
+    }
     const auto loader = addFrameLoader(frame);
     loader->queTask();
     return loader;
 }
 
+qreal VideoFrameHandler::getImageScale(const SkImage& image) const {
+    const auto codecContext = mVideoStreamsData->fCodecContext;
+    if(!codecContext || codecContext->width <= 0) return 1;
+    return static_cast<qreal>(image.width())/codecContext->width;
+}
+
+QSize VideoFrameHandler::getScaledFrameSize() const {
+    const auto codecContext = mVideoStreamsData->fCodecContext;
+    if(!codecContext) return QSize();
+    return QSize(qMax(1, qCeil(codecContext->width*mResolution)),
+                 qMax(1, qCeil(codecContext->height*mResolution)));
+}
+
 int VideoFrameHandler::getFrameCount() const {
     return mDataHandler->getFrameCount();
 }
@@ -195,6 +215,16 @@ eTask *VideoDataHandler::scheduleFrameHddCacheLoad(const int frame) {
     return nullptr;
 }
 
+int VideoDataHandler::getFrameWidth(const int frame) const {
+    const auto cont = mFramesCache.atFrame<ImageCacheContainer>(frame);
+    if(!cont) return 0;
+    return cont->getImageWidth();
+}
+
+void VideoDataHandler::removeFrame(const int frame) {
+    mFramesCache.remove(FrameRange{frame, frame});
+}
+
 sk_sp<SkImage> VideoDataHandler::getFrameAtFrame(const int relFrame) const {
     const auto cont = mFramesCache.atFrame<ImageCacheContainer>(relFrame);
     if(!cont) return sk_sp<SkImage>();
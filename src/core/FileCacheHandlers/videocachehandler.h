@@ -38,6 +38,9 @@ public:
     void removeFrameLoader(const int frame);
     void frameLoaderFinished(const int frame, const sk_sp<SkImage>& image);
     eTask* scheduleFrameHddCacheLoad(const int frame);
+    //! @brief Width of the cached frame image, 0 if not cached
+    int getFrameWidth(const int frame) const;
+    void removeFrame(const int frame);
     sk_sp<SkImage> getFrameAtFrame(const int relFrame) const;
     sk_sp<SkImage> getFrameAtOrBeforeFrame(const int relFrame) const;
     int getFrameCount() const;
@@ -63,6 +66,7 @@ public:
     eTask *scheduleFrameLoad(const int frame);
     int getFrameCount() const;
     void reload();
+    qreal getImageScale(const SkImage& image) const;
 
     void afterSourceChanged();
 
@@ -80,6 +84,9 @@ protected:
 
     void openVideoStream();
 private:
+    //! @brief Source frame size scaled to the requested resolution
+    QSize getScaledFrameSize() const;
+
     std::set<int> mNeededFrames;
 
     VideoDataHandler* const mDataHandler;
@@ -0,0 +1,229 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "videoframeconverter.h"
+#include "skia/skiahelpers.h"
+#include "skia/pixelbufferpool.h"
+#include "exceptions.h"
+#include "Private/Tasks/taskscheduler.h"
+extern "C" {
+    #include <libavutil/pixdesc.h>
+    #include <libavutil/opt.h>
+}
+
+bool VideoFrameConverter::Key::operator==(const Key& other) const {
+    return fSrcWidth == other.fSrcWidth &&
+           fSrcHeight == other.fSrcHeight &&
+           fSrcFormat == other.fSrcFormat &&
+           fDstWidth == other.fDstWidth &&
+           fDstHeight == other.fDstHeight &&
+           fThreads == other.fThreads;
+}
+
+VideoFrameConverter::VideoFrameConverter() {}
+
+VideoFrameConverter::~VideoFrameConverter() {
+    for(const auto& context : mContexts)
+        sws_freeContext(context.second);
+}
+
+VideoFrameConverter& VideoFrameConverter::sInstance() {
+    static VideoFrameConverter instance;
+    return instance;
+}
+
+int VideoFrameConverter::sThreadCount(const int dstWidth,
+                                      const int dstHeight) {
+    // bands below ~256k pixels are not worth the thread hop
+    const int maxBands = qMax(1, dstWidth*dstHeight/(512*512));
+    const auto scheduler = TaskScheduler::sGetInstance();
+    // do not compete with the cpu pool for the cores
+    const int idle = scheduler ? scheduler->idleCpuThreads() : 0;
+    return qBound(1, maxBands, 1 + idle);
+}
+
+bool VideoFrameConverter::sConvertBand(const Band& band) {
+    auto& instance = sInstance();
+    const auto context = instance.take(band.fKey);
+    if(!context) return false;
+    const int dstLinesize[] = { band.fDstLinesize };
+    const bool direct = band.fDstSkip == 0 &&
+                        band.fDstRows == band.fKey.fDstHeight;
+    if(direct) {
+        uint8_t * const dst[] = { band.fDst };
+        sws_scale(context, band.fSrc, band.fSrcLinesize,
+                  0, band.fKey.fSrcHeight, dst, dstLinesize);
+    } else {
+        // the margin rows would overlap the neighbouring bands
+        const auto size = static_cast<size_t>(band.fKey.fDstHeight)*
+                          static_cast<size_t>(band.fDstLinesize);
+        const auto scratch = static_cast<uint8_t*>(av_malloc(size));
+        if(!scratch) {
+            instance.give(band.fKey, context);
+            return false;
+        }
+        uint8_t * const dst[] = { scratch };
+        sws_scale(context, band.fSrc, band.fSrcLinesize,
+                  0, band.fKey.fSrcHeight, dst, dstLinesize);
+        memcpy(band.fDst, scratch + band.fDstSkip*band.fDstLinesize,
+               static_cast<size_t>(band.fDstRows*band.fDstLinesize));
+        av_free(scratch);
+    }
+    instance.give(band.fKey, context);
+    return true;
+}
+
+void VideoFrameConverter::BandJob::run() {
+    const int count = fBands.count();
+    int i;
+    while((i = fNext++) < count) {
+        if(!sConvertBand(fBands.at(i))) fFailed = true;
+        fFinished.release();
+    }
+}
+
+static int gcd(const int a, const int b) {
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+sk_sp<SkImage> VideoFrameConverter::sConvert(const AVFrame * const frame,
+                                             const QSize& dstSize) {
+    const int srcWidth = frame->width;
+    const int srcHeight = frame->height;
+    const int dstWidth = qBound(1, dstSize.width(), srcWidth);
+    const int dstHeight = qBound(1, dstSize.height(), srcHeight);
+
+    const auto info = SkiaHelpers::getPremulRGBAInfo(dstWidth, dstHeight);
+    SkBitmap bitmap;
+    if(!PixelBufferPool::sAllocPixels(bitmap, info))
+        RuntimeThrow("Failed to allocate pixels for video frame");
+    uint8_t * const dstData = static_cast<uint8_t*>(bitmap.getPixels());
+    const int dstLinesize = static_cast<int>(bitmap.rowBytes());
+
+    const auto format = static_cast<AVPixelFormat>(frame->format);
+    const auto desc = av_pix_fmt_desc_get(format);
+    if(!desc) RuntimeThrow("Unknown video frame pixel format");
+    const int nThreads = sThreadCount(dstWidth, dstHeight);
+
+    // bands are cut on steps mapping a whole number of source rows
+    // to a whole number of destination rows, so that every band scales
+    // with the ratio of the frame, source steps start on a chroma row
+    const int rowAlign = 1 << desc->log2_chroma_h;
+    const int div = gcd(srcHeight, dstHeight);
+    int srcStep = srcHeight/div;
+    int dstStep = dstHeight/div;
+    const int alignMult = rowAlign/gcd(srcStep, rowAlign);
+    srcStep *= alignMult;
+    dstStep *= alignMult;
+    // source rows reached by the vertical filter taps past a band edge,
+    // the rows produced from the margin are dropped
+    const int reach = 2*qMax(1, (srcHeight + dstHeight - 1)/dstHeight) +
+                      2*rowAlign;
+    const int marginSteps = (reach + srcStep - 1)/srcStep;
+    const int nSteps = dstHeight/dstStep;
+    // palette data can not be offset
+    const bool paletted = desc->flags & AV_PIX_FMT_FLAG_PAL;
+    const int maxBands = paletted ? 1 : nSteps/qMax(1, 2*marginSteps);
+    const int nBands = qBound(1, maxBands, nThreads);
+    // swscale slices the single context internally if supported
+    const int swsThreads = nBands == 1 ? nThreads : 1;
+
+    const auto job = std::make_shared<BandJob>();
+    for(int i = 0; i < nBands; i++) {
+        const bool first = i == 0;
+        const bool last = i == nBands - 1;
+        const int s0 = nSteps*i/nBands;
+        const int s1 = nSteps*(i + 1)/nBands;
+        const int dstY0 = s0*dstStep;
+        const int dstY1 = last ? dstHeight : s1*dstStep;
+        const int topSteps = first ? 0 : qMin(s0, marginSteps);
+        const int ctxSrcY0 = (s0 - topSteps)*srcStep;
+        const int ctxDstY0 = dstY0 - topSteps*dstStep;
+        int ctxSrcY1 = srcHeight;
+        int ctxDstY1 = dstHeight;
+        if(!last && s1 + marginSteps < nSteps) {
+            ctxSrcY1 = (s1 + marginSteps)*srcStep;
+            ctxDstY1 = (s1 + marginSteps)*dstStep;
+        }
+        Band band;
+        for(int p = 0; p < 4; p++) {
+            const int linesize = frame->linesize[p];
+            band.fSrcLinesize[p] = linesize;
+            if(!frame->data[p]) {
+                band.fSrc[p] = nullptr;
+                continue;
+            }
+            const bool chroma = p == 1 || p == 2;
+            const int row = chroma ? ctxSrcY0 >> desc->log2_chroma_h :
+                                     ctxSrcY0;
+            band.fSrc[p] = frame->data[p] + row*linesize;
+        }
+        band.fDst = dstData + dstY0*dstLinesize;
+        band.fDstLinesize = dstLinesize;
+        band.fDstSkip = dstY0 - ctxDstY0;
+        band.fDstRows = dstY1 - dstY0;
+        band.fKey = {srcWidth, ctxSrcY1 - ctxSrcY0, frame->format,
+                     dstWidth, ctxDstY1 - ctxDstY0, swsThreads};
+        job->fBands << band;
+    }
+
+    // idle workers help, this thread converts whatever is left,
+    // so the frame never waits for a busy pool
+    const auto scheduler = TaskScheduler::sGetInstance();
+    for(int i = 1; scheduler && i < nBands; i++) {
+        if(!scheduler->runOnIdleCpuThread([job]() { job->run(); })) break;
+    }
+    job->run();
+    job->fFinished.acquire(nBands);
+    if(job->fFailed) RuntimeThrow("Failed to convert video frame");
+
+    return SkiaHelpers::transferDataToSkImage(bitmap);
+}
+
+SwsContext* VideoFrameConverter::take(const Key& key) {
+    {
+        QMutexLocker lock(&mMutex);
+        for(int i = 0; i < mContexts.count(); i++) {
+            if(mContexts.at(i).first == key)
+                return mContexts.takeAt(i).second;
+        }
+    }
+    const auto format = static_cast<AVPixelFormat>(key.fSrcFormat);
+    const auto context = sws_alloc_context();
+    if(!context) return nullptr;
+    av_opt_set_int(context, "srcw", key.fSrcWidth, 0);
+    av_opt_set_int(context, "srch", key.fSrcHeight, 0);
+    av_opt_set_int(context, "src_format", format, 0);
+    av_opt_set_int(context, "dstw", key.fDstWidth, 0);
+    av_opt_set_int(context, "dsth", key.fDstHeight, 0);
+    av_opt_set_int(context, "dst_format", AV_PIX_FMT_RGBA, 0);
+    av_opt_set_int(context, "sws_flags", SWS_BICUBIC, 0);
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+    av_opt_set_int(context, "threads", key.fThreads, 0);
+#endif
+    if(sws_init_context(context, nullptr, nullptr) < 0) {
+        sws_freeContext(context);
+        return nullptr;
+    }
+    return context;
+}
+
+void VideoFrameConverter::give(const Key& key, SwsContext* const context) {
+    QMutexLocker lock(&mMutex);
+    mContexts.prepend({key, context});
+    while(mContexts.count() > sMaxContexts)
+        sws_freeContext(mContexts.takeLast().second);
+}
@@ -0,0 +1,90 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VIDEOFRAMECONVERTER_H
+#define VIDEOFRAMECONVERTER_H
+#include "skia/skiaincludes.h"
+#include <QSize>
+#include <QMutex>
+#include <QList>
+#include <QSemaphore>
+#include <atomic>
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libswscale/swscale.h>
+}
+
+//! @brief Converts decoded video frames to premultiplied RGBA images.
+//! Frames are scaled straight to the requested size, in horizontal bands
+//! run on the idle cpu pool workers. Each band scales the matching source
+//! rows, along with a margin for the filter taps, with its own SwsContext.
+//! SwsContexts are kept for reuse, pixels come from PixelBufferPool.
+class VideoFrameConverter {
+public:
+    static sk_sp<SkImage> sConvert(const AVFrame * const frame,
+                                   const QSize& dstSize);
+private:
+    struct Key {
+        int fSrcWidth;
+        int fSrcHeight;
+        int fSrcFormat;
+        int fDstWidth;
+        int fDstHeight;
+        int fThreads;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct Band {
+        const uint8_t* fSrc[4];
+        int fSrcLinesize[4];
+        uint8_t* fDst;
+        int fDstLinesize;
+        //! @brief Rows the context outputs above fDst, dropped
+        int fDstSkip;
+        int fDstRows;
+        Key fKey;
+    };
+
+    //! @brief Bands shared by the converting thread and the helpers,
+    //! a helper starting after all bands were taken does nothing.
+    struct BandJob {
+        QList<Band> fBands;
+        std::atomic<int> fNext{0};
+        std::atomic<bool> fFailed{false};
+        QSemaphore fFinished;
+
+        void run();
+    };
+
+    VideoFrameConverter();
+    ~VideoFrameConverter();
+
+    static VideoFrameConverter& sInstance();
+    //! @brief Number of threads worth using for a frame of the given size,
+    //! limited by the number of idle cpu pool workers
+    static int sThreadCount(const int dstWidth, const int dstHeight);
+    static bool sConvertBand(const Band& band);
+
+    SwsContext* take(const Key& key);
+    void give(const Key& key, SwsContext* const context);
+
+    QMutex mMutex;
+    QList<std::pair<Key, SwsContext*>> mContexts;
+    static const int sMaxContexts = 32;
+};
+
+#endif // VIDEOFRAMECONVERTER_H
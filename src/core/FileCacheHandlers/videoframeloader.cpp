@@ -16,36 +16,19 @@
 
 #include "videoframeloader.h"
 #include "videocachehandler.h"
+#include "videoframeconverter.h"
 #include "Private/Tasks/taskscheduler.h"
 
 VideoFrameLoader::VideoFrameLoader(VideoFrameHandler * const cacheHandler,
                                    const stdsptr<VideoStreamsData> &openedVideo,
-                                   const int frameId, AVFrame * const frame) :
-    VideoFrameLoader(cacheHandler, openedVideo, frameId) {
-    setFrameToConvert(frame, openedVideo->fCodecContext);
+                                   const int frameId, const QSize& dstSize,
+                                   AVFrame * const frame) :
+    VideoFrameLoader(cacheHandler, openedVideo, frameId, dstSize) {
+    setFrameToConvert(frame);
 }
 
 void VideoFrameLoader::convertFrame() {
-    const auto info = SkiaHelpers::getPremulRGBAInfo(
-                mFrameToConvert->width, mFrameToConvert->height);
-    SkBitmap bitmap;
-    bitmap.allocPixels(info);
-
-    SkPixmap pixmap;
-    bitmap.peekPixels(&pixmap);
-
-    void * const addr = pixmap.writable_addr();
-    uint8_t * const dstSk[] = { static_cast<uint8_t*>(addr) };
-    int linesizesSk[4];
-
-    av_image_fill_linesizes(linesizesSk, AV_PIX_FMT_RGBA,
-                            mFrameToConvert->width);
-
-    sws_scale(mSwsContext, mFrameToConvert->data, mFrameToConvert->linesize,
-              0, mFrameToConvert->height, dstSk, linesizesSk);
-
-    mLoadedFrame = SkiaHelpers::transferDataToSkImage(bitmap);
-
+    mLoadedFrame = VideoFrameConverter::sConvert(mFrameToConvert, mDstSize);
     cleanUp();
 }
 
@@ -84,80 +67,82 @@ void seek(const int tryN, const int frameId, const qreal fps,
     avcodec_flush_buffers(codecContext);
 }
 
+//! @brief Decodes the next video frame into frame,
+//! returns false if the decoder has reached the end of the stream
+bool decodeNextFrame(VideoStreamsData& video, AVFrame * const frame) {
+    const auto packet = video.fPacket;
+    const auto codecContext = video.fCodecContext;
+    while(true) {
+        const int readRet = av_read_frame(video.fFormatContext, packet);
+        if(readRet < 0) RuntimeThrow("Error retrieving AVPacket");
+        if(packet->stream_index != video.fVideoStreamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        const int sendRet = avcodec_send_packet(codecContext, packet);
+        av_packet_unref(packet);
+        if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
+
+        const int recRet = avcodec_receive_frame(codecContext, frame);
+        if(recRet == AVERROR_EOF) return false;
+        else if(recRet == AVERROR(EAGAIN)) continue;
+        else if(recRet < 0)
+            RuntimeThrow("Did not receive frame from the decoder");
+        return true;
+    }
+}
+
 void VideoFrameLoader::readFrame() {
     if(!mOpenedVideo->fOpened)
         RuntimeThrow("Cannot read frame from closed VideoStream");
-    const auto formatContext = mOpenedVideo->fFormatContext;
-    const auto videoStreamIndex = mOpenedVideo->fVideoStreamIndex;
-    const auto videoStream = mOpenedVideo->fVideoStream;
-    const auto packet = mOpenedVideo->fPacket;
-    const auto codecContext = mOpenedVideo->fCodecContext;
-    auto decodedFrame = mOpenedVideo->fDecodedFrame;
-    //const auto swsContext = mOpenedVideo->fSwsContext;
-    const qreal fps = mOpenedVideo->fFps;
+    auto& video = *mOpenedVideo;
+    video.frameRequested(mFrameId);
+
+    if(const auto kept = video.takeKeptFrame(mFrameId)) {
+        setFrameToConvert(kept);
+    } else decodeRequestedFrame();
+}
+
+void VideoFrameLoader::decodeRequestedFrame() {
+    auto& video = *mOpenedVideo;
+    const auto formatContext = video.fFormatContext;
+    const auto videoStreamIndex = video.fVideoStreamIndex;
+    const auto videoStream = video.fVideoStream;
+    const auto codecContext = video.fCodecContext;
+    const qreal fps = video.fFps;
 
     int seekTry = 0;
-    if(mOpenedVideo->fLastFrame >= mFrameId ||
-       mFrameId - mOpenedVideo->fLastFrame > fps) {
+    if(video.fLastFrame >= mFrameId || mFrameId - video.fLastFrame > fps) {
+        video.clearKeptFrames();
         seek(seekTry++, mFrameId, fps, formatContext,
              videoStreamIndex, videoStream, codecContext);
     }
 
     while(true) {
-        const int lastFrameTmp = mOpenedVideo->fLastFrame;
-        mOpenedVideo->fLastFrame = -qFloor(10*fps); // Just in case error occurs
-        const int readRet = av_read_frame(formatContext, packet);
-        if(readRet < 0) RuntimeThrow("Error retrieving AVPacket");
-        if(packet->stream_index == videoStreamIndex) {
-            const int sendRet = avcodec_send_packet(codecContext, packet);
-            if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
+        const int lastFrameTmp = video.fLastFrame;
+        video.fLastFrame = -qFloor(10*fps); // Just in case error occurs
+        const auto decodedFrame = video.fDecodedFrame;
+        if(!decodeNextFrame(video, decodedFrame)) break;
 
-            const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
-            av_packet_unref(packet);
-
-            if(recRet == AVERROR_EOF)
+        const int currFrame = frameId(decodedFrame, videoStream, fps);
+        video.fLastFrame = currFrame;
+        if(mFrameId > lastFrameTmp && currFrame > mFrameId) {
+            const auto previous = video.takeKeptFrameBefore(mFrameId);
+            if(previous) {
+                setFrameToConvert(previous);
+                video.keepDecodedFrame(currFrame);
                 break;
-            else if(recRet == AVERROR(EAGAIN))
-                continue;
-            else if(recRet < 0)
-                RuntimeThrow("Did not receive frame from the decoder");
-        } else {
-            av_packet_unref(packet);
-            continue;
+            }
         }
-
-        const int currFrame = frameId(decodedFrame, videoStream, fps);
-        const bool usePrevious = mFrameId > lastFrameTmp &&
-                                 currFrame > mFrameId &&
-                                 !mExcessFrames.isEmpty();
-        mOpenedVideo->fLastFrame = currFrame;
         const bool reseek = currFrame > mFrameId && seekTry <= 3;
-        if(usePrevious) {
-            int minPositiveDist = INT_MAX;
-            int excessId = -1;
-            for(int i = 0; i < mExcessFrames.count(); i++) {
-                const auto& excess = mExcessFrames.at(i);
-                const int dist = mFrameId - excess.first;
-                if(dist < 0 || dist > minPositiveDist) continue;
-                minPositiveDist = dist;
-                excessId = i;
-            }
-            const auto frame = excessId == -1 ?
-                        decodedFrame : mExcessFrames.takeAt(excessId).second;
-            setFrameToConvert(frame, codecContext);
-            if(frame != decodedFrame) av_frame_unref(decodedFrame);
-            break;
-        } else if(currFrame == mFrameId || (!reseek && currFrame > mFrameId)) {
+        if(currFrame == mFrameId || (!reseek && currFrame > mFrameId)) {
             if(currFrame > mFrameId)
                 qDebug() << "frame " + QString::number(currFrame) +
-                            " instead of " + QString::number(mFrameId);            
-            setFrameToConvert(decodedFrame, codecContext);
-            mOpenedVideo->fDecodedFrame = av_frame_alloc();
+                            " instead of " + QString::number(mFrameId);
+            setFrameToConvert(video.takeDecodedFrame());
             break;
-        } else if(qAbs(mFrameId - currFrame) < 20) {
-            mExcessFrames.append({currFrame, decodedFrame});
-            mOpenedVideo->fDecodedFrame = av_frame_alloc();
-            decodedFrame = mOpenedVideo->fDecodedFrame;
+        } else if(qAbs(mFrameId - currFrame) < VideoStreamsData::sMaxDecodedFrames) {
+            video.keepDecodedFrame(currFrame);
         } else av_frame_unref(decodedFrame);
 
         if(reseek) seek(seekTry++, mFrameId, fps, formatContext,
@@ -165,24 +150,37 @@ void VideoFrameLoader::readFrame() {
     }
 }
 
+void VideoDecodeAhead::process() {
+    auto& video = *mOpenedVideo;
+    if(!video.fOpened) return;
+    const int lastAhead = mFrameId + video.decodeAhead();
+    try {
+        while(video.fLastFrame >= mFrameId && video.fLastFrame < lastAhead &&
+              !video.keptFramesFull()) {
+            const auto decodedFrame = video.fDecodedFrame;
+            if(!decodeNextFrame(video, decodedFrame)) break;
+            const int currFrame = frameId(decodedFrame, video.fVideoStream,
+                                          video.fFps);
+            video.fLastFrame = currFrame;
+            if(currFrame > mFrameId) video.keepDecodedFrame(currFrame);
+            else av_frame_unref(decodedFrame);
+        }
+    } catch(...) {
+        // the requested frame is already decoded,
+        // the next request will seek to recover
+        video.fLastFrame = -qFloor(10*video.fFps);
+        video.stopDecodingAhead();
+    }
+}
+
 void VideoFrameLoader::afterProcessing() {
     if(!mCacheHandler) return;
     mCacheHandler->frameLoaderFinished(mFrameId, mLoadedFrame);
-    for(auto& excess : mExcessFrames) {
-        if(mCacheHandler->getFrameAtFrame(excess.first)) {
-            av_frame_unref(excess.second);
-            av_frame_free(&excess.second);
-            continue;
-        }
-        const auto currFL = mCacheHandler->getFrameLoader(excess.first);
-        if(currFL) {
-            currFL->setFrameToConvert(excess.second, mOpenedVideo->fCodecContext);
-        } else {
-            const auto newFL = mCacheHandler->addFrameLoader(excess.first, excess.second);
-            newFL->queTask();
-        }
+    if(mOpenedVideo->decodeAhead() > 0 && mOpenedVideo->fOpened) {
+        const auto ahead = enve::make_shared<VideoDecodeAhead>(mOpenedVideo,
+                                                               mFrameId);
+        ahead->queTask();
     }
-    mExcessFrames.clear();
 }
 
 void VideoFrameLoader::afterCanceled() {
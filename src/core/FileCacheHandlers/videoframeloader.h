@@ -34,12 +34,13 @@ class VideoFrameLoader : public eHddTask {
 protected:
     VideoFrameLoader(VideoFrameHandler * const cacheHandler,
                      const stdsptr<VideoStreamsData>& openedVideo,
-                     const int frameId) :
+                     const int frameId, const QSize& dstSize) :
         mCacheHandler(cacheHandler), mOpenedVideo(openedVideo),
-        mFrameId(frameId) {}
+        mFrameId(frameId), mDstSize(dstSize) {}
     VideoFrameLoader(VideoFrameHandler * const cacheHandler,
                      const stdsptr<VideoStreamsData>& openedVideo,
-                     const int frameId, AVFrame* const frame);
+                     const int frameId, const QSize& dstSize,
+                     AVFrame* const frame);
 
     void afterProcessing();
     void afterCanceled();
@@ -47,26 +48,12 @@ protected:
 
     void queTaskNow();
 
-    void setFrameToConvert(AVFrame * const frame,
-                           AVCodecContext * const codecContext) {
+    void setFrameToConvert(AVFrame * const frame) {
         cleanUp();
         mFrameToConvert = frame;
-        mSwsContext = sws_getContext(codecContext->width,
-                                     codecContext->height,
-                                     codecContext->pix_fmt,
-                                     codecContext->width,
-                                     codecContext->height,
-                                     AV_PIX_FMT_RGBA, SWS_BICUBIC,
-                                     nullptr, nullptr, nullptr);
     }
 public:
-    ~VideoFrameLoader() {
-        for(auto& excess : mExcessFrames) {
-            av_frame_unref(excess.second);
-            av_frame_free(&excess.second);
-        }
-        cleanUp();
-    }
+    ~VideoFrameLoader() { cleanUp(); }
     void process();
 private:
     void cleanUp() {
@@ -75,24 +62,37 @@ private:
             av_frame_free(&mFrameToConvert);
             mFrameToConvert = nullptr;
         }
-        if(mSwsContext) {
-            sws_freeContext(mSwsContext);
-            mSwsContext = nullptr;
-        }
     }
-    void setupSwsContext(AVCodecContext * const codecContext);
     void readFrame();
+    void decodeRequestedFrame();
     void convertFrame();
 
     const qptr<VideoFrameHandler> mCacheHandler;
     const stdsptr<VideoStreamsData> mOpenedVideo;
     const int mFrameId;
+    //! @brief Size the frame is converted to,
+    //! smaller than the source for downscaled previews
+    const QSize mDstSize;
     sk_sp<SkImage> mLoadedFrame;
 
-    QList<std::pair<int, AVFrame*>> mExcessFrames;
-
     AVFrame * mFrameToConvert = nullptr;
-    struct SwsContext * mSwsContext = nullptr;
+};
+
+//! @brief Streaming session, keeps decoding forward past the requested
+//! frame so that subsequent sequential requests do not hit the decoder.
+//! Queued once the requested frame has been handed off, runs on the hdd
+//! executor after the loaders queued before it.
+class VideoDecodeAhead : public eHddTask {
+    e_OBJECT
+protected:
+    VideoDecodeAhead(const stdsptr<VideoStreamsData>& openedVideo,
+                     const int frameId) :
+        mOpenedVideo(openedVideo), mFrameId(frameId) {}
+public:
+    void process();
+private:
+    const stdsptr<VideoStreamsData> mOpenedVideo;
+    const int mFrameId;
 };
 
 #endif // VIDEOFRAMELOADER_H
@@ -34,9 +34,87 @@ void VideoStreamsData::open(const QString &path) {
     }
 }
 
+//! @brief Memory held by the frame buffers
+static qint64 frameBytes(const AVFrame * const frame) {
+    qint64 bytes = 0;
+    for(const auto buf : frame->buf) {
+        if(buf) bytes += static_cast<qint64>(buf->size);
+    }
+    return bytes;
+}
+
+void VideoStreamsData::keepDecodedFrame(const int frameId) {
+    const qint64 bytes = frameBytes(fDecodedFrame);
+    while(!mKeptFrames.isEmpty() &&
+          (mKeptFrames.count() >= sMaxDecodedFrames ||
+           mKeptBytes + bytes > sMaxDecodedBytes)) {
+        int earliestId = 0;
+        for(int i = 1; i < mKeptFrames.count(); i++) {
+            if(mKeptFrames.at(i).first < mKeptFrames.at(earliestId).first)
+                earliestId = i;
+        }
+        auto earliest = takeKeptFrameAt(earliestId);
+        av_frame_free(&earliest);
+    }
+    mKeptFrames.append({frameId, takeDecodedFrame()});
+    mKeptBytes += bytes;
+}
+
+AVFrame *VideoStreamsData::takeDecodedFrame() {
+    const auto result = fDecodedFrame;
+    fDecodedFrame = av_frame_alloc();
+    if(!fDecodedFrame) RuntimeThrow("Error allocating AVFrame");
+    return result;
+}
+
+AVFrame *VideoStreamsData::takeKeptFrame(const int frameId) {
+    for(int i = 0; i < mKeptFrames.count(); i++) {
+        if(mKeptFrames.at(i).first == frameId)
+            return takeKeptFrameAt(i);
+    }
+    return nullptr;
+}
+
+AVFrame *VideoStreamsData::takeKeptFrameBefore(const int frameId) {
+    int closestId = -1;
+    for(int i = 0; i < mKeptFrames.count(); i++) {
+        const int iFrame = mKeptFrames.at(i).first;
+        if(iFrame > frameId) continue;
+        if(closestId == -1 || iFrame > mKeptFrames.at(closestId).first)
+            closestId = i;
+    }
+    if(closestId == -1) return nullptr;
+    return takeKeptFrameAt(closestId);
+}
+
+void VideoStreamsData::frameRequested(const int frameId) {
+    const bool sequential = frameId > mLastRequested &&
+                            frameId - mLastRequested <= 2;
+    mLastRequested = frameId;
+    if(sequential) {
+        mDecodeAhead = qBound(2, 2*mDecodeAhead, sMaxDecodeAhead);
+    } else mDecodeAhead = 0;
+}
+
+void VideoStreamsData::clearKeptFrames() {
+    for(auto& kept : mKeptFrames) av_frame_free(&kept.second);
+    mKeptFrames.clear();
+    mKeptBytes = 0;
+}
+
+AVFrame *VideoStreamsData::takeKeptFrameAt(const int id) {
+    const auto frame = mKeptFrames.takeAt(id).second;
+    mKeptBytes -= frameBytes(frame);
+    return frame;
+}
+
 void VideoStreamsData::close() {
     fOpened = false;
 
+    clearKeptFrames();
+    mLastRequested = -1;
+    mDecodeAhead = 0;
+
     if(fDecodedFrame) av_frame_free(&fDecodedFrame);
     if(fPacket) av_packet_free(&fPacket);
     if(fSwsContext) sws_freeContext(fSwsContext);
@@ -45,13 +45,52 @@ public:
     struct SwsContext * fSwsContext = nullptr;
     int fLastFrame = 0;
 
+    //! @brief Upper bound for decodeAhead()
+    static const int sMaxDecodeAhead = 8;
+    //! @brief Maximum number of frames kept in the decoded frame ring
+    static const int sMaxDecodedFrames = 16;
+    //! @brief Maximum memory held by the decoded frame ring,
+    //! it is not part of the caches managed by MemoryHandler
+    static const qint64 sMaxDecodedBytes = qint64(96)*1024*1024;
+
     stdsptr<const AudioStreamsData> fAudioData;
 
     static stdsptr<VideoStreamsData> sOpen(const QString& path);
+
+    //! @brief Moves fDecodedFrame to the decoded frame ring,
+    //! evicts the earliest frame if the ring is full.
+    //! Only to be used from the thread reading the stream.
+    void keepDecodedFrame(const int frameId);
+    //! @brief Returns fDecodedFrame and allocates a new one in its place
+    AVFrame* takeDecodedFrame();
+    //! @brief Takes the frame from the decoded frame ring,
+    //! returns nullptr if not present
+    AVFrame* takeKeptFrame(const int frameId);
+    //! @brief Takes the closest kept frame preceding frameId
+    AVFrame* takeKeptFrameBefore(const int frameId);
+    void clearKeptFrames();
+    //! @brief True if the decoded frame ring holds sMaxDecodedBytes
+    bool keptFramesFull() const { return mKeptBytes >= sMaxDecodedBytes; }
+
+    //! @brief Registers a request, the number of frames decoded ahead
+    //! grows with consecutive sequential requests.
+    void frameRequested(const int frameId);
+    //! @brief Number of frames to decode past the requested one
+    int decodeAhead() const { return mDecodeAhead; }
+    void stopDecodingAhead() { mDecodeAhead = 0; }
 private:
     void open(const QString& path);
     void open();
     void open(const char * const path);
     void close();
+
+    AVFrame* takeKeptFrameAt(const int id);
+
+    //! @brief Last frame requested from the decoder session
+    int mLastRequested = -1;
+    int mDecodeAhead = 0;
+
+    QList<std::pair<int, AVFrame*>> mKeptFrames;
+    qint64 mKeptBytes = 0;
 };
 #endif // VIDEOSTREAMSDATA_H
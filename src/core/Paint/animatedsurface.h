@@ -226,7 +226,7 @@ public:
         if(surf) {
             if(!surf->storesDataInMemory())
                 return surf->scheduleLoadFromTmpFile();
-            auto bitmap = surf->surface().toBitmap();
+            auto bitmap = surf->surfaceBitmap();
             img = SkiaHelpers::transferDataToSkImage(bitmap);
             const auto imgCpy = SkiaHelpers::makeCopy(img);
             const auto range = prp_getIdenticalRelRange(relFrame);
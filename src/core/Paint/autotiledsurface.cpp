@@ -28,6 +28,8 @@ AutoTiledSurface::AutoTiledSurface() :
                                sRequestStart,
                                sRequestEnd);
     fParent.parent.destroy = sFree;
+    mDrawDab = fParent.parent.draw_dab;
+    fParent.parent.draw_dab = sDrawDab;
 #ifdef _OPENMP
     fParent.threadsafe_tile_requests = true;
 #else
@@ -72,6 +74,30 @@ void AutoTiledSurface::sFree(MyPaintSurface *surface) {
     self->free();
 }
 
+int AutoTiledSurface::sDrawDab(MyPaintSurface *surface, float x, float y,
+                               float radius,
+                               float color_r, float color_g, float color_b,
+                               float opaque, float hardness,
+                               float color_a,
+                               float aspect_ratio, float angle,
+                               float lock_alpha,
+                               float colorize) {
+    const auto self = reinterpret_cast<AutoTiledSurface*>(surface);
+    // same tile rows as the ones mypaint queues the dab for
+    const float rFringe = radius + 1;
+    const int minRow = static_cast<int>(floor(floor(double(y - rFringe))/TILE_SIZE));
+    const int maxRow = static_cast<int>(floor(floor(double(y + rFringe))/TILE_SIZE));
+    if(maxRow < self->mDabMinRow || minRow > self->mDabMaxRow) {
+        // report what mypaint would, it drives the stroke timing
+        if(radius < 0.1f) return false;
+        if(qBound(0.f, hardness, 1.f) == 0.f) return false;
+        return qBound(0.f, opaque, 1.f) != 0.f;
+    }
+    return self->mDrawDab(surface, x, y, radius, color_r, color_g, color_b,
+                          opaque, hardness, color_a, aspect_ratio, angle,
+                          lock_alpha, colorize);
+}
+
 void AutoTiledSurface::sRequestStart(MyPaintTiledSurface *tiled_surface,
                                      MyPaintTileRequest *request) {
     const auto self = reinterpret_cast<AutoTiledSurface*>(tiled_surface);
@@ -96,7 +122,14 @@ void AutoTiledSurface::startRequest(MyPaintTileRequest * const request) {
     #pragma omp critical
     {
         mAutoTilesData.stretchToTile(request->tx, request->ty);
-        request->buffer = mAutoTilesData.getTile(request->tx, request->ty);
+        if(request->readonly) {
+            const auto tile = mAutoTilesData.getTile(request->tx, request->ty);
+            request->buffer = const_cast<uint16_t*>(tile);
+        } else {
+            // shared tiles are cloned before being painted on
+            request->buffer = mAutoTilesData.getTileForWrite(request->tx,
+                                                             request->ty);
+        }
     }
 }
 
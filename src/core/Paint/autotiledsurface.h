@@ -22,6 +22,8 @@
 #include <mypaint-tiled-surface.h>
 #include <mypaint-brush.h>
 #include <QPointF>
+#include <QMutex>
+#include <climits>
 #include "smartPointers/stdselfref.h"
 #include "pointhelpers.h"
 #include "pathoperations.h"
@@ -47,6 +49,22 @@ struct AutoTiledSurface {
 
     void setPixelClamp(const QRect& pixRect);
     void loadBitmap(const SkBitmap &src);
+    void loadBitmap(const SkBitmap &src, const int minRow, const int maxRow) {
+        mAutoTilesData.loadBitmap(src, minRow, maxRow);
+    }
+
+    //! @brief Dabs not touching tile rows [minRow, maxRow] are skipped,
+    //! the brush dynamics still advance as if they were painted.
+    //! Used to paint a single stroke in parallel horizontal bands.
+    void setDabRows(const int minRow, const int maxRow) {
+        mDabMinRow = minRow;
+        mDabMaxRow = maxRow;
+    }
+
+    //! @brief Moves the tiles in rows [minRow, maxRow] from src.
+    void takeTiles(AutoTiledSurface& src, const int minRow, const int maxRow) {
+        mAutoTilesData.takeTiles(src.mAutoTilesData, minRow, maxRow);
+    }
 
     MyPaintRectangle paintPressEvent(MyPaintBrush * const brush,
                                      const QPointF& pos,
@@ -93,6 +111,10 @@ struct AutoTiledSurface {
         return mAutoTilesData.tileToBitmap(tx, ty);
     }
 
+    bool storesTile(const int tx, const int ty) const {
+        return mAutoTilesData.storesTile(tx, ty);
+    }
+
     SkBitmap toBitmap(const QMargins& margin = QMargins()) const {
         return mAutoTilesData.toBitmap(margin);
     }
@@ -120,9 +142,22 @@ struct AutoTiledSurface {
     }
 
     void clear() { mAutoTilesData.clear(); }
+
+    //! @brief Guards the tile data while a BrushStrokeWorker dabs into it,
+    //! the surface methods do not lock it themselves.
+    QMutex& mutex() const { return mMutex; }
 private:
     static void sFree(MyPaintSurface *surface);
 
+    static int sDrawDab(MyPaintSurface *surface, float x, float y,
+                        float radius,
+                        float color_r, float color_g, float color_b,
+                        float opaque, float hardness,
+                        float color_a,
+                        float aspect_ratio, float angle,
+                        float lock_alpha,
+                        float colorize);
+
     static void sRequestStart(MyPaintTiledSurface *tiled_surface,
                               MyPaintTileRequest *request);
 
@@ -136,6 +171,11 @@ protected:
     MyPaintTiledSurface fParent;
     MyPaintSurface* const fMyPaintSurface;
     AutoTilesData mAutoTilesData;
+private:
+    MyPaintSurfaceDrawDabFunction mDrawDab;
+    int mDabMinRow = INT_MIN;
+    int mDabMaxRow = INT_MAX;
+    mutable QMutex mMutex;
 };
 
 #endif // AUTOTILEDSURFACE_H
@@ -17,20 +17,28 @@
 #include "autotilesdata.h"
 #include "exceptions.h"
 #include "skia/skiahelpers.h"
+#include "colorconversions.h"
+#include <climits>
 
-uint16_t *allocateTile(const size_t& size) {
+TilePtr allocateTile(const size_t& size) {
     auto ptr = new uint16_t[size];
     if(!ptr) RuntimeThrow("Could not allocate memory for a tile.");
-    return ptr;
+    return TilePtr(ptr, std::default_delete<uint16_t[]>());
 }
 
-uint16_t *newZeroedTile(const size_t& size) {
-    auto ptr = new uint16_t[size];
-    if(!ptr) RuntimeThrow("Could not allocate memory for a tile.");
-    memset(ptr, 0, size*sizeof(uint16_t));
+TilePtr newZeroedTile(const size_t& size) {
+    auto ptr = allocateTile(size);
+    memset(ptr.get(), 0, size*sizeof(uint16_t));
     return ptr;
 }
 
+//! @brief Read in place of the tiles that are not stored,
+//! it is never written to.
+const TilePtr& blankTile() {
+    static const TilePtr sBlankTile = newZeroedTile(TILE_SPIXEL_SIZE);
+    return sBlankTile;
+}
+
 AutoTilesData::AutoTilesData() {}
 
 AutoTilesData::AutoTilesData(const AutoTilesData &other) {
@@ -38,21 +46,8 @@ AutoTilesData::AutoTilesData(const AutoTilesData &other) {
     mZeroTileRow = other.mZeroTileRow;
     mColumnCount = other.mColumnCount;
     mRowCount = other.mRowCount;
-
-    for(auto& column : other.mColumns) {
-        mColumns.append(QList<uint16_t*>());
-        QList<uint16_t*> &col = mColumns.last();
-        for(auto& srcTile : column) {
-            const auto dstTile = allocateTile(TILE_SPIXEL_SIZE);
-            uint16_t * dstP = dstTile;
-            const uint16_t * srcP = srcTile;
-            for(int sp = 0; sp < TILE_SPIXEL_SIZE; sp++) {
-                *(dstP++) = *(srcP++);
-            }
-
-            col << dstTile;
-        }
-    }
+    // tiles are shared until written to
+    mTiles = other.mTiles;
 }
 
 AutoTilesData::AutoTilesData(AutoTilesData &&other) {
@@ -72,6 +67,11 @@ AutoTilesData &AutoTilesData::operator=(AutoTilesData &&other) {
 }
 
 void AutoTilesData::loadBitmap(const SkBitmap &src) {
+    loadBitmap(src, 0, INT_MAX);
+}
+
+void AutoTilesData::loadBitmap(const SkBitmap &src,
+                               const int minRow, const int maxRow) {
     clear();
     const int nCols = qCeil(static_cast<qreal>(src.width())/TILE_SIZE);
     const int nRows = qCeil(static_cast<qreal>(src.height())/TILE_SIZE);
@@ -80,34 +80,29 @@ void AutoTilesData::loadBitmap(const SkBitmap &src) {
         const bool lastCol = col == (nCols - 1);
         const int x0 = col*TILE_SIZE;
         const int maxX = qMin(x0 + TILE_SIZE, src.width());
-        QList<uint16_t*> colRows;
-        for(int row = 0; row < nRows; row++) {
+        for(int row = qMax(0, minRow); row < nRows && row <= maxRow; row++) {
             const bool lastRow = row == (nRows - 1);
             const bool iniZeroed = lastCol || lastRow;
-            uint16_t * tileP;
+            TilePtr tile;
             try {
-                tileP = iniZeroed ? newZeroedTile(TILE_SPIXEL_SIZE) :
-                                    allocateTile(TILE_SPIXEL_SIZE);
+                tile = iniZeroed ? newZeroedTile(TILE_SPIXEL_SIZE) :
+                                   allocateTile(TILE_SPIXEL_SIZE);
             } catch(...) {
                 clear();
                 RuntimeThrow("Failed to load bitmap to AutoTilesData.");
             }
 
+            uint16_t * const tileP = tile.get();
             const int y0 = row*TILE_SIZE;
             const int maxY = qMin(y0 + TILE_SIZE, src.height());
             for(int y = y0; y < maxY; y++) {
-                const uint8_t * srcLine = srcP + (y*src.width() + x0)*4;
-                uint16_t* dstLine = tileP + (y - y0)*TILE_SIZE*4;
-                for(int x = x0; x < maxX; x++) {
-                    *dstLine++ = (*srcLine++ * (1<<15) + 255/2) / 255;
-                    *dstLine++ = (*srcLine++ * (1<<15) + 255/2) / 255;
-                    *dstLine++ = (*srcLine++ * (1<<15) + 255/2) / 255;
-                    *dstLine++ = (*srcLine++ * (1<<15) + 255/2) / 255;
-                }
+                const uint8_t * const srcLine = srcP + (y*src.width() + x0)*4;
+                uint16_t * const dstLine = tileP + (y - y0)*TILE_SIZE*4;
+                rgba8_premultiplied_to_rgba16_span(srcLine, dstLine, maxX - x0);
             }
-            colRows << tileP;
+            // fully transparent tiles are not stored
+            insertTile(col, row, tile);
         }
-        mColumns << colRows;
     }
     mColumnCount = nCols;
     mRowCount = nRows;
@@ -120,27 +115,70 @@ AutoTilesData::~AutoTilesData() {
 }
 
 void AutoTilesData::clear() {
-    for(const auto& col : mColumns) {
-        for(const auto& row : col) {
-            free(row);
-        }
-    }
-    mColumns.clear();
+    mTiles.clear();
     mZeroTileCol = 0;
     mZeroTileRow = 0;
     mColumnCount = 0;
     mRowCount = 0;
 }
 
-uint16_t *AutoTilesData::getTile(const int tx, const int ty) const {
+const uint16_t *AutoTilesData::getTile(const int tx, const int ty) const {
     return getTileByIndex(tx + mZeroTileCol, ty + mZeroTileRow);
 }
 
-uint16_t *AutoTilesData::getTileByIndex(const int colId,
-                                        const int rowId) const {
-    if(colId < 0 || colId >= mColumnCount ||
-       rowId < 0 || rowId >= mRowCount) return nullptr;
-    return mColumns.at(colId).at(rowId);
+uint16_t *AutoTilesData::getTileForWrite(const int tx, const int ty) {
+    if(!containsIndex(tx + mZeroTileCol, ty + mZeroTileRow)) return nullptr;
+    const quint64 key = sTileKey(tx, ty);
+    const auto it = mTiles.find(key);
+    if(it == mTiles.end()) {
+        const auto tile = newZeroedTile(TILE_SPIXEL_SIZE);
+        mTiles.insert(key, tile);
+        return tile.get();
+    }
+    TilePtr& tile = it.value();
+    if(tile.use_count() > 1) {
+        const auto clone = allocateTile(TILE_SPIXEL_SIZE);
+        memcpy(clone.get(), tile.get(), TILE_SPIXEL_SIZE*sizeof(uint16_t));
+        tile = clone;
+    }
+    return tile.get();
+}
+
+const uint16_t *AutoTilesData::getTileByIndex(const int colId,
+                                              const int rowId) const {
+    if(!containsIndex(colId, rowId)) return nullptr;
+    const auto key = sTileKey(colId - mZeroTileCol, rowId - mZeroTileRow);
+    const auto it = mTiles.find(key);
+    if(it == mTiles.end()) return blankTile().get();
+    return it.value().get();
+}
+
+void AutoTilesData::takeTiles(AutoTilesData &src,
+                              const int minRow, const int maxRow) {
+    if(src.isEmpty()) return;
+    const QRect srcRect = src.tileBoundingRect();
+    const int top = qMax(minRow, srcRect.top());
+    const int bottom = qMin(maxRow, srcRect.bottom());
+    if(top > bottom) return;
+    stretchToTile(srcRect.left(), top);
+    stretchToTile(srcRect.right(), bottom);
+    for(auto it = src.mTiles.begin(); it != src.mTiles.end();) {
+        const int ty = sKeyTile(it.key()).y();
+        if(ty < minRow || ty > maxRow) {
+            it++;
+            continue;
+        }
+        mTiles.insert(it.key(), it.value());
+        it = src.mTiles.erase(it);
+    }
+}
+
+void AutoTilesData::insertTile(const int tx, const int ty,
+                               const TilePtr& tile) {
+    const bool blank = memcmp(tile.get(), blankTile().get(),
+                              TILE_SPIXEL_SIZE*sizeof(uint16_t)) == 0;
+    if(blank) return;
+    mTiles.insert(sTileKey(tx, ty), tile);
 }
 
 int AutoTilesData::width() const {
@@ -159,19 +197,9 @@ void AutoTilesData::tileToBitmap(const int tx, const int ty, SkBitmap &bitmap) {
     const uint16_t * const srcP = getTile(tx, ty);
 
     for(int y = 0; y < TILE_SIZE; y++) {
-        uint8_t * dstLine = dstP + y*bitmap.width()*4;
-        const uint16_t * srcLine = srcP + y*TILE_SIZE*4;
-        for(int x = 0; x < TILE_SIZE; x++) {
-            const uint32_t r = *srcLine++;
-            const uint32_t g = *srcLine++;
-            const uint32_t b = *srcLine++;
-            const uint32_t a = *srcLine++;
-
-            *dstLine++ = (r * 255 + (1<<15)/2) / (1<<15);
-            *dstLine++ = (g * 255 + (1<<15)/2) / (1<<15);
-            *dstLine++ = (b * 255 + (1<<15)/2) / (1<<15);
-            *dstLine++ = (a * 255 + (1<<15)/2) / (1<<15);
-        }
+        uint8_t * const dstLine = dstP + y*bitmap.width()*4;
+        const uint16_t * const srcLine = srcP + y*TILE_SIZE*4;
+        rgba16_to_rgba8_premultiplied_span(srcLine, dstLine, TILE_SIZE);
     }
 }
 
@@ -255,19 +283,10 @@ SkBitmap AutoTilesData::toBitmap(const QMargins& margin) const {
             const int y0 = row*TILE_SIZE + tM;
             const int maxY = qMin(y0 + TILE_SIZE, dst.height() - bM0);
             for(int y = qMax(minY, y0); y < maxY; y++) {
-                uint8_t * dstLine = dstP + (y*dst.width() + x0)*4 + minX - qMin(minX, x0);
-                const uint16_t * srcLine = srcP + (y - y0)*TILE_SIZE*4 + minX - qMin(minX, x0);
-                for(int x = qMax(minX, x0); x < maxX; x++) {
-                    const uint32_t r = *srcLine++;
-                    const uint32_t g = *srcLine++;
-                    const uint32_t b = *srcLine++;
-                    const uint32_t a = *srcLine++;
-
-                    *dstLine++ = (r * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (g * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (b * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (a * 255 + (1<<15)/2) / (1<<15);
-                }
+                uint8_t * const dstLine = dstP + (y*dst.width() + x0)*4 + minX - qMin(minX, x0);
+                const uint16_t * const srcLine = srcP + (y - y0)*TILE_SIZE*4 + minX - qMin(minX, x0);
+                rgba16_to_rgba8_premultiplied_span(srcLine, dstLine,
+                                                   maxX - qMax(minX, x0));
             }
         }
     }
@@ -334,29 +353,11 @@ bool AutoTilesData::drawOnPixmap(SkPixmap &dst,
             const int minTileDstY = qMax(dstY0, minDstY);
             const int maxTileDstY = qMin((dstRow + 1)*TILE_SIZE - 1, maxDstY);
             for(int y = minTileDstY; y <= maxTileDstY; y++) {
-                uint8_t * dstLine = dstP + (y*dst.width() + minTileDstX)*4;
-                const uint16_t * srcLine = srcP +
+                uint8_t * const dstLine = dstP + (y*dst.width() + minTileDstX)*4;
+                const uint16_t * const srcLine = srcP +
                         ((y - dstY0)*TILE_SIZE + minSrcTileX)*4;
-                for(int x = minTileDstX; x <= maxTileDstX; x++) {
-                    uint32_t r = *srcLine++;
-                    uint32_t g = *srcLine++;
-                    uint32_t b = *srcLine++;
-                    uint32_t a = *srcLine++;
-
-                    // un-premultiply alpha (with rounding)
-                    if(a != 0) {
-                        r = ((r << 15) + a/2) / a;
-                        g = ((g << 15) + a/2) / a;
-                        b = ((b << 15) + a/2) / a;
-                    } else {
-                        r = g = b = 0;
-                    }
-
-                    *dstLine++ = (r * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (g * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (b * 255 + (1<<15)/2) / (1<<15);
-                    *dstLine++ = (a * 255 + (1<<15)/2) / (1<<15);
-                }
+                rgba16_to_rgba8_unpremultiplied_span(
+                            srcLine, dstLine, maxTileDstX - minTileDstX + 1);
             }
         }
     }
@@ -368,14 +369,22 @@ void AutoTilesData::write(eWriteStream& dst) const {
     dst << mZeroTileRow;
     dst << mColumnCount;
     dst << mRowCount;
-    const int nCols = mColumns.count();
-    dst << nCols;
-    const int nRows = mColumns.isEmpty() ? 0 : mColumns.first().count();
-    dst << nRows;
-    for(const auto& col : mColumns) {
-        for(const auto& row : col) {
-            dst.write(row, TILE_SPIXEL_SIZE*sizeof(uint16_t));
-        }
+    dst << mTiles.count();
+    // every distinct tile is written once, followed by its id,
+    // later occurrences only store the id
+    QHash<const uint16_t*, int> ids;
+    for(auto it = mTiles.constBegin(); it != mTiles.constEnd(); it++) {
+        const QPoint tile = sKeyTile(it.key());
+        dst << tile.x();
+        dst << tile.y();
+        const uint16_t * const data = it.value().get();
+        const auto idIt = ids.find(data);
+        if(idIt == ids.end()) {
+            const int id = ids.count();
+            ids.insert(data, id);
+            dst << id;
+            dst.write(data, TILE_SPIXEL_SIZE*sizeof(uint16_t));
+        } else dst << idIt.value();
     }
 }
 
@@ -385,17 +394,47 @@ void AutoTilesData::read(eReadStream &src) {
     src >> mZeroTileRow;
     src >> mColumnCount;
     src >> mRowCount;
+    if(src.evFileVersion() < 4) return readDense(src);
+    int nTiles;
+    src >> nTiles;
+    QList<TilePtr> tiles;
+    for(int i = 0; i < nTiles; i++) {
+        int tx; src >> tx;
+        int ty; src >> ty;
+        int id; src >> id;
+        if(id == tiles.count()) {
+            const auto tile = allocateTile(TILE_SPIXEL_SIZE);
+            src.read(tile.get(), TILE_SPIXEL_SIZE*sizeof(uint16_t));
+            tiles << tile;
+        } else if(id < 0 || id >= tiles.count()) {
+            RuntimeThrow("Invalid tile id");
+        }
+        mTiles.insert(sTileKey(tx, ty), tiles.at(id));
+    }
+}
+
+void AutoTilesData::readDense(eReadStream &src) {
     int nCols;
     src >> nCols;
     int nRows;
     src >> nRows;
+    const bool shared = src.evFileVersion() > 2;
+    QList<TilePtr> tiles;
     for(int col = 0; col < nCols; col++) {
-        mColumns << QList<uint16_t*>();
-        QList<uint16_t*>& column = mColumns.last();
+        const int tx = col - mZeroTileCol;
         for(int row = 0; row < nRows; row++) {
-            const auto tile = allocateTile(TILE_SPIXEL_SIZE);
-            src.read(tile, TILE_SPIXEL_SIZE*sizeof(uint16_t));
-            column << tile;
+            const int ty = row - mZeroTileRow;
+            int id = tiles.count();
+            if(shared) src >> id;
+            if(id == -1) continue;
+            if(id == tiles.count()) {
+                const auto tile = allocateTile(TILE_SPIXEL_SIZE);
+                src.read(tile.get(), TILE_SPIXEL_SIZE*sizeof(uint16_t));
+                if(shared) tiles << tile;
+                insertTile(tx, ty, tile);
+            } else if(id >= 0 && id < tiles.count()) {
+                mTiles.insert(sTileKey(tx, ty), tiles.at(id));
+            } else RuntimeThrow("Invalid tile id");
         }
     }
 }
@@ -404,11 +443,12 @@ bool AutoTilesData::stretchToTile(const int tx, const int ty) {
     if(tx > mMaxCol || tx < mMinCol) return false;
     if(ty > mMaxRow || ty < mMinRow) return false;
 
-    if(mColumns.isEmpty()) {
+    // only the bounding rect grows, tiles are allocated when written to
+    if(isEmpty()) {
         mZeroTileCol = -tx;
         mZeroTileRow = -ty;
-        appendRows(1);
-        appendColumns(1);
+        mColumnCount = 1;
+        mRowCount = 1;
         return true;
     }
 
@@ -416,56 +456,16 @@ bool AutoTilesData::stretchToTile(const int tx, const int ty) {
     const int rowId = ty + mZeroTileRow;
 
     if(rowId < 0) {
-        prependRows(qAbs(rowId));
+        mRowCount -= rowId;
+        mZeroTileRow -= rowId;
     } else if(rowId >= mRowCount) {
-        appendRows(qAbs(rowId - mRowCount + 1));
+        mRowCount = rowId + 1;
     }
     if(colId < 0) {
-        prependColumns(qAbs(colId));
+        mColumnCount -= colId;
+        mZeroTileCol -= colId;
     } else if(colId >= mColumnCount) {
-        appendColumns(qAbs(colId - mColumnCount + 1));
+        mColumnCount = colId + 1;
     }
     return true;
 }
-
-QList<uint16_t *> AutoTilesData::newColumn() {
-    QList<uint16_t*> col;
-    for(int j = 0; j < mRowCount; j++) {
-        col << newZeroedTile(TILE_SPIXEL_SIZE);
-    }
-    return col;
-}
-
-void AutoTilesData::prependRows(const int count) {
-    for(QList<uint16_t*>& col : mColumns) {
-        for(int i = 0; i < count; i++) {
-            col.prepend(newZeroedTile(TILE_SPIXEL_SIZE));
-        }
-    }
-    mRowCount += count;
-    mZeroTileRow += count;
-}
-
-void AutoTilesData::appendRows(const int count) {
-    for(QList<uint16_t*>& col : mColumns) {
-        for(int i = 0; i < count; i++) {
-            col.append(newZeroedTile(TILE_SPIXEL_SIZE));
-        }
-    }
-    mRowCount += count;
-}
-
-void AutoTilesData::prependColumns(const int count) {
-    for(int i = 0; i < count; i++) {
-        mColumns.prepend(newColumn());
-    }
-    mColumnCount += count;
-    mZeroTileCol += count;
-}
-
-void AutoTilesData::appendColumns(const int count) {
-    for(int i = 0; i < count; i++) {
-        mColumns.append(newColumn());
-    }
-    mColumnCount += count;
-}
@@ -18,6 +18,7 @@
 #define AUTOTILESDATA_H
 #include <QtCore>
 #include <QList>
+#include <memory>
 #include "skia/skiaincludes.h"
 #include "../ReadWrite/basicreadwrite.h"
 #ifndef TILE_SIZE
@@ -29,6 +30,12 @@
 #endif
 #include "glhelpers.h"
 
+//! @brief Tiles are shared between AutoTilesData copies,
+//! a shared tile is cloned before it is written to.
+typedef std::shared_ptr<uint16_t> TilePtr;
+
+//! @brief Sparse tile storage, only tiles that were painted on are stored.
+//! Tiles within the bounding rect that are not stored read as blank.
 struct AutoTilesData {
     AutoTilesData();
     AutoTilesData(const AutoTilesData& other);
@@ -40,11 +47,22 @@ struct AutoTilesData {
     ~AutoTilesData();
 
     void loadBitmap(const SkBitmap& src);
+    //! @brief Loads only the tile rows within [minRow, maxRow].
+    void loadBitmap(const SkBitmap& src, const int minRow, const int maxRow);
+    //! @brief Moves the tiles in rows [minRow, maxRow] from src,
+    //! no pixels are copied.
+    void takeTiles(AutoTilesData& src, const int minRow, const int maxRow);
 
     void clear();
 
     bool stretchToTile(const int tx, const int ty);
-    uint16_t* getTile(const int tx, const int ty) const;
+    const uint16_t* getTile(const int tx, const int ty) const;
+    //! @brief Clones the tile first if it is shared with another copy.
+    uint16_t* getTileForWrite(const int tx, const int ty);
+    //! @brief False for tiles within bounds that were never painted on.
+    bool storesTile(const int tx, const int ty) const {
+        return mTiles.contains(sTileKey(tx, ty));
+    }
 
     int width() const;
     int height() const;
@@ -98,7 +116,7 @@ struct AutoTilesData {
     bool isEmpty() const { return mColumnCount == 0 || mRowCount == 0; }
 
     void swap(AutoTilesData& other) {
-        mColumns.swap(other.mColumns);
+        mTiles.swap(other.mTiles);
 
         std::swap(mMinCol, other.mMinCol);
         std::swap(mMaxCol, other.mMaxCol);
@@ -114,13 +132,23 @@ struct AutoTilesData {
     void write(eWriteStream &dst) const;
     void read(eReadStream& src);
 protected:
-    uint16_t* getTileByIndex(const int colId, const int rowId) const;
+    const uint16_t* getTileByIndex(const int colId, const int rowId) const;
 private:
-    QList<uint16_t*> newColumn();
-    void prependRows(const int count);
-    void appendRows(const int count);
-    void prependColumns(const int count);
-    void appendColumns(const int count);
+    static quint64 sTileKey(const int tx, const int ty) {
+        return (quint64(quint32(tx)) << 32) | quint32(ty);
+    }
+
+    static QPoint sKeyTile(const quint64 key) {
+        return QPoint(int(quint32(key >> 32)), int(quint32(key)));
+    }
+
+    bool containsIndex(const int colId, const int rowId) const {
+        return colId >= 0 && colId < mColumnCount &&
+               rowId >= 0 && rowId < mRowCount;
+    }
+
+    void insertTile(const int tx, const int ty, const TilePtr& tile);
+    void readDense(eReadStream& src);
 
     int mMinCol = -100;
     int mMaxCol = 100;
@@ -131,7 +159,8 @@ private:
     int mZeroTileRow = 0;
     int mColumnCount = 0;
     int mRowCount = 0;
-    QList<QList<uint16_t*>> mColumns;
+    //! @brief Keyed by tile coordinates, unaffected by stretching.
+    QHash<quint64, TilePtr> mTiles;
 };
 
 #endif // AUTOTILESDATA_H
@@ -0,0 +1,113 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "brushstrokeworker.h"
+
+BrushStrokeWorker::BrushStrokeWorker(QObject * const parent) :
+    QThread(parent) {
+    start();
+}
+
+BrushStrokeWorker::~BrushStrokeWorker() {
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mQuit = true;
+    }
+    mQueueChanged.wakeAll();
+    wait();
+}
+
+void BrushStrokeWorker::strokePress(const AutoTiledSurface * const target,
+                                    const stdsptr<SimpleBrushWrapper>& brush,
+                                    const QPointF& pos,
+                                    const qreal pressure,
+                                    const qreal xTilt, const qreal yTilt) {
+    enqueue({true, target, brush, pos, 1, pressure, xTilt, yTilt});
+}
+
+void BrushStrokeWorker::strokeMove(const AutoTiledSurface * const target,
+                                   const stdsptr<SimpleBrushWrapper>& brush,
+                                   const QPointF& pos,
+                                   const double dTime, const qreal pressure,
+                                   const qreal xTilt, const qreal yTilt) {
+    enqueue({false, target, brush, pos, dTime, pressure, xTilt, yTilt});
+}
+
+void BrushStrokeWorker::sync() {
+    QMutexLocker lock(&mQueueMutex);
+    while(mBusy || !mQueue.isEmpty()) mIdle.wait(&mQueueMutex);
+}
+
+QRect BrushStrokeWorker::takeChangedRect() {
+    QMutexLocker lock(&mChangedMutex);
+    QRect result;
+    std::swap(result, mChangedRect);
+    return result;
+}
+
+void BrushStrokeWorker::enqueue(const StrokeEvent& event) {
+    {
+        QMutexLocker lock(&mQueueMutex);
+        mQueue.enqueue(event);
+    }
+    mQueueChanged.wakeOne();
+}
+
+void BrushStrokeWorker::addChangedRect(const QRect& rect) {
+    if(rect.isEmpty()) return;
+    bool wasEmpty;
+    {
+        QMutexLocker lock(&mChangedMutex);
+        wasEmpty = mChangedRect.isEmpty();
+        mChangedRect = mChangedRect.united(rect);
+    }
+    // a single queued call publishes everything changed until it runs
+    if(wasEmpty) emit changed();
+}
+
+void BrushStrokeWorker::run() {
+    QMutexLocker lock(&mQueueMutex);
+    while(!mQuit) {
+        if(mQueue.isEmpty()) {
+            mBusy = false;
+            mIdle.wakeAll();
+            mQueueChanged.wait(&mQueueMutex);
+            continue;
+        }
+        mBusy = true;
+        const auto event = mQueue.dequeue();
+        lock.unlock();
+        MyPaintRectangle roi;
+        {
+            const auto target = event.fTarget;
+            const auto brush = event.fBrush->getBrush();
+            QMutexLocker surfaceLock(&target->mutex());
+            if(event.fPress) {
+                roi = target->paintPressEvent(brush, event.fPos,
+                                              event.fDTime, event.fPressure,
+                                              event.fXTilt, event.fYTilt);
+            } else {
+                roi = target->paintMoveEvent(brush, event.fPos,
+                                             event.fDTime, event.fPressure,
+                                             event.fXTilt, event.fYTilt);
+            }
+        }
+        addChangedRect(QRect(roi.x, roi.y, roi.width, roi.height));
+        lock.relock();
+    }
+    mBusy = false;
+    mIdle.wakeAll();
+}
@@ -0,0 +1,86 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BRUSHSTROKEWORKER_H
+#define BRUSHSTROKEWORKER_H
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QRect>
+#include "autotiledsurface.h"
+#include "simplebrushwrapper.h"
+
+//! @brief Dabs queued brush events into an AutoTiledSurface
+//! on a dedicated thread. Changed pixels are accumulated and announced
+//! with changed(), tile data has to be read under the surface mutex().
+//! The brush passed in is used only by the worker, pass a snapshot.
+class BrushStrokeWorker : public QThread {
+    Q_OBJECT
+public:
+    BrushStrokeWorker(QObject * const parent = nullptr);
+    ~BrushStrokeWorker();
+
+    void strokePress(const AutoTiledSurface * const target,
+                     const stdsptr<SimpleBrushWrapper>& brush,
+                     const QPointF& pos,
+                     const qreal pressure,
+                     const qreal xTilt, const qreal yTilt);
+    void strokeMove(const AutoTiledSurface * const target,
+                    const stdsptr<SimpleBrushWrapper>& brush,
+                    const QPointF& pos,
+                    const double dTime, const qreal pressure,
+                    const qreal xTilt, const qreal yTilt);
+
+    //! @brief Waits until all the queued events are dabbed,
+    //! has to be called before the target is copied, moved or replaced.
+    void sync();
+
+    //! @brief Returns the pixel rect changed since the last call.
+    QRect takeChangedRect();
+signals:
+    //! @brief Emitted from the worker thread once per batch of changes.
+    void changed();
+protected:
+    void run() override;
+private:
+    struct StrokeEvent {
+        bool fPress;
+        const AutoTiledSurface * fTarget;
+        stdsptr<SimpleBrushWrapper> fBrush;
+        QPointF fPos;
+        double fDTime;
+        qreal fPressure;
+        qreal fXTilt;
+        qreal fYTilt;
+    };
+
+    void enqueue(const StrokeEvent& event);
+    void addChangedRect(const QRect& rect);
+
+    // guards the queue and the busy flag
+    QMutex mQueueMutex;
+    QWaitCondition mQueueChanged;
+    QWaitCondition mIdle;
+    QQueue<StrokeEvent> mQueue;
+    bool mBusy = false;
+    bool mQuit = false;
+
+    QMutex mChangedMutex;
+    QRect mChangedRect;
+};
+
+#endif // BRUSHSTROKEWORKER_H
@@ -16,6 +16,377 @@
 
 #include "colorconversions.h"
 
+#include <QtGlobal>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLORCONVERSIONS_X86
+#include <immintrin.h>
+#define SSE41_TARGET __attribute__((target("sse4.1")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace {
+    // reference conversions, the vectorized kernels match them exactly
+    inline uint32_t to16(const uint32_t v8) {
+        return (v8 * (1<<15) + 255/2) / 255;
+    }
+
+    inline uint32_t to8(const uint32_t v16) {
+        return (v16 * 255 + (1<<15)/2) / (1<<15);
+    }
+
+    void rgba8ToRgba16Scalar(const uint8_t * src, uint16_t * dst,
+                             const int n) {
+        for(int i = 0; i < n; i++) {
+            const uint32_t a = to16(src[3]);
+            // premultiply alpha (with rounding)
+            *dst++ = (to16(*src++) * a + (1<<15)/2) / (1<<15);
+            *dst++ = (to16(*src++) * a + (1<<15)/2) / (1<<15);
+            *dst++ = (to16(*src++) * a + (1<<15)/2) / (1<<15);
+            *dst++ = a;
+            src++;
+        }
+    }
+
+    void rgba8PremulToRgba16Scalar(const uint8_t * src, uint16_t * dst,
+                                   const int n) {
+        for(int i = 0; i < 4*n; i++) *dst++ = to16(*src++);
+    }
+
+    void rgba16ToRgba8UnpremulScalar(const uint16_t * src, uint8_t * dst,
+                                     const int n) {
+        for(int i = 0; i < n; i++) {
+            const uint32_t a = src[3];
+            uint32_t rgb[3];
+            for(int c = 0; c < 3; c++) {
+                const uint32_t v = qMin(uint32_t(src[c]), a);
+                // un-premultiply alpha (with rounding)
+                rgb[c] = a == 0 ? 0 : ((v << 15) + a/2) / a;
+            }
+            *dst++ = to8(rgb[0]);
+            *dst++ = to8(rgb[1]);
+            *dst++ = to8(rgb[2]);
+            *dst++ = to8(a);
+            src += 4;
+        }
+    }
+
+    void rgba16ToRgba8PremulScalar(const uint16_t * src, uint8_t * dst,
+                                   const int n) {
+        for(int i = 0; i < 4*n; i++) *dst++ = to8(*src++);
+    }
+
+#ifdef COLORCONVERSIONS_X86
+    // (v*255 + 2^14) >> 15 == (v*510 + 2^15) >> 16, split into
+    // the high and the low half of the 16-bit product
+    SSE41_TARGET
+    inline __m128i to8Sse41(const __m128i v) {
+        const __m128i k = _mm_set1_epi16(510);
+        return _mm_add_epi16(_mm_mulhi_epu16(v, k),
+                             _mm_srli_epi16(_mm_mullo_epi16(v, k), 15));
+    }
+
+    // (v*2^15 + 127)/255 == v*128 + (128*v + 127)/255,
+    // y/255 == (y + 1 + (y >> 8)) >> 8 for y < 2^16
+    SSE41_TARGET
+    inline __m128i to16Sse41(const __m128i v) {
+        const __m128i y = _mm_add_epi16(_mm_slli_epi16(v, 7),
+                                        _mm_set1_epi16(127));
+        const __m128i div = _mm_srli_epi16(
+                    _mm_add_epi16(_mm_add_epi16(y, _mm_set1_epi16(1)),
+                                  _mm_srli_epi16(y, 8)), 8);
+        return _mm_add_epi16(_mm_slli_epi16(v, 7), div);
+    }
+
+    //! @brief (c*a + 2^14) >> 15 for 16-bit c and a up to 2^15.
+    SSE41_TARGET
+    inline __m128i mulFixedSse41(const __m128i c, const __m128i a) {
+        const __m128i hi = _mm_mulhi_epu16(c, a);
+        const __m128i lo = _mm_mullo_epi16(c, a);
+        const __m128i loRem = _mm_and_si128(lo, _mm_set1_epi16(0x7fff));
+        const __m128i carry = _mm_add_epi16(
+                    _mm_srli_epi16(lo, 15),
+                    _mm_srli_epi16(_mm_add_epi16(loRem, _mm_set1_epi16(1<<14)), 15));
+        return _mm_add_epi16(_mm_slli_epi16(hi, 1), carry);
+    }
+
+    //! @brief Un-premultiplies a single pixel in 32-bit lanes
+    //! using a refined reciprocal of alpha instead of a divide.
+    SSE41_TARGET
+    inline __m128i unpremulSse41(const __m128i px) {
+        const __m128i a = _mm_shuffle_epi32(px, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i c = _mm_min_epu32(px, a);
+        const __m128i num = _mm_add_epi32(_mm_slli_epi32(c, 15),
+                                          _mm_srli_epi32(a, 1));
+        const __m128 af = _mm_cvtepi32_ps(a);
+        __m128 rcp = _mm_rcp_ps(af);
+        rcp = _mm_mul_ps(rcp, _mm_sub_ps(_mm_set1_ps(2), _mm_mul_ps(af, rcp)));
+        __m128i q = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(num), rcp));
+        // the estimate is off by at most one
+        const __m128i rem = _mm_sub_epi32(num, _mm_mullo_epi32(q, a));
+        q = _mm_add_epi32(q, _mm_srai_epi32(rem, 31));
+        const __m128i rem2 = _mm_sub_epi32(num, _mm_mullo_epi32(q, a));
+        q = _mm_sub_epi32(q, _mm_cmpgt_epi32(rem2, _mm_sub_epi32(a, _mm_set1_epi32(1))));
+        // alpha is kept, fully transparent pixels become zero
+        q = _mm_blend_epi16(q, a, 0xC0);
+        return _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), q);
+    }
+
+    SSE41_TARGET
+    void rgba8ToRgba16Sse41(const uint8_t * src, uint16_t * dst, const int n) {
+        int i = 0;
+        for(; i + 2 <= n; i += 2) {
+            const __m128i v = to16Sse41(_mm_cvtepu8_epi16(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 4*i))));
+            __m128i a = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+            a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i r = _mm_blend_epi16(mulFixedSse41(v, a), v, 0x88);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i), r);
+        }
+        rgba8ToRgba16Scalar(src + 4*i, dst + 4*i, n - i);
+    }
+
+    SSE41_TARGET
+    void rgba8PremulToRgba16Sse41(const uint8_t * src, uint16_t * dst,
+                                  const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(src + 4*i));
+            const __m128i lo = to16Sse41(_mm_cvtepu8_epi16(v));
+            const __m128i hi = to16Sse41(_mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i + 8), hi);
+        }
+        rgba8PremulToRgba16Scalar(src + 4*i, dst + 4*i, n - i);
+    }
+
+    SSE41_TARGET
+    void rgba16ToRgba8UnpremulSse41(const uint16_t * src, uint8_t * dst,
+                                    const int n) {
+        int i = 0;
+        for(; i + 2 <= n; i += 2) {
+            const __m128i v = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(src + 4*i));
+            const __m128i p0 = unpremulSse41(_mm_cvtepu16_epi32(v));
+            const __m128i p1 = unpremulSse41(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8)));
+            const __m128i r = to8Sse41(_mm_packus_epi32(p0, p1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4*i),
+                             _mm_packus_epi16(r, r));
+        }
+        rgba16ToRgba8UnpremulScalar(src + 4*i, dst + 4*i, n - i);
+    }
+
+    SSE41_TARGET
+    void rgba16ToRgba8PremulSse41(const uint16_t * src, uint8_t * dst,
+                                  const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m128i lo = to8Sse41(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(src + 4*i)));
+            const __m128i hi = to8Sse41(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(src + 4*i + 8)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i),
+                             _mm_packus_epi16(lo, hi));
+        }
+        rgba16ToRgba8PremulScalar(src + 4*i, dst + 4*i, n - i);
+    }
+
+    AVX2_TARGET
+    inline __m256i to8Avx2(const __m256i v) {
+        const __m256i k = _mm256_set1_epi16(510);
+        return _mm256_add_epi16(_mm256_mulhi_epu16(v, k),
+                                _mm256_srli_epi16(_mm256_mullo_epi16(v, k), 15));
+    }
+
+    AVX2_TARGET
+    inline __m256i to16Avx2(const __m256i v) {
+        const __m256i y = _mm256_add_epi16(_mm256_slli_epi16(v, 7),
+                                           _mm256_set1_epi16(127));
+        const __m256i div = _mm256_srli_epi16(
+                    _mm256_add_epi16(_mm256_add_epi16(y, _mm256_set1_epi16(1)),
+                                     _mm256_srli_epi16(y, 8)), 8);
+        return _mm256_add_epi16(_mm256_slli_epi16(v, 7), div);
+    }
+
+    AVX2_TARGET
+    inline __m256i mulFixedAvx2(const __m256i c, const __m256i a) {
+        const __m256i hi = _mm256_mulhi_epu16(c, a);
+        const __m256i lo = _mm256_mullo_epi16(c, a);
+        const __m256i loRem = _mm256_and_si256(lo, _mm256_set1_epi16(0x7fff));
+        const __m256i carry = _mm256_add_epi16(
+                    _mm256_srli_epi16(lo, 15),
+                    _mm256_srli_epi16(_mm256_add_epi16(loRem, _mm256_set1_epi16(1<<14)), 15));
+        return _mm256_add_epi16(_mm256_slli_epi16(hi, 1), carry);
+    }
+
+    //! @brief Two pixels, one per 128-bit lane.
+    AVX2_TARGET
+    inline __m256i unpremulAvx2(const __m256i px) {
+        const __m256i a = _mm256_shuffle_epi32(px, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m256i c = _mm256_min_epu32(px, a);
+        const __m256i num = _mm256_add_epi32(_mm256_slli_epi32(c, 15),
+                                             _mm256_srli_epi32(a, 1));
+        const __m256 af = _mm256_cvtepi32_ps(a);
+        __m256 rcp = _mm256_rcp_ps(af);
+        rcp = _mm256_mul_ps(rcp, _mm256_sub_ps(_mm256_set1_ps(2),
+                                               _mm256_mul_ps(af, rcp)));
+        __m256i q = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(num), rcp));
+        const __m256i rem = _mm256_sub_epi32(num, _mm256_mullo_epi32(q, a));
+        q = _mm256_add_epi32(q, _mm256_srai_epi32(rem, 31));
+        const __m256i rem2 = _mm256_sub_epi32(num, _mm256_mullo_epi32(q, a));
+        q = _mm256_sub_epi32(q, _mm256_cmpgt_epi32(
+                                 rem2, _mm256_sub_epi32(a, _mm256_set1_epi32(1))));
+        q = _mm256_blend_epi16(q, a, 0xC0);
+        return _mm256_andnot_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()), q);
+    }
+
+    AVX2_TARGET
+    void rgba8ToRgba16Avx2(const uint8_t * src, uint16_t * dst, const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m256i v = to16Avx2(_mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i))));
+            __m256i a = _mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+            a = _mm256_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256i r = _mm256_blend_epi16(mulFixedAvx2(v, a), v, 0x88);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4*i), r);
+        }
+        rgba8ToRgba16Sse41(src + 4*i, dst + 4*i, n - i);
+    }
+
+    AVX2_TARGET
+    void rgba8PremulToRgba16Avx2(const uint8_t * src, uint16_t * dst,
+                                 const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m256i v = to16Avx2(_mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i))));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4*i), v);
+        }
+        rgba8PremulToRgba16Scalar(src + 4*i, dst + 4*i, n - i);
+    }
+
+    AVX2_TARGET
+    void rgba16ToRgba8UnpremulAvx2(const uint16_t * src, uint8_t * dst,
+                                   const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m256i p01 = unpremulAvx2(_mm256_cvtepu16_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i))));
+            const __m256i p23 = unpremulAvx2(_mm256_cvtepu16_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i + 8))));
+            // packs work within 128-bit lanes, restore the pixel order
+            const __m256i packed = _mm256_permute4x64_epi64(
+                        _mm256_packus_epi32(p01, p23), 0xD8);
+            const __m256i r = to8Avx2(packed);
+            const __m256i bytes = _mm256_permute4x64_epi64(
+                        _mm256_packus_epi16(r, r), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i),
+                             _mm256_castsi256_si128(bytes));
+        }
+        rgba16ToRgba8UnpremulSse41(src + 4*i, dst + 4*i, n - i);
+    }
+
+    AVX2_TARGET
+    void rgba16ToRgba8PremulAvx2(const uint16_t * src, uint8_t * dst,
+                                 const int n) {
+        int i = 0;
+        for(; i + 8 <= n; i += 8) {
+            const __m256i lo = to8Avx2(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(src + 4*i)));
+            const __m256i hi = to8Avx2(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(src + 4*i + 16)));
+            const __m256i bytes = _mm256_permute4x64_epi64(
+                        _mm256_packus_epi16(lo, hi), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4*i), bytes);
+        }
+        rgba16ToRgba8PremulScalar(src + 4*i, dst + 4*i, n - i);
+    }
+#endif
+
+    typedef void (*To16Func)(const uint8_t*, uint16_t*, int);
+    typedef void (*To8Func)(const uint16_t*, uint8_t*, int);
+
+    struct Kernels {
+        Kernels() {
+            if(!set(ColorConversions::Simd::avx2))
+                set(ColorConversions::Simd::sse41);
+        }
+
+        bool set(const ColorConversions::Simd simd) {
+            switch(simd) {
+            case ColorConversions::Simd::scalar:
+                fRgba8ToRgba16 = rgba8ToRgba16Scalar;
+                fRgba8PremulToRgba16 = rgba8PremulToRgba16Scalar;
+                fRgba16ToRgba8Unpremul = rgba16ToRgba8UnpremulScalar;
+                fRgba16ToRgba8Premul = rgba16ToRgba8PremulScalar;
+                return true;
+            case ColorConversions::Simd::sse41:
+#ifdef COLORCONVERSIONS_X86
+                __builtin_cpu_init();
+                if(!__builtin_cpu_supports("sse4.1")) return false;
+                fRgba8ToRgba16 = rgba8ToRgba16Sse41;
+                fRgba8PremulToRgba16 = rgba8PremulToRgba16Sse41;
+                fRgba16ToRgba8Unpremul = rgba16ToRgba8UnpremulSse41;
+                fRgba16ToRgba8Premul = rgba16ToRgba8PremulSse41;
+                return true;
+#else
+                return false;
+#endif
+            case ColorConversions::Simd::avx2:
+#ifdef COLORCONVERSIONS_X86
+                __builtin_cpu_init();
+                // the avx2 kernels finish their tails with sse4.1
+                if(!__builtin_cpu_supports("avx2") ||
+                   !__builtin_cpu_supports("sse4.1")) return false;
+                fRgba8ToRgba16 = rgba8ToRgba16Avx2;
+                fRgba8PremulToRgba16 = rgba8PremulToRgba16Avx2;
+                fRgba16ToRgba8Unpremul = rgba16ToRgba8UnpremulAvx2;
+                fRgba16ToRgba8Premul = rgba16ToRgba8PremulAvx2;
+                return true;
+#else
+                return false;
+#endif
+            }
+            return false;
+        }
+
+        To16Func fRgba8ToRgba16 = rgba8ToRgba16Scalar;
+        To16Func fRgba8PremulToRgba16 = rgba8PremulToRgba16Scalar;
+        To8Func fRgba16ToRgba8Unpremul = rgba16ToRgba8UnpremulScalar;
+        To8Func fRgba16ToRgba8Premul = rgba16ToRgba8PremulScalar;
+    };
+
+    Kernels& kernels() {
+        static Kernels instance;
+        return instance;
+    }
+}
+
+bool ColorConversions::setSimd(const Simd simd) {
+    return kernels().set(simd);
+}
+
+void rgba8_to_rgba16_span(const uint8_t * const src,
+                          uint16_t * const dst, const int n) {
+    kernels().fRgba8ToRgba16(src, dst, n);
+}
+
+void rgba8_premultiplied_to_rgba16_span(const uint8_t * const src,
+                                        uint16_t * const dst, const int n) {
+    kernels().fRgba8PremulToRgba16(src, dst, n);
+}
+
+void rgba16_to_rgba8_unpremultiplied_span(const uint16_t * const src,
+                                          uint8_t * const dst, const int n) {
+    kernels().fRgba16ToRgba8Unpremul(src, dst, n);
+}
+
+void rgba16_to_rgba8_premultiplied_span(const uint16_t * const src,
+                                        uint8_t * const dst, const int n) {
+    kernels().fRgba16ToRgba8Premul(src, dst, n);
+}
 
 // used mainly for loading layers (transparent PNG)
 void rgba8_to_rgba16(uint8_t* src,
@@ -24,31 +395,12 @@ void rgba8_to_rgba16(uint8_t* src,
                      const int dstWidth,
                      const int height) {
     for(int i = 0; i < height; i++) {
-        uint8_t *srcLine = src + i * srcWidth * 4;
-        uint16_t *dstLine = dst + i * dstWidth * 4;
-        for(int j = 0; j < dstWidth; j++) {
-            uint32_t r, g, b, a;
-            r = *srcLine++;
-            g = *srcLine++;
-            b = *srcLine++;
-            a = *srcLine++;
-
-            // convert to fixed point (with rounding)
-            r = (r * (1<<15) + 255/2) / 255;
-            g = (g * (1<<15) + 255/2) / 255;
-            b = (b * (1<<15) + 255/2) / 255;
-            a = (a * (1<<15) + 255/2) / 255;
-
-            // premultiply alpha (with rounding), save back
-            *dstLine++ = (r * a + (1<<15)/2) / (1<<15);
-            *dstLine++ = (g * a + (1<<15)/2) / (1<<15);
-            *dstLine++ = (b * a + (1<<15)/2) / (1<<15);
-            *dstLine++ = a;
-        }
+        rgba8_to_rgba16_span(src + i * srcWidth * 4,
+                             dst + i * dstWidth * 4, dstWidth);
     }
 }
 
-// Naive conversion code from the internal MyPaint format and 8 bit RGB
+// Conversion code from the internal MyPaint format and 8 bit RGB
 void rgba16_to_rgba8_unpremultiplied(
         uint16_t* src,
         const int srcWidth,
@@ -56,42 +408,8 @@ void rgba16_to_rgba8_unpremultiplied(
         const int dstWidth,
         const int height) {
     for(int i = 0; i < height; i++) {
-        uint16_t *srcLine = src + i * srcWidth * 4;
-        uint8_t *dstLine = dst + i * dstWidth * 4;
-        for(int j = 0; j < srcWidth; j++) {
-            uint32_t r, g, b, a;
-
-            r = *srcLine++;
-            g = *srcLine++;
-            b = *srcLine++;
-            a = *srcLine++;
-
-            // un-premultiply alpha (with rounding)
-            if(a != 0) {
-//                r = ((r << 15)) / a;
-//                g = ((g << 15)) / a;
-//                b = ((b << 15)) / a;
-                r = ((r << 15) + a/2) / a;
-                g = ((g << 15) + a/2) / a;
-                b = ((b << 15) + a/2) / a;
-            } else {
-                r = g = b = 0;
-            }
-
-            // Variant A) rounding
-            const uint32_t add_r = (1<<15)/2;
-            const uint32_t add_g = (1<<15)/2;
-            const uint32_t add_b = (1<<15)/2;
-            const uint32_t add_a = (1<<15)/2;
-            *dstLine++ = (r * 255 + add_r) / (1<<15);
-            *dstLine++ = (g * 255 + add_g) / (1<<15);
-            *dstLine++ = (b * 255 + add_b) / (1<<15);
-            *dstLine++ = (a * 255 + add_a) / (1<<15);
-//            *dstLine++ = (r * 255) / (1<<15);
-//            *dstLine++ = (g * 255) / (1<<15);
-//            *dstLine++ = (b * 255) / (1<<15);
-//            *dstLine++ = (a * 255) / (1<<15);
-        }
+        rgba16_to_rgba8_unpremultiplied_span(src + i * srcWidth * 4,
+                                             dst + i * dstWidth * 4, srcWidth);
     }
 }
 
@@ -102,25 +420,7 @@ void rgba16_to_rgba8_premultiplied(
         const int dstWidth,
         const int height) {
     for(int i = 0; i < height; i++) {
-        uint16_t *srcLine = src + i * srcWidth * 4;
-        uint8_t *dstLine = dst + i * dstWidth * 4;
-        for(int j = 0; j < srcWidth; j++) {
-            uint32_t r, g, b, a;
-
-            r = *srcLine++;
-            g = *srcLine++;
-            b = *srcLine++;
-            a = *srcLine++;
-
-            const uint32_t add_r = (1<<15)/2;
-            const uint32_t add_g = (1<<15)/2;
-            const uint32_t add_b = (1<<15)/2;
-            const uint32_t add_a = (1<<15)/2;
-            *dstLine++ = (r * 255 + add_r) / (1<<15);
-            *dstLine++ = (g * 255 + add_g) / (1<<15);
-            *dstLine++ = (b * 255 + add_b) / (1<<15);
-            *dstLine++ = (a * 255 + add_a) / (1<<15);
-        }
+        rgba16_to_rgba8_premultiplied_span(src + i * srcWidth * 4,
+                                           dst + i * dstWidth * 4, srcWidth);
     }
 }
-
@@ -18,6 +18,34 @@
 #define COLORCONVERSIONS_H
 #include <stdint-gcc.h>
 
+// MyPaint stores premultiplied channels in the [0, 1 << 15] range.
+// The span functions convert n pixels, they are vectorized with SSE4.1
+// or AVX2 picked at runtime, with a scalar fallback on other architectures.
+// All kernels give bit-exact results.
+
+namespace ColorConversions {
+    enum class Simd { scalar, sse41, avx2 };
+
+    //! @brief Selects the kernels used by the span functions,
+    //! for tests and benchmarks. Not to be called while converting.
+    //! Returns false if not supported by the cpu.
+    bool setSimd(const Simd simd);
+}
+
+//! @brief Premultiplies unpremultiplied rgba8 while converting to rgba16.
+void rgba8_to_rgba16_span(const uint8_t * const src,
+                          uint16_t * const dst, const int n);
+//! @brief Converts premultiplied rgba8 to premultiplied rgba16.
+void rgba8_premultiplied_to_rgba16_span(const uint8_t * const src,
+                                        uint16_t * const dst, const int n);
+//! @brief Converts premultiplied rgba16 to unpremultiplied rgba8,
+//! color channels are clamped to alpha.
+void rgba16_to_rgba8_unpremultiplied_span(const uint16_t * const src,
+                                          uint8_t * const dst, const int n);
+//! @brief Converts premultiplied rgba16 to premultiplied rgba8.
+void rgba16_to_rgba8_premultiplied_span(const uint16_t * const src,
+                                        uint8_t * const dst, const int n);
+
 void rgba8_to_rgba16(uint8_t* src,
                      const int srcWidth,
                      uint16_t* dst,
@@ -28,12 +28,19 @@ DrawableAutoTiledSurface::DrawableAutoTiledSurface() :
 
 DrawableAutoTiledSurface::DrawableAutoTiledSurface(
         const DrawableAutoTiledSurface &other) : DrawableAutoTiledSurface() {
+    QMutexLocker lock(&other.mSurface.mutex());
     mSurface = other.mSurface;
     mTileBitmaps = other.mTileBitmaps;
 }
 
 DrawableAutoTiledSurface &DrawableAutoTiledSurface::operator=(const DrawableAutoTiledSurface &other) {
-    mSurface = other.mSurface;
+    AutoTiledSurface surface;
+    {
+        QMutexLocker lock(&other.mSurface.mutex());
+        surface = other.mSurface;
+    }
+    QMutexLocker lock(&mSurface.mutex());
+    mSurface = std::move(surface);
     mTileBitmaps = other.mTileBitmaps;
     return *this;
 }
@@ -61,6 +68,7 @@ void DrawableAutoTiledSurface::drawOnCanvas(SkCanvas * const canvas,
 }
 
 void DrawableAutoTiledSurface::updateTileRecBitmaps(QRect tileRect) {
+    QMutexLocker lock(&mSurface.mutex());
     const QRect maxRect = mSurface.tileBoundingRect();
     if(!maxRect.intersects(tileRect)) return;
     tileRect = maxRect.intersected(tileRect);
@@ -74,7 +82,12 @@ void DrawableAutoTiledSurface::updateTileRecBitmaps(QRect tileRect) {
         for(int ty = tileRect.top(); ty <= tileRect.bottom(); ty++) {
             const auto tileId = QPoint(tx, ty) + zeroTile();
             SkBitmap& btmp = mBitmaps[tileId.x()][tileId.y()];
-            if(btmp.isNull()) {
+            // empty tiles are not drawn, no need to convert them
+            if(!mSurface.storesTile(tx, ty)) {
+                btmp.reset();
+                continue;
+            }
+            if(btmp.isNull() || !btmp.pixelRef()->unique()) {
                 btmp = mSurface.tileToBitmap(tx, ty);
             } else {
                 mSurface.tileToBitmap(tx, ty, btmp);
@@ -90,7 +103,7 @@ void DrawableAutoTiledSurface::updateTileRecBitmaps(QRect tileRect) {
 class SurfaceSaver : public TmpSaver {
     e_OBJECT
 public:
-    typedef std::function<void(const qsptr<QTemporaryFile>&)> Func;
+    typedef std::function<void(const stdsptr<CacheExtent>&)> Func;
 protected:
     SurfaceSaver(DrawableAutoTiledSurface* const target,
                  const AutoTiledSurface &surface) :
@@ -112,10 +125,10 @@ class SurfaceLoader : public TmpLoader {
 public:
     typedef std::function<void(AutoTiledSurface&&)> Func;
 protected:
-    SurfaceLoader(const qsptr<QTemporaryFile> &file,
+    SurfaceLoader(const stdsptr<CacheExtent> &data,
                   DrawableAutoTiledSurface* const target,
                   const Func& finishedFunc) :
-        TmpLoader(file, target),
+        TmpLoader(data, target),
         mFinishedFunc(finishedFunc) {}
 
     void read(eReadStream& src) {
@@ -130,6 +143,7 @@ private:
 };
 
 stdsptr<eHddTask> DrawableAutoTiledSurface::createTmpFileDataSaver() {
+    QMutexLocker lock(&mSurface.mutex());
     return enve::make_shared<SurfaceSaver>(this, std::move(mSurface));
 }
 
@@ -138,10 +152,13 @@ stdsptr<eHddTask> DrawableAutoTiledSurface::createTmpFileDataLoader() {
     const SurfaceLoader::Func func =
     [thisP](AutoTiledSurface&& surface) {
         if(thisP) {
-            thisP->mSurface = std::move(surface);
+            {
+                QMutexLocker lock(&thisP->mSurface.mutex());
+                thisP->mSurface = std::move(surface);
+            }
             thisP->updateTileBitmaps();
             thisP->afterDataLoadedFromTmpFile();
         }
     };
-    return enve::make_shared<SurfaceLoader>(mTmpFile, this, func);
+    return enve::make_shared<SurfaceLoader>(mTmpData, this, func);
 }
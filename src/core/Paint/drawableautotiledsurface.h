@@ -35,11 +35,14 @@ struct TileBitmaps {
         fZeroTileRow = src.fZeroTileRow;
         fZeroTileCol = src.fZeroTileCol;
         fBitmaps.clear();
+        // lists are not shared, so that updating tiles in parallel
+        // does not detach them, pixels are shared and a shared bitmap
+        // is replaced instead of being updated in place
         for(const auto& srcList : src.fBitmaps) {
             fBitmaps << QList<SkBitmap>();
             auto& list = fBitmaps.last();
             for(const auto& srcBitmap : srcList) {
-                list << SkiaHelpers::makeCopy(srcBitmap);
+                list << srcBitmap;
             }
         }
     }
@@ -151,15 +154,27 @@ public:
         drawOnCanvas(canvas, dst, nullptr, paint);
     }
 
+    //! @brief Paint target, lock surface().mutex() before reading it.
     const AutoTiledSurface &surface() const {
         return mSurface;
     }
 
+    SkBitmap surfaceBitmap() const {
+        QMutexLocker lock(&mSurface.mutex());
+        return mSurface.toBitmap();
+    }
+
+    QRect surfacePixelBoundingRect() const {
+        QMutexLocker lock(&mSurface.mutex());
+        return mSurface.pixelBoundingRect();
+    }
+
     void pixelRectChanged(const QRect& pixRect) {
-        if(mTmpFile) scheduleDeleteTmpFile();
+        if(mTmpData) scheduleDeleteTmpFile();
         updateTileRecBitmaps(pixRectToTileRect(pixRect));
     }
 
+    //! @brief Covers the tile bitmaps, does not touch the tile data.
     QRect pixelBoundingRect() const {
         return tileRectToPixRect(tileBoundingRect());
     }
@@ -174,13 +189,19 @@ public:
 
     void write(eWriteStream& dst) {
         if(!storesDataInMemory()) {
-            if(!mTmpFile) RuntimeThrow("No tmp file, and no data in memory");
-            dst.writeFile(mTmpFile.get());
-        } else mSurface.write(dst);
+            if(!mTmpData) RuntimeThrow("No tmp file, and no data in memory");
+            dst.write(mTmpData->data(), mTmpData->size());
+        } else {
+            QMutexLocker lock(&mSurface.mutex());
+            mSurface.write(dst);
+        }
     }
 
     void read(eReadStream& src) {
-        mSurface.read(src);
+        {
+            QMutexLocker lock(&mSurface.mutex());
+            mSurface.read(src);
+        }
         afterDataReplaced();
         updateTileBitmaps();
     }
@@ -17,6 +17,18 @@
 #include "painttarget.h"
 #include "canvas.h"
 
+PaintTarget::PaintTarget(Canvas * const canvas) : mCanvas(canvas) {
+    QObject::connect(&mStrokeWorker, &BrushStrokeWorker::changed,
+                     mCanvas, [this]() { publishChanges(); });
+}
+
+void PaintTarget::publishChanges() {
+    const QRect roi = mStrokeWorker.takeChangedRect();
+    if(roi.isEmpty() || !mPaintDrawable) return;
+    mPaintDrawable->pixelRectChanged(roi);
+    emit mCanvas->requestUpdate();
+}
+
 void PaintTarget::draw(SkCanvas * const canvas,
                        const QMatrix& viewTrans,
                        const QRect& drawRect,
@@ -34,6 +46,9 @@ void PaintTarget::draw(SkCanvas * const canvas,
 
 void PaintTarget::setPaintDrawable(DrawableAutoTiledSurface * const surf,
                                    const int frame) {
+    // the worker might still be painting on the previous drawable
+    mStrokeWorker.sync();
+    publishChanges();
     if(mPaintDrawable) {
         if(mChanged) {
             mPaintDrawable->drawingDoneForNow();
@@ -86,21 +101,22 @@ void PaintTarget::paintPress(const QPointF& pos,
                              const ulong ts, const qreal pressure,
                              const qreal xTilt, const qreal yTilt,
                              const SimpleBrushWrapper * const brush) {
+    // a new key copies the surface the worker is painting on
+    mStrokeWorker.sync();
     if(mPaintAnimSurface) {
         if(mPaintAnimSurface->anim_isRecording() &&
            !mPaintAnimSurface->anim_getKeyOnCurrentFrame())
             mPaintAnimSurface->anim_saveCurrentValueAsKey();
     }
 
-    if(mPaintDrawable && brush) {
+    // the gui can change the brush while the worker paints with it
+    mStrokeBrush = brush ? brush->createSnapshot() : nullptr;
+    if(mPaintDrawable && mStrokeBrush) {
         const auto& target = mPaintDrawable->surface();
         const auto pDrawTrans = mPaintDrawableBox->getTotalTransform();
         const auto drawPos = pDrawTrans.inverted().map(pos);
-        const auto roi =
-                target.paintPressEvent(brush->getBrush(),
-                                       drawPos, 1, pressure, xTilt, yTilt);
-        const QRect qRoi(roi.x, roi.y, roi.width, roi.height);
-        mPaintDrawable->pixelRectChanged(qRoi);
+        mStrokeWorker.strokePress(&target, mStrokeBrush,
+                                  drawPos, pressure, xTilt, yTilt);
         mLastTs = ts;
         mChanged = true;
     }
@@ -110,17 +126,14 @@ void PaintTarget::paintMove(const QPointF& pos,
                             const ulong ts, const qreal pressure,
                             const qreal xTilt, const qreal yTilt,
                             const SimpleBrushWrapper * const brush) {
-    if(mPaintDrawable && brush) {
+    if(mPaintDrawable && brush && mStrokeBrush) {
         const auto& target = mPaintDrawable->surface();
         const double dt = (ts - mLastTs);
         const auto pDrawTrans = mPaintDrawableBox->getTotalTransform();
         const auto drawPos = pDrawTrans.inverted().map(pos);
-        const auto roi =
-                target.paintMoveEvent(brush->getBrush(),
-                                      drawPos, dt/1000, pressure,
-                                      xTilt, yTilt);
-        const QRect qRoi(roi.x, roi.y, roi.width, roi.height);
-        mPaintDrawable->pixelRectChanged(qRoi);
+        mStrokeWorker.strokeMove(&target, mStrokeBrush,
+                                 drawPos, dt/1000, pressure,
+                                 xTilt, yTilt);
     }
     mLastTs = ts;
 }
@@ -23,9 +23,10 @@ class Canvas;
 #include "Boxes/paintbox.h"
 #include "onionskin.h"
 #include "CacheHandlers/usepointer.h"
+#include "brushstrokeworker.h"
 
 struct PaintTarget {
-    PaintTarget(Canvas* const canvas) : mCanvas(canvas) {}
+    PaintTarget(Canvas* const canvas);
 
     bool needsProcessing() const { return true; }
 
@@ -45,6 +46,7 @@ struct PaintTarget {
 
     void newEmptyFrame() {
         if(!isValid()) return;
+        mStrokeWorker.sync();
         mPaintAnimSurface->newEmptyFrame();
     }
 
@@ -72,6 +74,9 @@ struct PaintTarget {
         return mPaintDrawable->pixelBoundingRect();
     }
 
+    //! @brief Updates the tile bitmaps changed by the stroke worker.
+    void publishChanges();
+
     ulong mLastTs;
     int mLastFrame = 0;
     qptr<PaintBox> mPaintDrawableBox;
@@ -81,6 +86,9 @@ struct PaintTarget {
     UsePointer<DrawableAutoTiledSurface> mPaintDrawable;
     bool mChanged = false;
     Canvas * const mCanvas;
+    //! @brief Snapshot of the brush taken on press, used for the whole stroke
+    stdsptr<SimpleBrushWrapper> mStrokeBrush;
+    BrushStrokeWorker mStrokeWorker;
 };
 
 #endif // PAINTTARGET_H
@@ -28,7 +28,17 @@ SimpleBrushWrapper::~SimpleBrushWrapper() {
     mypaint_brush_unref(mBrush);
 }
 
-stdsptr<SimpleBrushWrapper> SimpleBrushWrapper::createDuplicate() {
+stdsptr<SimpleBrushWrapper> SimpleBrushWrapper::createSnapshot() const {
+    const auto result = createDuplicate();
+    if(!result) return nullptr;
+    for(int i = 0; i < MYPAINT_BRUSH_SETTINGS_COUNT; i++) {
+        const auto id = static_cast<MyPaintBrushSetting>(i);
+        result->setBaseValue(id, getBaseValue(id));
+    }
+    return result;
+}
+
+stdsptr<SimpleBrushWrapper> SimpleBrushWrapper::createDuplicate() const {
     auto brush = mypaint_brush_new();
     const char *data = mWholeFile.constData();
 
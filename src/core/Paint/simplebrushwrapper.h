@@ -26,7 +26,10 @@ class SimpleBrushWrapper : public StdSelfRef {
 public:
     ~SimpleBrushWrapper();
 
-    stdsptr<SimpleBrushWrapper> createDuplicate();
+    stdsptr<SimpleBrushWrapper> createDuplicate() const;
+    //! @brief Duplicate with the current base values (color, size, modes),
+    //! its dynamics state and random generator start fresh.
+    stdsptr<SimpleBrushWrapper> createSnapshot() const;
 
     MyPaintBrush * getBrush() const { return mBrush; }
 
@@ -0,0 +1,199 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cputaskpool.h"
+
+CpuTaskWorker::CpuTaskWorker(const int id, CpuTaskPool * const pool) :
+    QThread(pool), mId(id), mPool(pool) {}
+
+void CpuTaskWorker::run() {
+    while(!mPool->mQuit.load()) {
+        const quint64 epoch = mPool->workEpoch();
+        std::function<void()> job;
+        if(mPool->takeJob(job)) {
+            job();
+            continue;
+        }
+        const auto task = nextTask();
+        if(!task) {
+            mPool->waitForWork(mId, epoch);
+            continue;
+        }
+        try {
+            task->process();
+        } catch(...) {
+            task->setException(std::current_exception());
+        }
+        mPool->taskFinished(task);
+    }
+}
+
+eTask* CpuTaskWorker::nextTask() {
+    if(mId >= mPool->activeThreads()) return nullptr;
+    if(const auto task = mDeque.pop()) return task;
+    if(mPool->takeInjected(this)) {
+        if(const auto task = mDeque.pop()) return task;
+    }
+    return mPool->stealFor(mId);
+}
+
+CpuTaskPool::CpuTaskPool(const int nThreads, QObject * const parent) :
+    QObject(parent), mActiveWorkers(qMax(1, nThreads)) {
+    connect(this, &CpuTaskPool::finishedAvailable,
+            this, &CpuTaskPool::deliverFinished,
+            Qt::QueuedConnection);
+    for(int i = 0; i < qMax(1, nThreads); i++) {
+        const auto worker = new CpuTaskWorker(i, this);
+        mWorkers << worker;
+    }
+    for(const auto worker : mWorkers) worker->start();
+}
+
+CpuTaskPool::~CpuTaskPool() {
+    quit();
+    wait();
+}
+
+void CpuTaskPool::submit(const stdsptr<eTask>& task) {
+    mInFlight.insert(task.get(), task);
+    {
+        QMutexLocker lock(&mInjectedMutex);
+        mInjected << task.get();
+        mInjectedCount++;
+        signalWork(false);
+    }
+}
+
+bool CpuTaskPool::runOnIdle(const std::function<void()>& job) {
+    QMutexLocker lock(&mInjectedMutex);
+    if(mQuit.load()) return false;
+    // every queued job already claims one of the idle workers
+    if(mSleeping.load() <= mJobs.count()) return false;
+    mJobs << job;
+    mJobCount++;
+    signalWork(false);
+    return true;
+}
+
+void CpuTaskPool::setActiveThreads(const int nThreads) {
+    const int clamped = qBound(1, nThreads, mWorkers.count());
+    if(mActiveWorkers.load() == clamped) return;
+    QMutexLocker lock(&mInjectedMutex);
+    mActiveWorkers = clamped;
+    mActivated.wakeAll();
+    signalWork(true);
+}
+
+void CpuTaskPool::quit() {
+    mQuit = true;
+    QMutexLocker lock(&mInjectedMutex);
+    mActivated.wakeAll();
+    mWorkAvailable.wakeAll();
+}
+
+void CpuTaskPool::wait() {
+    for(const auto worker : mWorkers) worker->wait();
+}
+
+void CpuTaskPool::deliverFinished() {
+    QList<eTask*> finished;
+    {
+        QMutexLocker lock(&mFinishedMutex);
+        finished.swap(mFinished);
+    }
+    if(finished.isEmpty()) return;
+    QList<stdsptr<eTask>> tasks;
+    tasks.reserve(finished.count());
+    for(const auto task : finished) {
+        tasks << mInFlight.take(task);
+    }
+    emit finishedTasks(tasks);
+}
+
+void CpuTaskPool::taskFinished(eTask * const task) {
+    bool wasEmpty;
+    {
+        QMutexLocker lock(&mFinishedMutex);
+        wasEmpty = mFinished.isEmpty();
+        mFinished << task;
+    }
+    // a single queued call delivers everything finished until it runs
+    if(wasEmpty) emit finishedAvailable();
+}
+
+bool CpuTaskPool::takeInjected(CpuTaskWorker * const worker) {
+    if(mInjectedCount.load() == 0) return false;
+    QMutexLocker lock(&mInjectedMutex);
+    const int count = mInjected.count();
+    if(count == 0) return false;
+    // take a fair share, the rest of the workers will steal if needed
+    const int nTaken = qMax(1, count/activeThreads());
+    // pushed in reverse so that pop() follows the submission order
+    for(int i = nTaken - 1; i >= 0; i--) {
+        worker->push(mInjected.at(i));
+    }
+    mInjected.erase(mInjected.begin(), mInjected.begin() + nTaken);
+    mInjectedCount -= nTaken;
+    // tasks left in the injection list or in our deque can be taken
+    if(nTaken > 1 || !mInjected.isEmpty()) signalWork(true);
+    return true;
+}
+
+bool CpuTaskPool::takeJob(std::function<void()>& job) {
+    if(mJobCount.load() == 0) return false;
+    QMutexLocker lock(&mInjectedMutex);
+    if(mJobs.isEmpty()) return false;
+    job = mJobs.takeFirst();
+    mJobCount--;
+    return true;
+}
+
+eTask* CpuTaskPool::stealFor(const int thiefId) {
+    const int nWorkers = mWorkers.count();
+    bool retry = true;
+    while(retry) {
+        retry = false;
+        for(int i = 1; i < nWorkers; i++) {
+            const auto victim = mWorkers.at((thiefId + i) % nWorkers);
+            if(const auto task = victim->steal()) return task;
+            // lost a race with another thief or the owner
+            if(!victim->isEmpty()) retry = true;
+        }
+    }
+    return nullptr;
+}
+
+void CpuTaskPool::waitForWork(const int workerId, const quint64 epoch) {
+    QMutexLocker lock(&mInjectedMutex);
+    if(mQuit.load()) return;
+    if(workerId >= activeThreads()) {
+        mActivated.wait(&mInjectedMutex);
+        return;
+    }
+    // work signaled since the worker last looked for it
+    if(mWorkEpoch.load() != epoch) return;
+    if(!mInjected.isEmpty() || !mJobs.isEmpty()) return;
+    mSleeping++;
+    mWorkAvailable.wait(&mInjectedMutex);
+    mSleeping--;
+}
+
+void CpuTaskPool::signalWork(const bool all) {
+    mWorkEpoch++;
+    if(mSleeping == 0) return;
+    if(all) mWorkAvailable.wakeAll();
+    else mWorkAvailable.wakeOne();
+}
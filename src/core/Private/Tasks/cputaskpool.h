@@ -0,0 +1,122 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CPUTASKPOOL_H
+#define CPUTASKPOOL_H
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <atomic>
+#include <functional>
+#include "Tasks/updatable.h"
+#include "workstealingdeque.h"
+
+class CpuTaskPool;
+
+class CpuTaskWorker : public QThread {
+public:
+    CpuTaskWorker(const int id, CpuTaskPool * const pool);
+
+    //! @brief Pushes a task to this worker's deque, worker thread only.
+    void push(eTask * const task) { mDeque.push(task); }
+    eTask* steal() { return mDeque.steal(); }
+    bool isEmpty() const { return mDeque.isEmpty(); }
+protected:
+    void run() override;
+private:
+    eTask* nextTask();
+
+    const int mId;
+    CpuTaskPool * const mPool;
+    WorkStealingDeque<eTask*> mDeque;
+};
+
+//! @brief Pool of cpu worker threads with per-worker work-stealing deques.
+//! Tasks are submitted and finished tasks are delivered
+//! in batches on the thread owning the pool.
+class CpuTaskPool : public QObject {
+    Q_OBJECT
+    friend class CpuTaskWorker;
+public:
+    CpuTaskPool(const int nThreads, QObject * const parent = nullptr);
+    ~CpuTaskPool();
+
+    void submit(const stdsptr<eTask>& task);
+
+    int threadCount() const { return mWorkers.count(); }
+    int tasksInFlight() const { return mInFlight.count(); }
+    int busyThreads() const {
+        return qMin(tasksInFlight(), activeThreads());
+    }
+    //! @brief Active workers waiting for work, safe to call from any thread.
+    int idleThreads() const { return mSleeping.load(); }
+    //! @brief Hands the job to an idle worker, safe to call from any thread.
+    //! Returns false, without running the job, if no worker is idle.
+    //! Jobs run ahead of tasks and must not throw.
+    bool runOnIdle(const std::function<void()>& job);
+
+    //! @brief Limits the number of workers processing tasks.
+    void setActiveThreads(const int nThreads);
+    int activeThreads() const { return mActiveWorkers.load(); }
+
+    void quit();
+    void wait();
+signals:
+    void finishedTasks(const QList<stdsptr<eTask>>& tasks);
+    void finishedAvailable();
+private:
+    void deliverFinished();
+
+    //! @brief Called from worker threads.
+    void taskFinished(eTask * const task);
+    bool takeInjected(CpuTaskWorker * const worker);
+    bool takeJob(std::function<void()>& job);
+    eTask* stealFor(const int thiefId);
+    quint64 workEpoch() const { return mWorkEpoch.load(); }
+    //! @brief Sleeps until work is signaled after epoch was read.
+    void waitForWork(const int workerId, const quint64 epoch);
+    //! @brief Called with mInjectedMutex locked.
+    void signalWork(const bool all);
+
+    QList<CpuTaskWorker*> mWorkers;
+    QHash<eTask*, stdsptr<eTask>> mInFlight;
+
+    std::atomic<int> mActiveWorkers;
+    std::atomic<int> mInjectedCount{0};
+    std::atomic<bool> mQuit{false};
+    //! @brief Incremented, under mInjectedMutex, whenever work might
+    //! have become available, sleeping workers can not miss it
+    std::atomic<quint64> mWorkEpoch{0};
+
+    QMutex mInjectedMutex;
+    //! @brief Active workers sleeping on mWorkAvailable,
+    //! modified with mInjectedMutex locked
+    std::atomic<int> mSleeping{0};
+    QWaitCondition mWorkAvailable;
+    //! @brief Workers above the active thread limit sleep here
+    QWaitCondition mActivated;
+    QList<eTask*> mInjected;
+    //! @brief Jobs from runOnIdle, modified with mInjectedMutex locked
+    QList<std::function<void()>> mJobs;
+    std::atomic<int> mJobCount{0};
+
+    QMutex mFinishedMutex;
+    QList<eTask*> mFinished;
+};
+
+#endif // CPUTASKPOOL_H
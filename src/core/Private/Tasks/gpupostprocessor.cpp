@@ -27,6 +27,9 @@ GpuPostProcessor::GpuPostProcessor() {
 
 void GpuPostProcessor::initialize() {
     OffscreenQGL33c::initialize();
+    // fail here rather than on the processing thread
+    makeCurrent();
+    doneCurrent();
     moveContextToThread(this);
 }
 
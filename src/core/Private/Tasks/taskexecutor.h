@@ -98,12 +98,6 @@ private:
     QThread * const mExecutorThread;
 };
 
-class CpuExecController : public ExecController {
-public:
-    CpuExecController(QObject * const parent = nullptr) :
-        ExecController(new TaskExecutor, parent) {}
-};
-
 class HddExecController : public ExecController {
     Q_OBJECT
 public:
@@ -16,6 +16,7 @@
 
 #include "taskque.h"
 #include "Private/esettings.h"
+#include "taskscheduler.h"
 
 TaskQue::TaskQue() {}
 
@@ -34,6 +35,10 @@ int TaskQue::countQued() const {
 bool TaskQue::allDone() const { return countQued() == 0; }
 
 void TaskQue::addTask(const stdsptr<eTask> &task) {
+    if(!TaskScheduler::sGpuAvailable()) {
+        mCpuOnly << task;
+        return;
+    }
     const auto hwSupport = task->hardwareSupport();
     switch(eSettings::sInstance->fAccPreference) {
         case AccPreference::gpuStrongPreference:
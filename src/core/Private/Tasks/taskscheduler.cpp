@@ -19,6 +19,7 @@
 #include "gpupostprocessor.h"
 #include "canvas.h"
 #include "taskexecutor.h"
+#include "cputaskpool.h"
 #include "../document.h"
 #include <QThread>
 
@@ -28,14 +29,9 @@ TaskScheduler::TaskScheduler() {
     Q_ASSERT(!sInstance);
     sInstance = this;
     const int numberThreads = qMax(1, QThread::idealThreadCount());
-    for(int i = 0; i < numberThreads; i++) {
-        const auto taskExecutor = new CpuExecController(this);
-        connect(taskExecutor, &ExecController::finishedTaskSignal,
-                this, &TaskScheduler::afterCpuTaskFinished);
-
-        mCpuExecutors << taskExecutor;
-        mFreeCpuExecs << taskExecutor;
-    }
+    mCpuPool = new CpuTaskPool(numberThreads, this);
+    connect(mCpuPool, &CpuTaskPool::finishedTasks,
+            this, &TaskScheduler::afterCpuTasksFinished);
 
     mHddExecutor = new HddExecController;
     mHddExecs << mHddExecutor;
@@ -48,10 +44,8 @@ TaskScheduler::TaskScheduler() {
 }
 
 TaskScheduler::~TaskScheduler() {
-    for(const auto& exec : mCpuExecutors) {
-        exec->quit();
-        exec->wait();
-    }
+    mCpuPool->quit();
+    mCpuPool->wait();
     for(const auto& exec : mHddExecs) {
         exec->quit();
         exec->wait();
@@ -61,6 +55,7 @@ TaskScheduler::~TaskScheduler() {
 void TaskScheduler::initializeGpu() {
     try {
         mGpuPostProcessor.initialize();
+        mGpuAvailable = true;
     } catch(...) {
         RuntimeThrow("Failed to initialize gpu for post-processing.");
     }
@@ -87,10 +82,38 @@ void TaskScheduler::queCpuTask(const stdsptr<eTask>& task) {
 
 bool TaskScheduler::overflowed() const {
     const int nQues = mQuedCpuTasks.countQues();
-    const int maxQues = mCpuExecutors.count();
+    const int maxQues = cpuThreadCount();
     return nQues >= maxQues;
 }
 
+int TaskScheduler::busyCpuThreads() const {
+    return mCpuPool->busyThreads();
+}
+
+int TaskScheduler::idleCpuThreads() const {
+    return mCpuPool->idleThreads();
+}
+
+bool TaskScheduler::runOnIdleCpuThread(const std::function<void()>& job) {
+    return mCpuPool->runOnIdle(job);
+}
+
+int TaskScheduler::cpuThreadCount() const {
+    const int cap = eSettings::sInstance->fCpuThreadsCap;
+    const int all = mCpuPool->threadCount();
+    if(cap > 0) return qMin(cap, all);
+    return all;
+}
+
+// keeps worker deques populated so that idle workers have something to steal
+// without handing the whole que over before gpu tasks can be picked
+static const int sTasksInFlightPerThread = 4;
+
+int TaskScheduler::availableCpuThreads() const {
+    const int window = cpuThreadCount()*sTasksInFlightPerThread;
+    return qMax(0, window - mCpuPool->tasksInFlight());
+}
+
 bool TaskScheduler::shouldQueMoreCpuTasks() const {
     return availableCpuThreads() > 0 && !mCpuQueing && !overflowed();
 }
@@ -161,7 +184,11 @@ void TaskScheduler::afterHddTaskFinished(const stdsptr<eTask>& finishedTask,
         const auto hddExec = static_cast<HddExecController*>(controller);
         mFreeBackupHddExecs << hddExec;
     }
-    finishedTask->finishedProcessing();
+    // long hdd tasks re-queue in steps to let the other tasks through
+    const bool nextStep = !finishedTask->waitingToCancel() &&
+                          finishedTask->nextStep();
+    if(nextStep) finishedTask->queTaskNow();
+    else finishedTask->finishedProcessing();
     processNextTasks();
     if(!hddTaskBeingProcessed()) queTasks();
     callAllTasksFinishedFunc();
@@ -198,6 +225,7 @@ void TaskScheduler::processNextTasks() {
 }
 
 bool TaskScheduler::processNextQuedGpuTask() {
+    if(!mGpuAvailable) return false;
     if(!mGpuPostProcessor.allDone()) return false;
     const auto task = mQuedCpuTasks.takeQuedForGpuProcessing();
     if(task) {
@@ -206,7 +234,7 @@ bool TaskScheduler::processNextQuedGpuTask() {
             processNextTasks();
             return true;
         }
-        const int additional = mQuedCpuTasks.taskCount()/(mCpuExecutors.count()*10);
+        const int additional = mQuedCpuTasks.taskCount()/(cpuThreadCount()*10);
         scheduleGpuTask(task);
         for(int i = 0; i < additional; i++) {
             const auto iTask = mQuedCpuTasks.takeQuedForGpuProcessing();
@@ -220,12 +248,14 @@ bool TaskScheduler::processNextQuedGpuTask() {
     return task.get();
 }
 
-void TaskScheduler::afterCpuTaskFinished(const stdsptr<eTask>& task,
-                                         ExecController * const controller) {
-    mFreeCpuExecs << static_cast<CpuExecController*>(controller);
+void TaskScheduler::afterCpuTaskFinished(const stdsptr<eTask>& task) {
     const bool nextStep = !task->waitingToCancel() && task->nextStep();
-    if(nextStep) queCpuTask(task);
+    if(nextStep) task->queTaskNow();
     else task->finishedProcessing();
+}
+
+void TaskScheduler::afterCpuTasksFinished(const QList<stdsptr<eTask>>& tasks) {
+    for(const auto& task : tasks) afterCpuTaskFinished(task);
     afterCpuGpuTaskFinished();
 }
 
@@ -236,24 +266,15 @@ void TaskScheduler::afterCpuGpuTaskFinished() {
 }
 
 void TaskScheduler::processNextQuedCpuTask() {
-    const int additional = mQuedCpuTasks.taskCount()/(mCpuExecutors.count()*4);
+    mCpuPool->setActiveThreads(cpuThreadCount());
     while(availableCpuThreads() > 0 && !mQuedCpuTasks.isEmpty()) {
         const auto task = mQuedCpuTasks.takeQuedForCpuProcessing();
-        if(task) {
-            task->aboutToProcess(Hardware::cpu);
-            if(task->getState() > eTaskState::processing) {
-                return processNextTasks();
-            }
-            const auto executor = mFreeCpuExecs.takeLast();
-            executor->processTask(task);
-            for(int i = 0; i < additional; i++) {
-                const auto iTask = mQuedCpuTasks.takeQuedForCpuProcessing();
-                if(!iTask) break;
-                iTask->aboutToProcess(Hardware::cpu);
-                if(iTask->getState() > eTaskState::processing) continue;
-                executor->processTask(iTask);
-            }
-        } else break;
+        if(!task) break;
+        task->aboutToProcess(Hardware::cpu);
+        if(task->getState() > eTaskState::processing) {
+            return processNextTasks();
+        }
+        mCpuPool->submit(task);
     }
 
     emit cpuUsageChanged(busyCpuThreads());
@@ -22,7 +22,7 @@
 #include "taskquehandler.h"
 #include "Private/esettings.h"
 class Canvas;
-class CpuExecController;
+class CpuTaskPool;
 class HddExecController;
 class ExecController;
 
@@ -71,7 +71,12 @@ public:
         sInstance->clearTasks();
     }
 
+    //! @brief Throws if the gpu can not be used,
+    //! all tasks are then processed on the cpu.
     void initializeGpu();
+    static bool sGpuAvailable() {
+        return sInstance && sInstance->mGpuAvailable;
+    }
 
     void queTasks();
     void queHddTask(const stdsptr<eTask>& task);
@@ -96,8 +101,8 @@ public:
     void afterHddTaskFinished(const stdsptr<eTask>& finishedTask,
                               ExecController * const controller);
 
-    void afterCpuTaskFinished(const stdsptr<eTask>& task,
-                              ExecController * const controller);
+    void afterCpuTaskFinished(const stdsptr<eTask>& task);
+    void afterCpuTasksFinished(const QList<stdsptr<eTask>>& tasks);
 
     void setFreeThreadsForCpuTasksAvailableFunc(
             const std::function<void(void)>& func) {
@@ -142,16 +147,16 @@ public:
         return totalThreads - freeBackup - freeMain;
     }
 
-    int busyCpuThreads() const {
-        return mCpuExecutors.count() - mFreeCpuExecs.count();
-    }
-
-    int availableCpuThreads() const {
-        const int cap = eSettings::sInstance->fCpuThreadsCap;
-        if(cap > 0) return qMin(mFreeCpuExecs.count(),
-                                cap - mCpuExecutors.count());
-        return mFreeCpuExecs.count();
-    }
+    int busyCpuThreads() const;
+    int cpuThreadCount() const;
+    //! @brief Cpu pool workers waiting for work,
+    //! safe to call from any thread.
+    int idleCpuThreads() const;
+    //! @brief Runs the job on an idle cpu pool worker, if there is one,
+    //! safe to call from any thread.
+    bool runOnIdleCpuThread(const std::function<void()>& job);
+    //! @brief Returns how many more tasks can be handed to the cpu pool.
+    int availableCpuThreads() const;
 
     void afterCpuGpuTaskFinished();
 
@@ -193,6 +198,7 @@ private:
         }
     }
 
+    bool mGpuAvailable = false;
     bool mHddThreadBusy = false;
 
     bool mAlwaysQue = false;
@@ -207,8 +213,7 @@ private:
     QList<HddExecController*> mFreeBackupHddExecs;
     QList<HddExecController*> mHddExecs;
 
-    QList<CpuExecController*> mFreeCpuExecs;
-    QList<CpuExecController*> mCpuExecutors;
+    CpuTaskPool* mCpuPool = nullptr;
 
     std::function<void(void)> mFreeThreadsForCpuTasksAvailableFunc;
     std::function<void(void)> mAllTasksFinishedFunc;
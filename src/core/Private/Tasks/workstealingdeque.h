@@ -0,0 +1,136 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+//! @brief Lock-free Chase-Lev deque.
+//! Only the owning thread may push() and pop(),
+//! any thread may steal() from the opposite end.
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_pointer<T>::value,
+                  "WorkStealingDeque stores pointers only");
+
+    class Array {
+    public:
+        Array(const int64_t capacity) :
+            mCapacity(capacity), mMask(capacity - 1),
+            mData(new std::atomic<T>[static_cast<size_t>(capacity)]) {}
+
+        int64_t capacity() const { return mCapacity; }
+
+        T get(const int64_t i) const {
+            return mData[i & mMask].load(std::memory_order_relaxed);
+        }
+
+        void put(const int64_t i, const T value) {
+            mData[i & mMask].store(value, std::memory_order_relaxed);
+        }
+
+        Array* grow(const int64_t bottom, const int64_t top) const {
+            const auto result = new Array(2*mCapacity);
+            for(int64_t i = top; i != bottom; i++) result->put(i, get(i));
+            return result;
+        }
+    private:
+        const int64_t mCapacity;
+        const int64_t mMask;
+        const std::unique_ptr<std::atomic<T>[]> mData;
+    };
+public:
+    WorkStealingDeque(const int64_t capacity = 256) :
+        mTop(0), mBottom(0), mArray(new Array(capacity)) {
+        mGarbage.emplace_back(mArray.load(std::memory_order_relaxed));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    bool isEmpty() const {
+        const auto b = mBottom.load(std::memory_order_relaxed);
+        const auto t = mTop.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+    //! @brief Owner only.
+    void push(const T value) {
+        const auto b = mBottom.load(std::memory_order_relaxed);
+        const auto t = mTop.load(std::memory_order_acquire);
+        auto a = mArray.load(std::memory_order_relaxed);
+        if(b - t > a->capacity() - 1) {
+            a = a->grow(b, t);
+            // old arrays might still be read by thieves,
+            // they are released together with the deque
+            mGarbage.emplace_back(a);
+            mArray.store(a, std::memory_order_release);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    //! @brief Owner only. Returns nullptr if empty.
+    T pop() {
+        const auto b = mBottom.load(std::memory_order_relaxed) - 1;
+        const auto a = mArray.load(std::memory_order_relaxed);
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = mTop.load(std::memory_order_relaxed);
+        if(t > b) {
+            mBottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T value = a->get(b);
+        if(t == b) {
+            if(!mTop.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed)) {
+                value = nullptr;
+            }
+            mBottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    //! @brief Any thread. Returns nullptr if empty or lost a race.
+    T steal() {
+        auto t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = mBottom.load(std::memory_order_acquire);
+        if(t >= b) return nullptr;
+        const auto a = mArray.load(std::memory_order_acquire);
+        const T value = a->get(t);
+        if(!mTop.compare_exchange_strong(t, t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return value;
+    }
+private:
+    alignas(64) std::atomic<int64_t> mTop;
+    alignas(64) std::atomic<int64_t> mBottom;
+    alignas(64) std::atomic<Array*> mArray;
+    std::vector<std::unique_ptr<Array>> mGarbage;
+};
+
+#endif // WORKSTEALINGDEQUE_H
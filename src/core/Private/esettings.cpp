@@ -32,6 +32,12 @@ int eSettings::sCpuThreadsCapped() {
     return sInstance->fCpuThreads;
 }
 
+int eSettings::sOutputFramesInFlight() {
+    if(sInstance->fOutputFramesInFlight > 0)
+        return sInstance->fOutputFramesInFlight;
+    return qMax(2, sCpuThreadsCapped()/2);
+}
+
 intMB eSettings::sRamMBCap() {
     if(sInstance->fRamMBCap.fValue > 0) return sInstance->fRamMBCap;
     auto mbTot = intMB(sInstance->fRamKB);
@@ -49,6 +55,7 @@ QString eSettings::sIconsDir() {
 
 void eSettings::loadDefaults() {
     fCpuThreadsCap = 0;
+    fOutputFramesInFlight = 0;
     fRamMBCap = intMB(0);
     fAccPreference = AccPreference::defaultPreference;
     fPathGpuAcc = fGpuVendor != GpuVendor::nvidia;
@@ -79,6 +86,9 @@ void eSettings::loadFromFile() {
         if(setting == "cpuThreadsCap") {
             const int cpuThreadsCap = value.toInt(&ok);
             if(ok) fCpuThreads = cpuThreadsCap;
+        } else if(setting == "outputFramesInFlight") {
+            const int framesInFlight = value.toInt(&ok);
+            if(ok) fOutputFramesInFlight = framesInFlight;
         } else if(setting == "ramMBCap") {
             const int ramMBCap = value.toInt(&ok);
             if(ok) fRamMBCap = intMB(ramMBCap);
@@ -115,6 +125,7 @@ void eSettings::saveToFile() {
     QTextStream textStream(&file);
 
     textStream << "cpuThreadsCap: " << fCpuThreadsCap << endl;
+    textStream << "outputFramesInFlight: " << fOutputFramesInFlight << endl;
     textStream << "ramMBCap: " << fRamMBCap.fValue << endl;
 
     textStream << "accPreference: " << static_cast<int>(fAccPreference) << endl;
@@ -43,6 +43,7 @@ public:
     // accessors
     static intMB sRamMBCap();
     static int sCpuThreadsCapped();
+    static int sOutputFramesInFlight();
     static const QString& sSettingsDir();
     static QString sIconsDir();
     static eSettings* sInstance;
@@ -61,6 +62,7 @@ public:
     // performance settings
     int fCpuThreads = 0;
     int fCpuThreadsCap = 0; // <= 0 - use all available threads
+    int fOutputFramesInFlight = 0; // <= 0 - derive from the number of threads
 
     intKB fRamKB = intKB(0);
     intMB fRamMBCap = intMB(0); // <= 0 - cap at 80 %
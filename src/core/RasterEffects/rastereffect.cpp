@@ -17,6 +17,7 @@
 #include "rastereffect.h"
 #include "Animators/dynamiccomplexanimator.h"
 #include "typemenu.h"
+#include "Private/Tasks/taskscheduler.h"
 
 RasterEffect::RasterEffect(const QString &name,
                            const HardwareSupport hwSupport,
@@ -36,6 +37,14 @@ RasterEffect::RasterEffect(const QString &name,
     } else Q_ASSERT(false);
 }
 
+HardwareSupport RasterEffect::instanceHwSupport() const {
+    if(mTypeHwSupport != HardwareSupport::gpuOnly &&
+       !TaskScheduler::sGpuAvailable()) {
+        return HardwareSupport::cpuOnly;
+    }
+    return mInstHwSupport;
+}
+
 void RasterEffect::writeIdentifier(eWriteStream &dst) const {
     dst.write(&mType, sizeof(RasterEffectType));
 }
@@ -51,9 +51,7 @@ public:
 
     QMimeData *SWT_createMimeData() final;
 
-    HardwareSupport instanceHwSupport() const {
-        return mInstHwSupport;
-    }
+    HardwareSupport instanceHwSupport() const;
 
     void switchInstanceHwSupport() {
         if(mTypeHwSupport == HardwareSupport::cpuOnly) return;
@@ -37,6 +37,16 @@ void ShaderEffect::writeIdentifier(eWriteStream& dst) const {
 stdsptr<RasterEffectCaller> ShaderEffect::getEffectCaller(
         const qreal relFrame, const qreal resolution) const {
     const auto effect = enve::make_shared<ShaderEffectCaller>(*mProgram);
+    if(mProgram->fScriptsCompiled) {
+        const int argsCount = mProgram->fPropUniCreators.count();
+        for(int i = 0; i < argsCount; i++) {
+            const auto prop = ca_getChildAt(i);
+            const auto& uniformC = mProgram->fPropUniCreators.at(i);
+            effect->setPropertyValue(i, uniformC->value(prop, relFrame,
+                                                        resolution));
+        }
+        return effect;
+    }
     QJSEngine& engine = effect->getJSEngine();
 
     UniformSpecifiers& uniformSpecifiers = effect->mUniformSpecifiers;
@@ -18,7 +18,12 @@
 
 ShaderEffectCaller::ShaderEffectCaller(const ShaderEffectProgram &program) :
     RasterEffectCaller(HardwareSupport::gpuOnly, false, QMargins()),
-    mProgram(program) {}
+    mSlots(program.fSlotCount), mProgram(program) {}
+
+QJSEngine& ShaderEffectCaller::getJSEngine() {
+    if(!mEngine) mEngine = std::make_unique<QJSEngine>();
+    return *mEngine;
+}
 
 void ShaderEffectCaller::processGpu(QGL33 * const gl,
                                     GpuRenderTools &renderTools,
@@ -28,7 +33,8 @@ void ShaderEffectCaller::processGpu(QGL33 * const gl,
     renderTools.requestTargetFbo().bind(gl);
     gl->glClear(GL_COLOR_BUFFER_BIT);
 
-    setupProgram(gl, data.fJSEngine, data);
+    if(mProgram.fScriptsCompiled) setupCompiledProgram(gl, data);
+    else setupProgram(gl, data.jsEngine(), data);
 
     gl->glActiveTexture(GL_TEXTURE0);
     renderTools.getSrcTexture().bind(gl);
@@ -40,10 +46,69 @@ void ShaderEffectCaller::processGpu(QGL33 * const gl,
 }
 
 QMargins ShaderEffectCaller::getMargin(const SkIRect &srcRect) {
-    mEngine.evaluate("eTexSize = [" + QString::number(srcRect.width()) + "," +
+    if(mProgram.fScriptsCompiled) return getCompiledMargin(srcRect);
+    return getJSMargin(srcRect);
+}
+
+QMargins ShaderEffectCaller::getCompiledMargin(const SkIRect &srcRect) {
+    if(!mProgram.fMarginExpr) return QMargins();
+    auto& texSize = mSlots[ShaderSymbols::sTexSizeSlot];
+    texSize.fSize = 2;
+    texSize.fV[0] = srcRect.width();
+    texSize.fV[1] = srcRect.height();
+    evaluateValues(nullptr);
+    const auto val = mProgram.fMarginExpr->evaluate(mSlots);
+    if(val.fSize == 1) return QMargins() + qCeil(val.fV[0]);
+    if(val.fSize == 2) {
+        const int valX = qCeil(val.fV[0]);
+        const int valY = qCeil(val.fV[1]);
+        return QMargins(valX, valY, valX, valY);
+    }
+    return QMargins(qCeil(val.fV[0]), qCeil(val.fV[1]),
+                    qCeil(val.fV[2]), qCeil(val.fV[3]));
+}
+
+void ShaderEffectCaller::evaluateValues(QGL33 * const gl) {
+    const int valsCount = mProgram.fValueExprs.count();
+    for(int i = 0; i < valsCount; i++) {
+        const auto val = mProgram.fValueExprs.at(i)->evaluate(mSlots);
+        mSlots[mProgram.valueSlot(i)] = val;
+        if(!gl) continue;
+        const GLint loc = mProgram.fValueLocs.at(i);
+        if(loc < 0) continue;
+        mProgram.fValueHandlers.at(i)->setUniform(gl, loc, val);
+    }
+}
+
+void ShaderEffectCaller::setupCompiledProgram(QGL33 * const gl,
+                                              const GpuRenderData &data) {
+    gl->glUseProgram(mProgram.fId);
+    const int propsCount = mProgram.fPropUniLocs.count();
+    for(int i = 0; i < propsCount; i++) {
+        const GLint loc = mProgram.fPropUniLocs.at(i);
+        if(loc < 0) continue;
+        const qreal val = mSlots.at(ShaderEffectProgram::sPropSlot(i)).fV[0];
+        mProgram.fPropUniCreators.at(i)->setUniform(gl, loc, val);
+    }
+    auto& texSize = mSlots[ShaderSymbols::sTexSizeSlot];
+    texSize.fSize = 2;
+    texSize.fV[0] = data.fWidth;
+    texSize.fV[1] = data.fHeight;
+    auto& globalPos = mSlots[ShaderSymbols::sGlobalPosSlot];
+    globalPos.fSize = 2;
+    globalPos.fV[0] = data.fPosX;
+    globalPos.fV[1] = data.fPosY;
+    evaluateValues(gl);
+    if(mProgram.fGPosLoc >= 0)
+        gl->glUniform2f(mProgram.fGPosLoc, data.fPosX, data.fPosY);
+}
+
+QMargins ShaderEffectCaller::getJSMargin(const SkIRect &srcRect) {
+    auto& engine = getJSEngine();
+    engine.evaluate("eTexSize = [" + QString::number(srcRect.width()) + "," +
                                       QString::number(srcRect.height()) + "]");
     if(!mProgram.fMarginScript.isEmpty()) {
-        const auto jsVal = mEngine.evaluate(mProgram.fMarginScript);
+        const auto jsVal = engine.evaluate(mProgram.fMarginScript);
         if(jsVal.isNumber()) {
             return QMargins() + qCeil(jsVal.toNumber());
         } else if(jsVal.isArray()) {
@@ -29,8 +29,12 @@ public:
                     GpuRenderTools& renderTools,
                     GpuRenderData& data);
 
-    QJSEngine& getJSEngine()
-    { return mEngine; }
+    //! @brief Only used if the program scripts could not be compiled
+    QJSEngine& getJSEngine();
+
+    void setPropertyValue(const int prop, const qreal value) {
+        mSlots[ShaderEffectProgram::sPropSlot(prop)].fV[0] = value;
+    }
 
     UniformSpecifiers mUniformSpecifiers;
 protected:
@@ -39,8 +43,14 @@ private:
     void setupProgram(QGL33 * const gl,
                       QJSEngine& mEngine,
                       const GpuRenderData &data);
-
-    QJSEngine mEngine;
+    void setupCompiledProgram(QGL33 * const gl,
+                              const GpuRenderData &data);
+    QMargins getJSMargin(const SkIRect &srcRect);
+    QMargins getCompiledMargin(const SkIRect &srcRect);
+    void evaluateValues(QGL33 * const gl);
+
+    std::unique_ptr<QJSEngine> mEngine;
+    ShaderSlots mSlots;
     const ShaderEffectProgram mProgram;
 };
 
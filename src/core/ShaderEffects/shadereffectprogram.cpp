@@ -65,5 +65,31 @@ ShaderEffectProgram ShaderEffectProgram::sCreateProgram(
     gl->glUniform1i(program.fTexLocation, 0);
 
     program.fMarginScript = marginScript;
+    program.compileScripts(propCs);
     return program;
 }
+
+void ShaderEffectProgram::compileScripts(
+        const QList<stdsptr<ShaderPropertyCreator>>& propCs) {
+    fScriptsCompiled = false;
+    fMarginExpr.reset();
+    fValueExprs.clear();
+
+    ShaderSymbols symbols;
+    for(const auto& propC : propCs) symbols.add(propC->fName, 1);
+    for(const auto& value : fValueHandlers) {
+        // a value may refer to the values preceding it
+        const auto expr = ShaderExpression::sCompile(value->script(), symbols);
+        if(!expr || !value->acceptsSize(expr->resultSize())) return;
+        fValueExprs << expr;
+        symbols.add(value->fName, expr->resultSize());
+    }
+    if(!fMarginScript.isEmpty()) {
+        fMarginExpr = ShaderExpression::sCompile(fMarginScript, symbols);
+        if(!fMarginExpr) return;
+        const int size = fMarginExpr->resultSize();
+        if(size != 1 && size != 2 && size != 4) return;
+    }
+    fSlotCount = symbols.count();
+    fScriptsCompiled = true;
+}
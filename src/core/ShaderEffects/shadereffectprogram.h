@@ -18,6 +18,7 @@
 #define SHADEREFFECTPROGRAM_H
 #include "uniformspecifiercreator.h"
 #include "shadervaluehandler.h"
+#include "shaderexpression.h"
 
 typedef QList<stdsptr<UniformSpecifierCreator>> UniformSpecifierCreators;
 struct ShaderEffectProgram {
@@ -31,12 +32,29 @@ struct ShaderEffectProgram {
     QList<GLint> fValueLocs;
     QString fMarginScript;
 
+    //! @brief False if any script needs QJSEngine,
+    //! the expressions below are unused in that case
+    bool fScriptsCompiled = false;
+    int fSlotCount = 0;
+    stdsptr<ShaderExpression> fMarginExpr;
+    QList<stdsptr<ShaderExpression>> fValueExprs;
+
+    //! @brief Slot holding the value of the property at index
+    static int sPropSlot(const int prop) {
+        return ShaderSymbols::sGlobalPosSlot + 1 + prop;
+    }
+    int valueSlot(const int value) const {
+        return sPropSlot(fPropUniLocs.count()) + value;
+    }
+
     static ShaderEffectProgram sCreateProgram(
             QGL33 * const gl, const QString &fragPath,
             const QString& marginScript,
             const QList<stdsptr<ShaderPropertyCreator>>& propCs,
             const UniformSpecifierCreators& uniCs,
             const QList<stdsptr<ShaderValueHandler>>& values);
+private:
+    void compileScripts(const QList<stdsptr<ShaderPropertyCreator>>& propCs);
 };
 
 #endif // SHADEREFFECTPROGRAM_H
@@ -0,0 +1,493 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shaderexpression.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+ShaderSymbols::ShaderSymbols() {
+    add("eTexSize", 2);
+    add("eGlobalPos", 2);
+}
+
+int ShaderSymbols::add(const QString& name, const int size) {
+    mNames << name;
+    mSizes << size;
+    return mNames.count() - 1;
+}
+
+int ShaderSymbols::slot(const QString& name) const {
+    // later definitions shadow earlier ones, as with repeated assignments
+    return mNames.lastIndexOf(name);
+}
+
+static const qreal sNaN = std::numeric_limits<qreal>::quiet_NaN();
+
+static inline bool truthy(const qreal val) {
+    return val != 0 && !std::isnan(val);
+}
+
+static inline ShaderVec scalar(const qreal val) {
+    ShaderVec result;
+    result.fV[0] = val;
+    return result;
+}
+
+class ShaderExpression::Node {
+public:
+    Node(const int size) : fSize(size) {}
+    virtual ~Node() {}
+    virtual ShaderVec evaluate(const ShaderSlots& slots) const = 0;
+    qreal scalarValue(const ShaderSlots& slots) const {
+        return evaluate(slots).fV[0];
+    }
+    const int fSize;
+};
+
+typedef std::unique_ptr<ShaderExpression::Node> NodePtr;
+
+namespace {
+    class NumberNode : public ShaderExpression::Node {
+    public:
+        NumberNode(const qreal val) : Node(1), mVal(val) {}
+        ShaderVec evaluate(const ShaderSlots&) const {
+            return scalar(mVal);
+        }
+    private:
+        const qreal mVal;
+    };
+
+    class SlotNode : public ShaderExpression::Node {
+    public:
+        SlotNode(const int slot, const int size) :
+            Node(size), mSlot(slot) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            return slots.at(mSlot);
+        }
+    private:
+        const int mSlot;
+    };
+
+    class ArrayNode : public ShaderExpression::Node {
+    public:
+        ArrayNode(std::vector<NodePtr>&& items) :
+            Node(static_cast<int>(items.size())), mItems(std::move(items)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            ShaderVec result;
+            result.fSize = fSize;
+            for(int i = 0; i < fSize; i++)
+                result.fV[i] = mItems[static_cast<size_t>(i)]->scalarValue(slots);
+            return result;
+        }
+    private:
+        const std::vector<NodePtr> mItems;
+    };
+
+    class IndexNode : public ShaderExpression::Node {
+    public:
+        IndexNode(NodePtr&& array, NodePtr&& index) :
+            Node(1), mArray(std::move(array)), mIndex(std::move(index)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            const auto array = mArray->evaluate(slots);
+            const qreal index = mIndex->scalarValue(slots);
+            const int i = static_cast<int>(index);
+            // out of bounds is undefined, NaN in arithmetic
+            if(i != index || i < 0 || i >= array.fSize) return scalar(sNaN);
+            return scalar(array.fV[i]);
+        }
+    private:
+        const NodePtr mArray;
+        const NodePtr mIndex;
+    };
+
+    class UnaryNode : public ShaderExpression::Node {
+    public:
+        UnaryNode(const char op, NodePtr&& arg) :
+            Node(1), mOp(op), mArg(std::move(arg)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            const qreal val = mArg->scalarValue(slots);
+            switch(mOp) {
+            case '-': return scalar(-val);
+            case '!': return scalar(truthy(val) ? 0 : 1);
+            default: return scalar(val);
+            }
+        }
+    private:
+        const char mOp;
+        const NodePtr mArg;
+    };
+
+    enum class BinaryOp {
+        add, sub, mul, div, mod,
+        less, greater, lessEq, greaterEq, equal, notEqual,
+        logicalAnd, logicalOr
+    };
+
+    class BinaryNode : public ShaderExpression::Node {
+    public:
+        BinaryNode(const BinaryOp op, NodePtr&& a, NodePtr&& b) :
+            Node(1), mOp(op), mA(std::move(a)), mB(std::move(b)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            const qreal a = mA->scalarValue(slots);
+            // short-circuit like JavaScript, returning an operand
+            if(mOp == BinaryOp::logicalAnd)
+                return truthy(a) ? mB->evaluate(slots) : scalar(a);
+            if(mOp == BinaryOp::logicalOr)
+                return truthy(a) ? scalar(a) : mB->evaluate(slots);
+            const qreal b = mB->scalarValue(slots);
+            switch(mOp) {
+            case BinaryOp::add: return scalar(a + b);
+            case BinaryOp::sub: return scalar(a - b);
+            case BinaryOp::mul: return scalar(a*b);
+            case BinaryOp::div: return scalar(a/b);
+            case BinaryOp::mod: return scalar(std::fmod(a, b));
+            case BinaryOp::less: return scalar(a < b);
+            case BinaryOp::greater: return scalar(a > b);
+            case BinaryOp::lessEq: return scalar(a <= b);
+            case BinaryOp::greaterEq: return scalar(a >= b);
+            case BinaryOp::equal: return scalar(a == b);
+            case BinaryOp::notEqual: return scalar(a != b);
+            default: return scalar(sNaN);
+            }
+        }
+    private:
+        const BinaryOp mOp;
+        const NodePtr mA;
+        const NodePtr mB;
+    };
+
+    class TernaryNode : public ShaderExpression::Node {
+    public:
+        TernaryNode(NodePtr&& cond, NodePtr&& a, NodePtr&& b) :
+            Node(a->fSize), mCond(std::move(cond)),
+            mA(std::move(a)), mB(std::move(b)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            if(truthy(mCond->scalarValue(slots))) return mA->evaluate(slots);
+            return mB->evaluate(slots);
+        }
+    private:
+        const NodePtr mCond;
+        const NodePtr mA;
+        const NodePtr mB;
+    };
+
+    typedef qreal (*MathFunc)(const qreal* args, const int nArgs);
+
+    struct MathFuncDef {
+        const char* fName;
+        int fMinArgs;
+        int fMaxArgs;
+        MathFunc fFunc;
+    };
+
+    qreal jsRound(const qreal val) { return std::floor(val + 0.5); }
+
+    const MathFuncDef sMathFuncs[] = {
+        {"abs", 1, 1, [](const qreal* a, int) { return std::abs(a[0]); }},
+        {"acos", 1, 1, [](const qreal* a, int) { return std::acos(a[0]); }},
+        {"asin", 1, 1, [](const qreal* a, int) { return std::asin(a[0]); }},
+        {"atan", 1, 1, [](const qreal* a, int) { return std::atan(a[0]); }},
+        {"atan2", 2, 2, [](const qreal* a, int) { return std::atan2(a[0], a[1]); }},
+        {"ceil", 1, 1, [](const qreal* a, int) { return std::ceil(a[0]); }},
+        {"cos", 1, 1, [](const qreal* a, int) { return std::cos(a[0]); }},
+        {"exp", 1, 1, [](const qreal* a, int) { return std::exp(a[0]); }},
+        {"floor", 1, 1, [](const qreal* a, int) { return std::floor(a[0]); }},
+        {"log", 1, 1, [](const qreal* a, int) { return std::log(a[0]); }},
+        {"max", 1, 4, [](const qreal* a, const int n) {
+            // qMin/qMax depend on the argument order for NaN
+            for(int i = 0; i < n; i++) {
+                if(std::isnan(a[i])) return sNaN;
+            }
+            qreal result = a[0];
+            for(int i = 1; i < n; i++) result = qMax(result, a[i]);
+            return result;
+        }},
+        {"min", 1, 4, [](const qreal* a, const int n) {
+            // qMin/qMax depend on the argument order for NaN
+            for(int i = 0; i < n; i++) {
+                if(std::isnan(a[i])) return sNaN;
+            }
+            qreal result = a[0];
+            for(int i = 1; i < n; i++) result = qMin(result, a[i]);
+            return result;
+        }},
+        {"pow", 2, 2, [](const qreal* a, int) { return std::pow(a[0], a[1]); }},
+        {"round", 1, 1, [](const qreal* a, int) { return jsRound(a[0]); }},
+        {"sign", 1, 1, [](const qreal* a, int) {
+            return a[0] > 0 ? 1. : (a[0] < 0 ? -1. : a[0]);
+        }},
+        {"sin", 1, 1, [](const qreal* a, int) { return std::sin(a[0]); }},
+        {"sqrt", 1, 1, [](const qreal* a, int) { return std::sqrt(a[0]); }},
+        {"tan", 1, 1, [](const qreal* a, int) { return std::tan(a[0]); }},
+        {"trunc", 1, 1, [](const qreal* a, int) { return std::trunc(a[0]); }}
+    };
+
+    class CallNode : public ShaderExpression::Node {
+    public:
+        CallNode(const MathFunc func, std::vector<NodePtr>&& args) :
+            Node(1), mFunc(func), mArgs(std::move(args)) {}
+        ShaderVec evaluate(const ShaderSlots& slots) const {
+            qreal args[4];
+            const int nArgs = static_cast<int>(mArgs.size());
+            for(int i = 0; i < nArgs; i++)
+                args[i] = mArgs[static_cast<size_t>(i)]->scalarValue(slots);
+            return scalar(mFunc(args, nArgs));
+        }
+    private:
+        const MathFunc mFunc;
+        const std::vector<NodePtr> mArgs;
+    };
+
+    //! @brief Recursive descent parser, returns nullptr on unsupported syntax
+    class Parser {
+    public:
+        Parser(const QString& script, const ShaderSymbols& symbols) :
+            mSrc(script), mSymbols(symbols) {}
+
+        NodePtr parse() {
+            auto result = parseTernary();
+            if(!result) return nullptr;
+            skipSpaces();
+            while(accept(';')) skipSpaces();
+            if(mPos != mSrc.count()) return nullptr;
+            return result;
+        }
+    private:
+        void skipSpaces() {
+            while(mPos < mSrc.count() && mSrc.at(mPos).isSpace()) mPos++;
+        }
+
+        bool accept(const char* const token) {
+            skipSpaces();
+            const auto len = static_cast<int>(strlen(token));
+            if(mSrc.midRef(mPos, len) != QLatin1String(token)) return false;
+            mPos += len;
+            return true;
+        }
+
+        bool accept(const char c) {
+            skipSpaces();
+            if(mPos >= mSrc.count() || mSrc.at(mPos) != c) return false;
+            mPos++;
+            return true;
+        }
+
+        bool peek(const char c) {
+            skipSpaces();
+            return mPos < mSrc.count() && mSrc.at(mPos) == c;
+        }
+
+        static NodePtr scalarOnly(NodePtr&& node) {
+            if(!node || node->fSize != 1) return nullptr;
+            return std::move(node);
+        }
+
+        NodePtr parseTernary() {
+            auto cond = parseBinary(0);
+            if(!cond) return nullptr;
+            if(!accept('?')) return cond;
+            cond = scalarOnly(std::move(cond));
+            auto a = parseTernary();
+            if(!cond || !a || !accept(':')) return nullptr;
+            auto b = parseTernary();
+            if(!b || a->fSize != b->fSize) return nullptr;
+            return NodePtr(new TernaryNode(std::move(cond),
+                                           std::move(a), std::move(b)));
+        }
+
+        // operators by increasing precedence
+        bool acceptOperator(const int level, BinaryOp& op) {
+            switch(level) {
+            case 0:
+                if(accept("||")) { op = BinaryOp::logicalOr; return true; }
+                return false;
+            case 1:
+                if(accept("&&")) { op = BinaryOp::logicalAnd; return true; }
+                return false;
+            case 2:
+                if(accept("===") || accept("==")) {
+                    op = BinaryOp::equal; return true;
+                }
+                if(accept("!==") || accept("!=")) {
+                    op = BinaryOp::notEqual; return true;
+                }
+                return false;
+            case 3:
+                if(accept("<=")) { op = BinaryOp::lessEq; return true; }
+                if(accept(">=")) { op = BinaryOp::greaterEq; return true; }
+                if(accept('<')) { op = BinaryOp::less; return true; }
+                if(accept('>')) { op = BinaryOp::greater; return true; }
+                return false;
+            case 4:
+                if(accept('+')) { op = BinaryOp::add; return true; }
+                if(accept('-')) { op = BinaryOp::sub; return true; }
+                return false;
+            case 5:
+                if(accept('*')) { op = BinaryOp::mul; return true; }
+                if(accept('/')) { op = BinaryOp::div; return true; }
+                if(accept('%')) { op = BinaryOp::mod; return true; }
+                return false;
+            default: return false;
+            }
+        }
+
+        NodePtr parseBinary(const int level) {
+            if(level > 5) return parseUnary();
+            auto a = parseBinary(level + 1);
+            if(!a) return nullptr;
+            BinaryOp op;
+            while(acceptOperator(level, op)) {
+                // arithmetic on arrays is not element-wise in JavaScript
+                a = scalarOnly(std::move(a));
+                auto b = scalarOnly(parseBinary(level + 1));
+                if(!a || !b) return nullptr;
+                a = NodePtr(new BinaryNode(op, std::move(a), std::move(b)));
+            }
+            return a;
+        }
+
+        NodePtr parseUnary() {
+            char op = 0;
+            if(accept('-')) op = '-';
+            else if(accept('+')) op = '+';
+            else if(accept('!')) op = '!';
+            if(!op) return parsePostfix();
+            auto arg = scalarOnly(parseUnary());
+            if(!arg) return nullptr;
+            return NodePtr(new UnaryNode(op, std::move(arg)));
+        }
+
+        NodePtr parsePostfix() {
+            auto node = parsePrimary();
+            while(node && accept('[')) {
+                auto index = scalarOnly(parseTernary());
+                if(!index || !accept(']') || node->fSize == 1) return nullptr;
+                node = NodePtr(new IndexNode(std::move(node), std::move(index)));
+            }
+            return node;
+        }
+
+        NodePtr parsePrimary() {
+            if(accept('(')) {
+                auto node = parseTernary();
+                if(!node || !accept(')')) return nullptr;
+                return node;
+            }
+            if(accept('[')) {
+                std::vector<NodePtr> items;
+                do {
+                    auto item = scalarOnly(parseTernary());
+                    if(!item) return nullptr;
+                    items.push_back(std::move(item));
+                } while(accept(','));
+                if(!accept(']') || items.size() > 4) return nullptr;
+                return NodePtr(new ArrayNode(std::move(items)));
+            }
+            skipSpaces();
+            if(mPos >= mSrc.count()) return nullptr;
+            const QChar c = mSrc.at(mPos);
+            if(c.isDigit() || c == '.') return parseNumber();
+            const QString name = parseIdentifier();
+            if(name.isEmpty()) return nullptr;
+            if(name == "Math") {
+                if(!accept('.')) return nullptr;
+                return parseMath(parseIdentifier());
+            }
+            const int slot = mSymbols.slot(name);
+            if(slot < 0) return nullptr;
+            return NodePtr(new SlotNode(slot, mSymbols.size(slot)));
+        }
+
+        NodePtr parseNumber() {
+            const int start = mPos;
+            while(mPos < mSrc.count()) {
+                const QChar c = mSrc.at(mPos);
+                const bool exp = c == 'e' || c == 'E';
+                const bool sign = (c == '+' || c == '-') && mPos > start &&
+                        (mSrc.at(mPos - 1) == 'e' || mSrc.at(mPos - 1) == 'E');
+                if(!c.isDigit() && c != '.' && !exp && !sign) break;
+                mPos++;
+            }
+            bool ok;
+            const qreal val = mSrc.midRef(start, mPos - start).toDouble(&ok);
+            if(!ok) return nullptr;
+            return NodePtr(new NumberNode(val));
+        }
+
+        QString parseIdentifier() {
+            skipSpaces();
+            const int start = mPos;
+            while(mPos < mSrc.count()) {
+                const QChar c = mSrc.at(mPos);
+                const bool first = mPos == start;
+                if(!(c.isLetter() || c == '_' || c == '$' ||
+                     (!first && c.isDigit()))) break;
+                mPos++;
+            }
+            return mSrc.mid(start, mPos - start);
+        }
+
+        NodePtr parseMath(const QString& name) {
+            if(name == "PI") return NodePtr(new NumberNode(M_PI));
+            if(name == "E") return NodePtr(new NumberNode(M_E));
+            if(name == "SQRT2") return NodePtr(new NumberNode(M_SQRT2));
+            if(name == "LN2") return NodePtr(new NumberNode(M_LN2));
+            for(const auto& def : sMathFuncs) {
+                if(name != QLatin1String(def.fName)) continue;
+                if(!accept('(')) return nullptr;
+                std::vector<NodePtr> args;
+                if(!peek(')')) {
+                    do {
+                        auto arg = scalarOnly(parseTernary());
+                        if(!arg) return nullptr;
+                        args.push_back(std::move(arg));
+                    } while(accept(','));
+                }
+                if(!accept(')')) return nullptr;
+                const int nArgs = static_cast<int>(args.size());
+                if(nArgs < def.fMinArgs || nArgs > def.fMaxArgs) return nullptr;
+                return NodePtr(new CallNode(def.fFunc, std::move(args)));
+            }
+            return nullptr;
+        }
+
+        const QString mSrc;
+        const ShaderSymbols& mSymbols;
+        int mPos = 0;
+    };
+}
+
+ShaderExpression::ShaderExpression(std::unique_ptr<Node>&& root) :
+    mRoot(std::move(root)) {}
+
+ShaderExpression::~ShaderExpression() {}
+
+stdsptr<ShaderExpression> ShaderExpression::sCompile(
+        const QString& script, const ShaderSymbols& symbols) {
+    Parser parser(script, symbols);
+    auto root = parser.parse();
+    if(!root) return nullptr;
+    return stdsptr<ShaderExpression>(new ShaderExpression(std::move(root)));
+}
+
+ShaderVec ShaderExpression::evaluate(const ShaderSlots& slots) const {
+    return mRoot->evaluate(slots);
+}
+
+int ShaderExpression::resultSize() const {
+    return mRoot->fSize;
+}
@@ -0,0 +1,71 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SHADEREXPRESSION_H
+#define SHADEREXPRESSION_H
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "smartPointers/ememory.h"
+
+//! @brief Number or an array of up to four numbers.
+struct ShaderVec {
+    int fSize = 1;
+    qreal fV[4] = {0, 0, 0, 0};
+};
+
+typedef QVector<ShaderVec> ShaderSlots;
+
+//! @brief Variables available to shader scripts, each bound to a slot.
+class ShaderSymbols {
+public:
+    enum : int { sTexSizeSlot = 0, sGlobalPosSlot = 1 };
+
+    ShaderSymbols();
+
+    int add(const QString& name, const int size);
+    //! @brief Returns -1 if there is no such variable.
+    int slot(const QString& name) const;
+    int size(const int slot) const { return mSizes.at(slot); }
+    int count() const { return mNames.count(); }
+private:
+    QList<QString> mNames;
+    QList<int> mSizes;
+};
+
+//! @brief Shader script compiled into an expression tree.
+//! Covers the expression subset of JavaScript used by margin
+//! and value scripts: arithmetic, comparisons, logic, ternaries,
+//! array literals and indexing, and Math functions and constants.
+class ShaderExpression {
+public:
+    class Node;
+
+    ~ShaderExpression();
+
+    //! @brief Returns nullptr if the script uses unsupported syntax.
+    static stdsptr<ShaderExpression> sCompile(const QString& script,
+                                              const ShaderSymbols& symbols);
+
+    ShaderVec evaluate(const ShaderSlots& slots) const;
+    int resultSize() const;
+private:
+    ShaderExpression(std::unique_ptr<Node>&& root);
+
+    const std::unique_ptr<Node> mRoot;
+};
+
+#endif // SHADEREXPRESSION_H
@@ -69,3 +69,25 @@ UniformSpecifier ShaderValueHandler::create(const GLint loc) const {
 void ShaderValueHandler::evaluate(QJSEngine &engine) const {
     engine.evaluate(fName + " = " + mScript);
 }
+
+bool ShaderValueHandler::acceptsSize(const int size) const {
+    switch(mType) {
+    case GLValueType::Float:
+    case GLValueType::Int: return size == 1;
+    case GLValueType::Vec2: return size == 2;
+    // the remaining types are not supported as uniforms
+    default: return !fGLValue;
+    }
+}
+
+void ShaderValueHandler::setUniform(QGL33 * const gl, const GLint loc,
+                                    const ShaderVec& value) const {
+    if(mType == GLValueType::Float) {
+        gl->glUniform1f(loc, static_cast<GLfloat>(value.fV[0]));
+    } else if(mType == GLValueType::Int) {
+        gl->glUniform1i(loc, static_cast<GLint>(value.fV[0]));
+    } else if(mType == GLValueType::Vec2) {
+        gl->glUniform2f(loc, static_cast<GLfloat>(value.fV[0]),
+                        static_cast<GLfloat>(value.fV[1]));
+    } else RuntimeThrow("Unsupported type for " + fName);
+}
@@ -20,6 +20,7 @@
 
 #include "glhelpers.h"
 #include "smartPointers/ememory.h"
+#include "shaderexpression.h"
 
 typedef std::function<void(QGL33 * const, QJSEngine&)> UniformSpecifier;
 
@@ -38,6 +39,13 @@ public:
     UniformSpecifier create(const GLint loc) const;
     void evaluate(QJSEngine& engine) const;
 
+    const QString& script() const { return mScript; }
+    //! @brief Whether a script result of the size suits the value type
+    bool acceptsSize(const int size) const;
+    //! @brief Uploads a compiled script result
+    void setUniform(QGL33 * const gl, const GLint loc,
+                    const ShaderVec& value) const;
+
     const QString fName;
     const bool fGLValue;
 private:
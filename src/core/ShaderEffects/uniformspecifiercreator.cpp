@@ -92,3 +92,23 @@ void UniformSpecifierCreator::evaluate(QJSEngine &engine,
         engine.evaluate(property->prp_getName() + " = " + QString::number(val));
     } else RuntimeThrow("Unsupported type");
 }
+
+qreal UniformSpecifierCreator::value(Property * const property,
+                                     const qreal relFrame,
+                                     const qreal resolution) const {
+    if(mType == ShaderPropertyType::qrealAnimator) {
+        const auto qa = static_cast<QrealAnimator*>(property);
+        const qreal val = qa->getEffectiveValue(relFrame);
+        return mResolutionScaled ? val*resolution : val;
+    } else if(mType == ShaderPropertyType::intAnimator) {
+        const auto ia = static_cast<IntAnimator*>(property);
+        return ia->getEffectiveIntValue(relFrame);
+    } else RuntimeThrow("Unsupported type");
+}
+
+void UniformSpecifierCreator::setUniform(QGL33 * const gl, const GLint loc,
+                                         const qreal value) const {
+    if(mType == ShaderPropertyType::intAnimator)
+        gl->glUniform1i(loc, static_cast<GLint>(value));
+    else gl->glUniform1f(loc, static_cast<GLfloat>(value));
+}
@@ -41,6 +41,14 @@ struct UniformSpecifierCreator : public StdSelfRef {
                   Property * const property,
                   const qreal relFrame,
                   const qreal resolution) const;
+
+    //! @brief Property value as seen by scripts
+    qreal value(Property * const property,
+                const qreal relFrame,
+                const qreal resolution) const;
+    //! @brief Uploads the value returned by value()
+    void setUniform(QGL33 * const gl, const GLint loc,
+                    const qreal value) const;
 private:
     const ShaderPropertyType mType;
     const bool mGLValue;
@@ -70,6 +70,43 @@ void SingleSound::prp_setupTreeViewMenu(PropertyMenu * const menu) {
     menu->addPlainAction("Delete", deleteOp);
 }
 
+void SingleSound::prp_drawTimelineControls(
+        QPainter * const p, const qreal pixelsPerFrame,
+        const FrameRange &absFrameRange, const int rowHeight) {
+    eSound::prp_drawTimelineControls(p, pixelsPerFrame,
+                                     absFrameRange, rowHeight);
+    if(!mCacheHandler || isZero4Dec(mStretch)) return;
+    const auto& peaks = mCacheHandler->getDataHandler()->getPeaks();
+    if(!peaks) return;
+    const auto drawRange = mDurationRectangle->getAbsFrameRange()*absFrameRange;
+    if(!drawRange.isValid()) return;
+    const int x0 = qFloor((drawRange.fMin - absFrameRange.fMin)*pixelsPerFrame);
+    const int x1 = qCeil((drawRange.fMax + 1 - absFrameRange.fMin)*pixelsPerFrame);
+    if(x1 <= x0) return;
+
+    const qreal samplesPerFrame = peaks->sampleRate()/(getCanvasFPS()*qAbs(mStretch));
+    const qreal samplesPerPixel = samplesPerFrame/pixelsPerFrame;
+    const int firstFrame = absFrameRange.fMin - prp_getTotalFrameShift();
+    const qreal firstSample = firstFrame*samplesPerFrame + x0*samplesPerPixel;
+    QVector<SoundPeaks::Peak> pixels(x1 - x0);
+    peaks->peaks(firstSample, samplesPerPixel, pixels);
+
+    const qreal mid = 0.5*rowHeight;
+    const qreal scale = 0.45*rowHeight/32767;
+    QVector<QLineF> lines;
+    lines.reserve(pixels.count());
+    for(int i = 0; i < pixels.count(); i++) {
+        const auto& peak = pixels.at(i);
+        if(peak.fMin == peak.fMax && peak.fMin == 0) continue;
+        const qreal x = x0 + i + 0.5;
+        lines << QLineF(x, mid - peak.fMax*scale, x, mid - peak.fMin*scale);
+    }
+    p->save();
+    p->setPen(QPen(QColor(255, 255, 255, 140), 1));
+    p->drawLines(lines);
+    p->restore();
+}
+
 SoundReaderForMerger *SingleSound::getSecondReader(const int relSecondId) {
     const int maxSec = mCacheHandler->durationSecCeil() - 1;
     if(relSecondId < 0 || relSecondId > maxSec) return nullptr;
@@ -99,6 +136,7 @@ const HddCachableCacheHandler *SingleSound::getCacheHandler() const {
 
 void SingleSound::setStretch(const qreal stretch) {
     mStretch = stretch;
+    mResampler = enve::make_shared<SoundResampler>();
     updateDurationRectLength();
     prp_afterWholeInfluenceRangeChanged();
 }
@@ -130,6 +168,7 @@ void SingleSound::setFilePath(const QString &path) {
 
 void SingleSound::setSoundDataHandler(SoundDataHandler* const newDataHandler) {
     mCacheHandler.reset();
+    mResampler = enve::make_shared<SoundResampler>();
     if(newDataHandler) mCacheHandler = enve::make_shared<SoundHandler>(newDataHandler);
     mDurationRectangle->setSoundCacheHandler(getCacheHandler());
     updateDurationRectLength();
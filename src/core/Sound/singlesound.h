@@ -18,6 +18,7 @@
 #define SINGLESOUND_H
 #include "esound.h"
 #include "Animators/qrealanimator.h"
+#include "soundresampler.h"
 class FixedLenAnimationRect;
 class SoundHandler;
 class SoundDataHandler;
@@ -32,6 +33,9 @@ public:
     bool SWT_isSingleSound() const { return mIndependent; }
 
     void prp_setupTreeViewMenu(PropertyMenu * const menu);
+    void prp_drawTimelineControls(
+            QPainter * const p, const qreal pixelsPerFrame,
+            const FrameRange &absFrameRange, const int rowHeight);
 
     int prp_getRelFrameShift() const;
 
@@ -66,6 +70,9 @@ public:
     void setStretch(const qreal stretch);
     qreal getStretch() const { return mStretch; }
     QrealSnapshot getVolumeSnap() const;
+    const stdsptr<SoundResampler>& getResampler() const {
+        return mResampler;
+    }
 
     void setSoundDataHandler(SoundDataHandler * const newDataHandler);
 private:
@@ -75,6 +82,8 @@ private:
 
     qreal mStretch = 1;
     stdsptr<SoundHandler> mCacheHandler;
+    //! @brief Replaced whenever the resampled output changes
+    stdsptr<SoundResampler> mResampler = enve::make_shared<SoundResampler>();
 
     qsptr<QrealAnimator> mVolumeAnimator =
             enve::make_shared<QrealAnimator>(100, 0, 200, 1, "volume");
@@ -61,6 +61,7 @@ void SoundComposition::secondFinished(const int secondId,
     const auto sCont = enve::make_shared<SoundCacheContainer>(
                 samples, iValueRange{secondId, secondId}, &mSecondsCache);
     mSecondsCache.add(sCont);
+    if(mSecondReadyFunc) mSecondReadyFunc(samples);
 }
 
 void SoundComposition::setMinFrameUseRange(const int frame) {
@@ -109,14 +110,19 @@ SoundMerger *SoundComposition::scheduleSecond(const int secondId) {
                                           qFloor(enabledFrameRange.fMax/fps)};
         if(!enabledSecRange.inRange(secondId)) continue;
         const auto secs = sound->absSecondToRelSeconds(secondId);
+        const bool stretched = !isOne4Dec(sound->getStretch());
         for(int i = secs.fMin; i <= secs.fMax; i++) {
             const auto samples = sound->getSamplesForSecond(i);
+            // lets the resampler join the seconds in any order
+            const auto prev = stretched && i > 0 ?
+                        sound->getSamplesForSecond(i - 1) : nullptr;
             if(samples) {
                 task->addSoundToMerge({sound->getSampleShift(),
                                        sound->absSampleRange(),
                                        sound->getVolumeSnap(),
                                        sound->getStretch(),
-                                       enve::make_shared<Samples>(samples)});
+                                       enve::make_shared<Samples>(samples),
+                                       prev, sound->getResampler()});
             } else {
                 const auto reader = sound->getSecondReader(i);
                 if(!reader) continue;
@@ -125,7 +131,8 @@ SoundMerger *SoundComposition::scheduleSecond(const int secondId) {
                 reader->addSingleSound(sound->getSampleShift(),
                                        sound->absSampleRange(),
                                        sound->getVolumeSnap(),
-                                       sound->getStretch());
+                                       sound->getStretch(),
+                                       prev, sound->getResampler());
             }
         }
     }
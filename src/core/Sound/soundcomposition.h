@@ -23,6 +23,7 @@
 #include "esound.h"
 #include "esoundsettings.h"
 #include <math.h>
+#include <functional>
 
 #include <QAudioOutput>
 #include <QByteArray>
@@ -52,6 +53,11 @@ public:
 
     void secondFinished(const int secondId,
                         const stdsptr<Samples>& samples);
+    //! @brief Called with every second finished from now on,
+    //! null to disable.
+    void setSecondReadyFunc(const std::function<void(const stdsptr<Samples>&)>& func) {
+        mSecondReadyFunc = func;
+    }
 
     void setMinFrameUseRange(const int frame);
     void setMaxFrameUseRange(const int frame);
@@ -78,6 +84,7 @@ private:
     QList<int> mProcessingSeconds;
     const Canvas * const mParent;
     qint64 mPos;
+    std::function<void(const stdsptr<Samples>&)> mSecondReadyFunc;
     QList<qsptr<eSound>> mSounds;
     HddCachableCacheHandler mSecondsCache;
 };
@@ -15,6 +15,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "soundmerger.h"
+#include "soundmixing.h"
+#include <QVarLengthArray>
 
 template <typename T>
 void mergePlanarDataUnsigned(T const * const * const src,
@@ -144,60 +146,74 @@ void mergeInterleavedDataSigned(const T* const src,
     }
 }
 
-void mergePlanarData(float const * const * const src,
-                     const SampleRange& srcRange,
-                     float ** const dst,
-                     const SampleRange& dstRange,
-                     const int nSamples,
-                     QrealSnapshot::Iterator volIt,
-                     const int nChannels) {
-    int dstId = dstRange.fMin;
-    int srcId = srcRange.fMin;
-    if(volIt.staticValue()) {
-        const float vol = static_cast<float>(volIt.getValueAndProgress(1));
-        for(int i = 0; i < nSamples; i++) {
-            for(int j = 0; j < nChannels; j++) {
-                dst[j][dstId] += src[j][srcId]*vol;
-            }
-            dstId++; srcId++;
-        }
-    } else {
-        for(int i = 0; i < nSamples; i++) {
-            const float vol = static_cast<float>(volIt.getValueAndProgress(1));
-            for(int j = 0; j < nChannels; j++) {
-                dst[j][dstId] += src[j][srcId]*vol;
-            }
-            dstId++; srcId++;
+// volume gains are evaluated for blocks of samples
+#define GAIN_BLOCK 256
+
+//! @brief Fills gains for nSamples samples, each repeated nChannels times.
+void fillGains(QrealSnapshot::Iterator& volIt,
+               float * gains, const int nSamples,
+               const int nChannels) {
+    int i = 0;
+    while(i < nSamples) {
+        qreal vol;
+        qreal step;
+        const int n = volIt.getRampAndProgress(nSamples - i, vol, step);
+        for(int k = 0; k < n; k++) {
+            const float gain = static_cast<float>(vol + k*step);
+            for(int j = 0; j < nChannels; j++) *gains++ = gain;
         }
+        i += n;
     }
 }
 
-void mergeInterleavedData(const float* const src,
-                          const SampleRange& srcRange,
-                          float * const dst,
-                          const SampleRange& dstRange,
-                          const int nSamples,
-                          QrealSnapshot::Iterator volIt,
-                          const int nChannels) {
-    int dstId = dstRange.fMin*nChannels;
-    int srcId = srcRange.fMin*nChannels;
-    if(volIt.staticValue()) {
-        const float vol = static_cast<float>(volIt.getValueAndProgress(1));
-        for(int i = 0; i < nSamples; i++) {
-            for(int j = 0; j < nChannels; j++) {
-                dst[dstId++] += src[srcId++]*vol;
-            }
-        }
-    } else {
-        for(int i = 0; i < nSamples; i++) {
-            const float vol = static_cast<float>(volIt.getValueAndProgress(1));
-            for(int j = 0; j < nChannels; j++) {
-                dst[dstId++] += src[srcId++]*vol;
-            }
+template <typename T>
+using MixFunc = void (*)(T * const, const T * const,
+                         const float * const, const int);
+
+template <typename T>
+void mergePlanarBlocks(T const * const * const src,
+                       const SampleRange& srcRange,
+                       T ** const dst,
+                       const SampleRange& dstRange,
+                       const int nSamples,
+                       QrealSnapshot::Iterator volIt,
+                       const int nChannels,
+                       const MixFunc<T> mix) {
+    float gains[GAIN_BLOCK];
+    const bool staticVol = volIt.staticValue();
+    if(staticVol) fillGains(volIt, gains, GAIN_BLOCK, 1);
+    for(int i = 0; i < nSamples; i += GAIN_BLOCK) {
+        const int n = qMin(GAIN_BLOCK, nSamples - i);
+        if(!staticVol) fillGains(volIt, gains, n, 1);
+        for(int j = 0; j < nChannels; j++) {
+            mix(dst[j] + dstRange.fMin + i,
+                src[j] + srcRange.fMin + i, gains, n);
         }
     }
 }
 
+template <typename T>
+void mergeInterleavedBlocks(const T* const src,
+                            const SampleRange& srcRange,
+                            T * const dst,
+                            const SampleRange& dstRange,
+                            const int nSamples,
+                            QrealSnapshot::Iterator volIt,
+                            const int nChannels,
+                            const MixFunc<T> mix) {
+    QVarLengthArray<float, 2*GAIN_BLOCK> gains(GAIN_BLOCK*nChannels);
+    const bool staticVol = volIt.staticValue();
+    if(staticVol) fillGains(volIt, gains.data(), GAIN_BLOCK, nChannels);
+    const T* srcP = src + srcRange.fMin*nChannels;
+    T* dstP = dst + dstRange.fMin*nChannels;
+    for(int i = 0; i < nSamples; i += GAIN_BLOCK) {
+        const int n = qMin(GAIN_BLOCK, nSamples - i);
+        if(!staticVol) fillGains(volIt, gains.data(), n, nChannels);
+        mix(dstP, srcP, gains.data(), n*nChannels);
+        srcP += n*nChannels;
+        dstP += n*nChannels;
+    }
+}
 
 void mergePlanarData(qreal const * const * const src,
                      const SampleRange& srcRange,
@@ -263,13 +279,15 @@ void mergeData(uchar const * const * const src,
                const int nChannels) {
     nSamples = qMin(qMin(nSamples, dstRange.span()), srcRange.span());
     if(format == AV_SAMPLE_FMT_FLT) {
-        mergeInterleavedData(reinterpret_cast<const float*>(src[0]), srcRange,
-                             reinterpret_cast<float*>(dst[0]), dstRange,
-                             nSamples, volIt, nChannels);
+        mergeInterleavedBlocks(reinterpret_cast<const float*>(src[0]), srcRange,
+                               reinterpret_cast<float*>(dst[0]), dstRange,
+                               nSamples, volIt, nChannels,
+                               SoundMixing::mixFloat);
     } else if(format == AV_SAMPLE_FMT_FLTP) {
-        mergePlanarData(reinterpret_cast<float const * const *>(src), srcRange,
-                        reinterpret_cast<float**>(dst), dstRange,
-                        nSamples, volIt, nChannels);
+        mergePlanarBlocks(reinterpret_cast<float const * const *>(src), srcRange,
+                          reinterpret_cast<float**>(dst), dstRange,
+                          nSamples, volIt, nChannels,
+                          SoundMixing::mixFloat);
     } else if(format == AV_SAMPLE_FMT_DBL) {
         mergeInterleavedData(reinterpret_cast<const qreal*>(src[0]), srcRange,
                              reinterpret_cast<qreal*>(dst[0]), dstRange,
@@ -287,13 +305,15 @@ void mergeData(uchar const * const * const src,
                                 reinterpret_cast<quint8**>(dst), dstRange,
                                 nSamples, volIt, nChannels);
     } else if(format == AV_SAMPLE_FMT_S16) {
-        mergeInterleavedDataSigned(reinterpret_cast<const qint16*>(src[0]), srcRange,
-                                   reinterpret_cast<qint16*>(dst[0]), dstRange,
-                                   nSamples, volIt, nChannels);
+        mergeInterleavedBlocks(reinterpret_cast<const qint16*>(src[0]), srcRange,
+                               reinterpret_cast<qint16*>(dst[0]), dstRange,
+                               nSamples, volIt, nChannels,
+                               SoundMixing::mixS16);
     } else if(format == AV_SAMPLE_FMT_S16P) {
-        mergePlanarDataSigned(reinterpret_cast<qint16 const * const *>(src), srcRange,
-                              reinterpret_cast<qint16**>(dst), dstRange,
-                              nSamples, volIt, nChannels);
+        mergePlanarBlocks(reinterpret_cast<qint16 const * const *>(src), srcRange,
+                          reinterpret_cast<qint16**>(dst), dstRange,
+                          nSamples, volIt, nChannels,
+                          SoundMixing::mixS16);
     } else if(format == AV_SAMPLE_FMT_S32) {
         mergeInterleavedDataSigned(reinterpret_cast<const qint32*>(src[0]), srcRange,
                                    reinterpret_cast<qint32*>(dst[0]), dstRange,
@@ -325,13 +345,17 @@ void SoundMerger::process() {
         const auto srcSamples = sound.fSamples;
         const qreal stretch = sound.fStretch;
 
+        const bool stretched = !isOne4Dec(stretch);
         const SampleRange smplsRelRange = srcSamples->fSampleRange;
-        const SampleRange smplsSpeedRelRange{qRound(smplsRelRange.fMin*stretch),
-                                             qRound(smplsRelRange.fMax*stretch)};
+        const SampleRange smplsSpeedRelRange = stretched ?
+                    SoundResampler::sResampledRange(smplsRelRange,
+                                                    srcSamples->fSampleRate,
+                                                    stretch) :
+                    smplsRelRange;
         const SampleRange smplsAbsRange = smplsSpeedRelRange.shifted(sound.fSampleShift);
         const SampleRange srcAbsRange = smplsAbsRange*sound.fSSAbsRange;
         const SampleRange srcNeededAbsRange = srcAbsRange*mSampleRange;
-        const int absToRel = -qRound(srcSamples->fSampleRange.fMin*stretch) - sound.fSampleShift;
+        const int absToRel = -smplsSpeedRelRange.fMin - sound.fSampleShift;
         const SampleRange srcNeededRelRange = srcNeededAbsRange.shifted(absToRel);
 
         const SampleRange dstAbsRange = mSampleRange;
@@ -342,47 +366,21 @@ void SoundMerger::process() {
         if(!srcNeededRelRange.isValid()) continue;
         const int firstVolSample = dstNeededAbsRange.fMin - sound.fSampleShift;
         QrealSnapshot::Iterator volIt(firstVolSample, 1000, &sound.fVolume);
-        if(isOne4Dec(stretch)) {
+        if(!stretched) {
             const int nSamples = qMin(srcNeededRelRange.span(), dstRelRange.span());
 
             const auto src = srcSamples->fData;
             mergeData(src, srcNeededRelRange, dst, dstRelRange,
                       nSamples, volIt, mSettings.fSampleFormat, nChannels);
         } else {
-            const int srcSampleRate = mSettings.fSampleRate;
-            const int dstSampleRate = qRound(mSettings.fSampleRate*stretch);
-
-            const AVSampleFormat sampleFormat = mSettings.fSampleFormat;
-            const uint64_t chLayout = mSettings.fChannelLayout;
-            const int chCount = av_get_channel_layout_nb_channels(chLayout);
-
-            struct SwrContext * swrContext = swr_alloc();
-            av_opt_set_int(swrContext, "in_channel_count", chCount, 0);
-            av_opt_set_int(swrContext, "out_channel_count", chCount, 0);
-            av_opt_set_int(swrContext, "in_channel_layout", chLayout, 0);
-            av_opt_set_int(swrContext, "out_channel_layout", chLayout, 0);
-            av_opt_set_int(swrContext, "in_sample_rate", srcSampleRate, 0);
-            av_opt_set_int(swrContext, "out_sample_rate", dstSampleRate, 0);
-            av_opt_set_sample_fmt(swrContext, "in_sample_fmt", sampleFormat, 0);
-            av_opt_set_sample_fmt(swrContext, "out_sample_fmt", sampleFormat,  0);
-            swr_init(swrContext);
-            if(!swr_is_initialized(swrContext))
-                RuntimeThrow("Resampler has not been properly initialized");
-            uint8_t** buffer = nullptr;
-            const int res = av_samples_alloc_array_and_samples(
-                        &buffer, nullptr, chCount, dstSampleRate,
-                        sampleFormat, 0);
-            if(res < 0) RuntimeThrow("Resampling output buffer alloc failed");
-            const int nSamples =
-                    swr_convert(swrContext, buffer, dstSampleRate,
-                                const_cast<const uint8_t**>(srcSamples->fData),
-                                srcSampleRate);
-            swr_free(&swrContext);
-            if(nSamples < 0) RuntimeThrow("Resampling failed");
-            mergeData(buffer, srcNeededRelRange, dst, dstRelRange,
+            const auto prev = sound.fPrevSamples.get();
+            const auto resampled = sound.fResampler ?
+                        sound.fResampler->resample(*srcSamples, prev, stretch) :
+                        enve::make_shared<SoundResampler>()->resample(
+                            *srcSamples, prev, stretch);
+            const int nSamples = resampled->fSampleRange.span();
+            mergeData(resampled->fData, srcNeededRelRange, dst, dstRelRange,
                       nSamples, volIt, mSettings.fSampleFormat, nChannels);
-            if(buffer) av_freep(&buffer[0]);
-            av_freep(&buffer);
         }
     }
 }
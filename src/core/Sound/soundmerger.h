@@ -21,6 +21,7 @@
 #include "soundcomposition.h"
 #include "Animators/qrealanimator.h"
 #include "esoundsettings.h"
+#include "soundresampler.h"
 extern "C" {
     #include <libavutil/opt.h>
     #include <libswresample/swresample.h>
@@ -31,6 +32,11 @@ struct SingleSoundData {
     QrealSnapshot fVolume;
     qreal fStretch;
     stdsptr<Samples> fSamples;
+    //! @brief Preceding second of the sound if available,
+    //! primes the resampler if stretched
+    stdsptr<Samples> fPrevSamples;
+    //! @brief Resampler of the sound, used if stretched
+    stdsptr<SoundResampler> fResampler;
 };
 
 class SoundMerger : public eCpuTask {
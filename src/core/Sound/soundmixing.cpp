@@ -0,0 +1,202 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "soundmixing.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__))
+#define SOUNDMIXING_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(SOUNDMIXING_SSE2) && defined(__GNUC__)
+#define SOUNDMIXING_AVX2
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef __GNUC__
+// keeps the tails from being inlined into AVX2 kernels and contracted
+// to fma, every kernel multiplies and adds with separate roundings
+#define SCALAR_TAIL __attribute__((noinline))
+#else
+#define SCALAR_TAIL
+#endif
+
+namespace {
+    SCALAR_TAIL
+    void mixFloatScalar(float * const dst, const float * const src,
+                        const float * const gain, const int n) {
+        for(int i = 0; i < n; i++) dst[i] += src[i]*gain[i];
+    }
+
+    SCALAR_TAIL
+    void mixS16Scalar(qint16 * const dst, const qint16 * const src,
+                      const float * const gain, const int n) {
+        for(int i = 0; i < n; i++) {
+            const float val = dst[i] + src[i]*gain[i];
+            // lrintf rounds half to even like _mm_cvtps_epi32
+            const float clamped = qBound(-32768.f, val, 32767.f);
+            dst[i] = static_cast<qint16>(std::lrintf(clamped));
+        }
+    }
+
+#ifdef SOUNDMIXING_SSE2
+    void mixFloatSse2(float * const dst, const float * const src,
+                      const float * const gain, const int n) {
+        int i = 0;
+        for(; i + 4 <= n; i += 4) {
+            const __m128 s = _mm_loadu_ps(src + i);
+            const __m128 g = _mm_loadu_ps(gain + i);
+            const __m128 d = _mm_loadu_ps(dst + i);
+            _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(s, g)));
+        }
+        mixFloatScalar(dst + i, src + i, gain + i, n - i);
+    }
+
+    //! @brief Sign extends four qint16 to float.
+    inline __m128 s16ToFloat(const __m128i v) {
+        return _mm_cvtepi32_ps(_mm_srai_epi32(v, 16));
+    }
+
+    void mixS16Sse2(qint16 * const dst, const qint16 * const src,
+                    const float * const gain, const int n) {
+        int i = 0;
+        for(; i + 8 <= n; i += 8) {
+            const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128 sLo = s16ToFloat(_mm_unpacklo_epi16(s, s));
+            const __m128 sHi = s16ToFloat(_mm_unpackhi_epi16(s, s));
+            const __m128 dLo = s16ToFloat(_mm_unpacklo_epi16(d, d));
+            const __m128 dHi = s16ToFloat(_mm_unpackhi_epi16(d, d));
+            const __m128 gLo = _mm_loadu_ps(gain + i);
+            const __m128 gHi = _mm_loadu_ps(gain + i + 4);
+            const __m128i rLo = _mm_cvtps_epi32(_mm_add_ps(dLo, _mm_mul_ps(sLo, gLo)));
+            const __m128i rHi = _mm_cvtps_epi32(_mm_add_ps(dHi, _mm_mul_ps(sHi, gHi)));
+            // packs saturates to the qint16 range
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                             _mm_packs_epi32(rLo, rHi));
+        }
+        mixS16Scalar(dst + i, src + i, gain + i, n - i);
+    }
+#endif
+
+#ifdef SOUNDMIXING_AVX2
+    AVX2_TARGET
+    void mixFloatAvx2(float * const dst, const float * const src,
+                      const float * const gain, const int n) {
+        int i = 0;
+        for(; i + 8 <= n; i += 8) {
+            const __m256 s = _mm256_loadu_ps(src + i);
+            const __m256 g = _mm256_loadu_ps(gain + i);
+            const __m256 d = _mm256_loadu_ps(dst + i);
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(d, _mm256_mul_ps(s, g)));
+        }
+        mixFloatScalar(dst + i, src + i, gain + i, n - i);
+    }
+
+    AVX2_TARGET
+    void mixS16Avx2(qint16 * const dst, const qint16 * const src,
+                    const float * const gain, const int n) {
+        int i = 0;
+        for(; i + 16 <= n; i += 16) {
+            const auto s = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+            const auto s1 = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+            const auto d = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)));
+            const auto d1 = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i + 8)));
+            const __m256 r = _mm256_add_ps(
+                        _mm256_cvtepi32_ps(d),
+                        _mm256_mul_ps(_mm256_cvtepi32_ps(s),
+                                      _mm256_loadu_ps(gain + i)));
+            const __m256 r1 = _mm256_add_ps(
+                        _mm256_cvtepi32_ps(d1),
+                        _mm256_mul_ps(_mm256_cvtepi32_ps(s1),
+                                      _mm256_loadu_ps(gain + i + 8)));
+            // packs works within 128-bit lanes, restore the sample order
+            const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(r),
+                                                      _mm256_cvtps_epi32(r1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                                _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+        mixS16Scalar(dst + i, src + i, gain + i, n - i);
+    }
+#endif
+
+    typedef void (*MixFloatFunc)(float*, const float*, const float*, int);
+    typedef void (*MixS16Func)(qint16*, const qint16*, const float*, int);
+
+    struct Kernels {
+        Kernels() {
+            if(!set(SoundMixing::Simd::avx2))
+                set(SoundMixing::Simd::sse2);
+        }
+
+        bool set(const SoundMixing::Simd simd) {
+            switch(simd) {
+            case SoundMixing::Simd::scalar:
+                fMixFloat = mixFloatScalar;
+                fMixS16 = mixS16Scalar;
+                return true;
+            case SoundMixing::Simd::sse2:
+#ifdef SOUNDMIXING_SSE2
+                fMixFloat = mixFloatSse2;
+                fMixS16 = mixS16Sse2;
+                return true;
+#else
+                return false;
+#endif
+            case SoundMixing::Simd::avx2:
+#ifdef SOUNDMIXING_AVX2
+                __builtin_cpu_init();
+                if(!__builtin_cpu_supports("avx2")) return false;
+                fMixFloat = mixFloatAvx2;
+                fMixS16 = mixS16Avx2;
+                return true;
+#else
+                return false;
+#endif
+            }
+            return false;
+        }
+
+        MixFloatFunc fMixFloat = mixFloatScalar;
+        MixS16Func fMixS16 = mixS16Scalar;
+    };
+
+    Kernels& kernels() {
+        static Kernels instance;
+        return instance;
+    }
+}
+
+bool SoundMixing::setSimd(const Simd simd) {
+    return kernels().set(simd);
+}
+
+void SoundMixing::mixFloat(float * const dst, const float * const src,
+                           const float * const gain, const int n) {
+    kernels().fMixFloat(dst, src, gain, n);
+}
+
+void SoundMixing::mixS16(qint16 * const dst, const qint16 * const src,
+                         const float * const gain, const int n) {
+    kernels().fMixS16(dst, src, gain, n);
+}
@@ -0,0 +1,42 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SOUNDMIXING_H
+#define SOUNDMIXING_H
+#include <QtGlobal>
+
+//! @brief Mix-with-gain kernels used by SoundMerger.
+//! Vectorized with SSE2 or AVX2, picked at runtime,
+//! with a scalar fallback on other architectures.
+//! All kernels give bit-exact results, rounding half to even.
+namespace SoundMixing {
+    enum class Simd { scalar, sse2, avx2 };
+
+    //! @brief Selects the kernels used by mixFloat and mixS16,
+    //! for tests and benchmarks. Not to be called while mixing.
+    //! Returns false if not supported by the cpu.
+    bool setSimd(const Simd simd);
+
+    //! @brief dst[i] += src[i]*gain[i]
+    void mixFloat(float * const dst, const float * const src,
+                  const float * const gain, const int n);
+    //! @brief dst[i] += src[i]*gain[i], saturated and rounded to qint16,
+    //! halfway cases round to even.
+    void mixS16(qint16 * const dst, const qint16 * const src,
+                const float * const gain, const int n);
+}
+
+#endif // SOUNDMIXING_H
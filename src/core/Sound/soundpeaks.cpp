@@ -0,0 +1,192 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "soundpeaks.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QtMath>
+#include "Private/esettings.h"
+
+#define PEAKS_MAGIC quint32(0x656b7073)
+#define PEAKS_VERSION quint32(1)
+#define PEAKS_PREFIX QStringLiteral("enve_peaks_")
+// pyramid files kept in the hdd cache folder
+#define PEAKS_MAX_FILES 64
+#define PEAKS_MAX_AGE_DAYS 30
+
+SoundPeaks::SoundPeaks(const int sampleRate) : mSampleRate(sampleRate) {}
+
+void SoundPeaks::peaks(const qreal firstSample,
+                       const qreal samplesPerPixel,
+                       QVector<Peak>& dst) const {
+    const int nPixels = dst.count();
+    if(nPixels == 0) return;
+    if(mLevels.isEmpty()) {
+        dst.fill({0, 0});
+        return;
+    }
+    // coarsest level with buckets no wider than a pixel,
+    // each pixel then covers at most a few buckets
+    int level = 0;
+    qreal bucket = sBaseBucket;
+    while(level + 1 < mLevels.count() && 2*bucket <= samplesPerPixel) {
+        level++;
+        bucket *= 2;
+    }
+    const auto& peaks = mLevels.at(level);
+    const int nBuckets = peaks.count();
+    for(int i = 0; i < nPixels; i++) {
+        const qreal s0 = firstSample + i*samplesPerPixel;
+        const qreal s1 = s0 + samplesPerPixel;
+        const int b0 = qMax(0, qFloor(s0/bucket));
+        const int b1 = qMin(nBuckets - 1, qMax(b0, qCeil(s1/bucket) - 1));
+        Peak& pixel = dst[i];
+        if(b0 > b1 || s1 <= 0) {
+            pixel = {0, 0};
+            continue;
+        }
+        pixel = peaks.at(b0);
+        for(int b = b0 + 1; b <= b1; b++) {
+            const Peak& peak = peaks.at(b);
+            pixel.fMin = qMin(pixel.fMin, peak.fMin);
+            pixel.fMax = qMax(pixel.fMax, peak.fMax);
+        }
+    }
+}
+
+qint16 toPeakValue(const float value) {
+    return qint16(qBound(-32767, qRound(value*32767), 32767));
+}
+
+void SoundPeaks::addSamples(const float * const samples, const int count) {
+    if(mLevels.isEmpty()) mLevels << QVector<Peak>();
+    auto& base = mLevels.first();
+    for(int i = 0; i < count; i++) {
+        const float value = samples[i];
+        if(mBucketSamples == 0) {
+            mBucketMin = value;
+            mBucketMax = value;
+        } else {
+            mBucketMin = qMin(mBucketMin, value);
+            mBucketMax = qMax(mBucketMax, value);
+        }
+        if(++mBucketSamples == sBaseBucket) {
+            base.append({toPeakValue(mBucketMin), toPeakValue(mBucketMax)});
+            mBucketSamples = 0;
+        }
+    }
+    mSampleCount += count;
+}
+
+void SoundPeaks::finish() {
+    if(mLevels.isEmpty()) mLevels << QVector<Peak>();
+    if(mBucketSamples > 0) {
+        mLevels.first().append({toPeakValue(mBucketMin),
+                                toPeakValue(mBucketMax)});
+        mBucketSamples = 0;
+    }
+    buildLevels();
+}
+
+void SoundPeaks::buildLevels() {
+    while(mLevels.count() > 1) mLevels.removeLast();
+    while(mLevels.last().count() > 1) {
+        const auto& prev = mLevels.last();
+        const int nPrev = prev.count();
+        QVector<Peak> level((nPrev + 1)/2);
+        for(int i = 0; i < level.count(); i++) {
+            const Peak& a = prev.at(2*i);
+            const Peak& b = prev.at(qMin(2*i + 1, nPrev - 1));
+            level[i] = {qMin(a.fMin, b.fMin), qMax(a.fMax, b.fMax)};
+        }
+        mLevels << level;
+    }
+}
+
+bool SoundPeaks::save(const QString& path) const {
+    if(mLevels.isEmpty()) return false;
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    QDataStream stream(&file);
+    // only the base level is stored, the rest is cheap to rebuild
+    const auto& base = mLevels.first();
+    stream << PEAKS_MAGIC << PEAKS_VERSION << qint32(mSampleRate)
+           << mSampleCount << qint32(base.count());
+    const int bytes = base.count()*int(sizeof(Peak));
+    const bool written = stream.writeRawData(
+                reinterpret_cast<const char*>(base.data()), bytes) == bytes;
+    file.close();
+    if(!written) {
+        file.remove();
+        return false;
+    }
+    sPruneCache(QFileInfo(path).absolutePath());
+    return true;
+}
+
+void SoundPeaks::sPruneCache(const QString& folder) {
+    const QDir dir(folder);
+    const auto files = dir.entryInfoList({PEAKS_PREFIX + "*.dat"},
+                                         QDir::Files, QDir::Time);
+    const auto oldest = QDateTime::currentDateTime().addDays(-PEAKS_MAX_AGE_DAYS);
+    for(int i = 0; i < files.count(); i++) {
+        const auto& file = files.at(i);
+        if(i < PEAKS_MAX_FILES && file.lastModified() > oldest) continue;
+        QFile::remove(file.absoluteFilePath());
+    }
+}
+
+stdsptr<SoundPeaks> SoundPeaks::sLoad(const QString& path) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) return nullptr;
+    QDataStream stream(&file);
+    quint32 magic, version;
+    qint32 sampleRate, nPeaks;
+    qint64 sampleCount;
+    stream >> magic >> version >> sampleRate >> sampleCount >> nPeaks;
+    if(stream.status() != QDataStream::Ok) return nullptr;
+    if(magic != PEAKS_MAGIC || version != PEAKS_VERSION) return nullptr;
+    if(sampleRate <= 0 || nPeaks < 0) return nullptr;
+    const auto result = enve::make_shared<SoundPeaks>(sampleRate);
+    QVector<Peak> base(nPeaks);
+    const int bytes = nPeaks*int(sizeof(Peak));
+    if(stream.readRawData(reinterpret_cast<char*>(base.data()),
+                          bytes) != bytes) return nullptr;
+    result->mSampleCount = sampleCount;
+    result->mLevels << base;
+    result->buildLevels();
+    // marks the file as recently used for sPruneCache
+    file.setFileTime(QDateTime::currentDateTime(),
+                     QFileDevice::FileModificationTime);
+    return result;
+}
+
+QString SoundPeaks::sCachePath(const QString& srcPath) {
+    const QFileInfo info(srcPath);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    const auto& sett = *eSettings::sInstance;
+    const QString folder = sett.fHddCacheFolder.isEmpty() ?
+                QDir::tempPath() : sett.fHddCacheFolder;
+    return QDir(folder).filePath(PEAKS_PREFIX +
+                                 hash.result().toHex() + ".dat");
+}
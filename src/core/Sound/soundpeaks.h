@@ -0,0 +1,74 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SOUNDPEAKS_H
+#define SOUNDPEAKS_H
+#include <QVector>
+#include "smartPointers/ememory.h"
+
+//! @brief Multi-resolution min/max pyramid of a mono mixdown of a sound.
+//! Level 0 stores one peak per sBaseBucket source samples,
+//! every following level halves the resolution.
+class SoundPeaks : public StdSelfRef {
+    e_OBJECT
+protected:
+    SoundPeaks(const int sampleRate);
+public:
+    struct Peak {
+        qint16 fMin;
+        qint16 fMax;
+    };
+
+    static const int sBaseBucket = 256;
+
+    int sampleRate() const { return mSampleRate; }
+    qint64 sampleCount() const { return mSampleCount; }
+    int levelCount() const { return mLevels.count(); }
+
+    //! @brief Fills dst with one peak per pixel, pixel i covers source
+    //! samples [firstSample + i*samplesPerPixel, + samplesPerPixel).
+    //! Cost is linear in dst.count() regardless of the zoom.
+    void peaks(const qreal firstSample, const qreal samplesPerPixel,
+               QVector<Peak>& dst) const;
+
+    //! @brief Builder only, samples are in the [-1, 1] range.
+    void addSamples(const float * const samples, const int count);
+    //! @brief Builder only, flushes the last bucket and builds the levels.
+    void finish();
+
+    //! @brief Also removes the least recently used pyramid files.
+    bool save(const QString& path) const;
+    //! @brief Returns nullptr if there is no valid pyramid at path.
+    static stdsptr<SoundPeaks> sLoad(const QString& path);
+    //! @brief Pyramid file for the source file, located in the hdd cache
+    //! folder and invalidated when the source file changes.
+    static QString sCachePath(const QString& srcPath);
+private:
+    void buildLevels();
+    //! @brief Keeps the most recently used pyramid files,
+    //! the ones of changed or removed sources are never used again.
+    static void sPruneCache(const QString& folder);
+
+    const int mSampleRate;
+    qint64 mSampleCount = 0;
+    QList<QVector<Peak>> mLevels;
+
+    float mBucketMin = 0;
+    float mBucketMax = 0;
+    int mBucketSamples = 0;
+};
+
+#endif // SOUNDPEAKS_H
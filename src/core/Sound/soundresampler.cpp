@@ -0,0 +1,308 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "soundresampler.h"
+#include <QtMath>
+extern "C" {
+    #include <libavutil/opt.h>
+    #include <libavutil/mathematics.h>
+}
+
+// results kept for mergers of neighbouring seconds
+#define MAX_RESAMPLED 4
+// planes passed to swr_convert with an offset
+#define MAX_PLANES 64
+
+SoundResampler::~SoundResampler() {
+    if(mSwrContext) swr_free(&mSwrContext);
+    freeBuffers();
+}
+
+//! @brief Output samples covering input samples [0, srcSample)
+static int outSamples(const int srcSample, const int srcSampleRate,
+                      const int dstSampleRate) {
+    const qint64 scaled = qint64(srcSample)*dstSampleRate;
+    // rounds towards negative infinity
+    const qint64 result = scaled >= 0 ? scaled/srcSampleRate :
+                          -((-scaled + srcSampleRate - 1)/srcSampleRate);
+    return static_cast<int>(result);
+}
+
+SampleRange SoundResampler::sResampledRange(const SampleRange& src,
+                                            const int srcSampleRate,
+                                            const qreal stretch) {
+    const int dstSampleRate = qRound(srcSampleRate*stretch);
+    // seconds tile the output without gaps or overlaps
+    return {outSamples(src.fMin, srcSampleRate, dstSampleRate),
+            outSamples(src.fMax + 1, srcSampleRate, dstSampleRate) - 1};
+}
+
+stdsptr<Samples> SoundResampler::resample(const Samples& src,
+                                          const Samples* prev,
+                                          const qreal stretch) {
+    QMutexLocker lock(&mMutex);
+    const int dstSampleRate = qRound(src.fSampleRate*stretch);
+    const bool changed = !mSwrContext ||
+                         mSrcSampleRate != src.fSampleRate ||
+                         mDstSampleRate != dstSampleRate ||
+                         mFormat != src.fFormat ||
+                         mChannelLayout != src.fChannelLayout;
+    if(changed) {
+        setup(src, dstSampleRate);
+    } else {
+        const int id = mResampledSrc.indexOf(src.fSampleRange.fMin);
+        if(id != -1) return mResampled.at(id);
+    }
+    if(prev) {
+        const bool continued = prev->fSampleRange.fMax ==
+                               src.fSampleRange.fMin - 1;
+        const bool compatible = prev->fSampleRate == src.fSampleRate &&
+                                prev->fFormat == src.fFormat &&
+                                prev->fChannelLayout == src.fChannelLayout;
+        if(!continued || !compatible) prev = nullptr;
+    }
+    const bool continues = mNextSrc == src.fSampleRange.fMin;
+    if(!prev && !continues) prev = findTail(src.fSampleRange.fMin);
+    const auto result = convert(src, prev);
+
+    if(mTails.count() >= MAX_RESAMPLED) mTails.removeFirst();
+    const int tailMin = qMax(src.fSampleRange.fMin,
+                             src.fSampleRange.fMax - mPrimeSamples + 1);
+    mTails << src.mid({tailMin, src.fSampleRange.fMax});
+
+    // results missing the preceding samples are not reused,
+    // unless at the start of the sound
+    if(!continues && !prev && src.fSampleRange.fMin > 0) return result;
+    if(mResampled.count() >= MAX_RESAMPLED) {
+        mResampled.removeFirst();
+        mResampledSrc.removeFirst();
+    }
+    mResampled << result;
+    mResampledSrc << src.fSampleRange.fMin;
+    return result;
+}
+
+void SoundResampler::setup(const Samples& src, const int dstSampleRate) {
+    mResampled.clear();
+    mResampledSrc.clear();
+    mTails.clear();
+    freeBuffers();
+    mNextSrc = INT_MIN;
+    mSrcSampleRate = 0;
+    const int chCount = static_cast<int>(src.fNChannels);
+    if((src.fPlanar ? chCount : 1) > MAX_PLANES)
+        RuntimeThrow("Too many channels to resample");
+    if(!mSwrContext) mSwrContext = swr_alloc();
+    if(!mSwrContext) RuntimeThrow("Could not allocate resampler");
+    const auto chLayout = static_cast<int64_t>(src.fChannelLayout);
+    av_opt_set_int(mSwrContext, "in_channel_count", chCount, 0);
+    av_opt_set_int(mSwrContext, "out_channel_count", chCount, 0);
+    av_opt_set_int(mSwrContext, "in_channel_layout", chLayout, 0);
+    av_opt_set_int(mSwrContext, "out_channel_layout", chLayout, 0);
+    av_opt_set_int(mSwrContext, "in_sample_rate", src.fSampleRate, 0);
+    av_opt_set_int(mSwrContext, "out_sample_rate", dstSampleRate, 0);
+    av_opt_set_sample_fmt(mSwrContext, "in_sample_fmt", src.fFormat, 0);
+    av_opt_set_sample_fmt(mSwrContext, "out_sample_fmt", src.fFormat,  0);
+    if(swr_init(mSwrContext) < 0)
+        RuntimeThrow("Resampler has not been properly initialized");
+    mDstSampleRate = dstSampleRate;
+    mFormat = src.fFormat;
+    mChannelLayout = src.fChannelLayout;
+    mNChannels = chCount;
+    mNPlanes = src.fPlanar ? chCount : 1;
+    mPlaneSampleBytes = static_cast<int>(src.fSampleSize)*
+                        (src.fPlanar ? 1 : chCount);
+    mSrcSampleRate = src.fSampleRate;
+    try {
+        measureLatency();
+    } catch(...) {
+        mSrcSampleRate = 0;
+        RuntimeThrow("Could not measure resampler latency");
+    }
+    int linesize;
+    if(av_samples_alloc_array_and_samples(&mSilence, &linesize, mNChannels,
+                                          mPrimeSamples, mFormat, 0) < 0) {
+        mSrcSampleRate = 0;
+        RuntimeThrow("Could not allocate resampler buffers");
+    }
+    av_samples_set_silence(mSilence, 0, mPrimeSamples, mNChannels, mFormat);
+    // a whole primed second without reallocating
+    ensurePendingCapacity(outSamples(mPrimeSamples + mSrcSampleRate,
+                                     mSrcSampleRate, mDstSampleRate) + 256);
+}
+
+void SoundResampler::freeBuffers() {
+    if(mSilence) {
+        av_freep(&mSilence[0]);
+        av_freep(&mSilence);
+    }
+    if(mPending) {
+        av_freep(&mPending[0]);
+        av_freep(&mPending);
+    }
+    mPendingCapacity = 0;
+    mPendingCount = 0;
+}
+
+void SoundResampler::measureLatency() {
+    const int gcd = static_cast<int>(av_gcd(mSrcSampleRate, mDstSampleRate));
+    // input samples per whole number of output samples, starting
+    // the input on a multiple keeps the output on the same grid
+    const int unit = mSrcSampleRate/gcd;
+    const int nIn = unit*qMax(1, (4096 + unit - 1)/unit);
+    const auto input = enve::make_shared<Samples>(
+                SampleRange{0, nIn - 1}, mSrcSampleRate,
+                mFormat, mChannelLayout);
+    input->zeroAll();
+    const int expected = outSamples(nIn, mSrcSampleRate, mDstSampleRate);
+    const auto output = enve::make_shared<Samples>(
+                SampleRange{0, expected - 1}, mDstSampleRate,
+                mFormat, mChannelLayout);
+    if(swr_init(mSwrContext) < 0)
+        RuntimeThrow("Resampler has not been properly initialized");
+    const int produced = swr_convert(
+                mSwrContext, output->fData, expected,
+                const_cast<const uint8_t**>(input->fData), nIn);
+    if(produced < 0) RuntimeThrow("Resampling failed");
+    mLatency = qMax(0, expected - produced);
+    const int latencyIn = (mLatency*mSrcSampleRate + mDstSampleRate - 1)/
+                          mDstSampleRate;
+    int64_t filterSize = 32;
+    av_opt_get_int(mSwrContext, "filter_size", 0, &filterSize);
+    // the filter spans more input samples when downsampling
+    const qreal ratio = qreal(mDstSampleRate)/mSrcSampleRate;
+    const int taps = qCeil(filterSize/qMin(qreal(1), ratio));
+    // history of the filter taps preceding the first returned sample
+    const int history = 2*latencyIn + taps + 16;
+    mPrimeSamples = qMin(unit*((history + unit - 1)/unit),
+                         mSrcSampleRate);
+}
+
+const Samples* SoundResampler::findTail(const int srcSample) const {
+    for(const auto& tail : mTails) {
+        if(tail->fSampleRange.fMax == srcSample - 1) return tail.get();
+    }
+    return nullptr;
+}
+
+void SoundResampler::ensurePendingCapacity(const int n) {
+    if(n <= mPendingCapacity) return;
+    uchar** pending = nullptr;
+    int linesize;
+    if(av_samples_alloc_array_and_samples(&pending, &linesize, mNChannels,
+                                          n, mFormat, 0) < 0)
+        RuntimeThrow("Could not allocate resampler buffers");
+    if(mPending) {
+        av_samples_copy(pending, mPending, 0, 0, mPendingCount,
+                        mNChannels, mFormat);
+        av_freep(&mPending[0]);
+        av_freep(&mPending);
+    }
+    mPending = pending;
+    mPendingCapacity = n;
+}
+
+void SoundResampler::feed(const uchar * const * const data,
+                          const int offset, const int n) {
+    if(n <= 0) return;
+    ensurePendingCapacity(mPendingCount + swr_get_out_samples(mSwrContext, n));
+    const uint8_t* in[MAX_PLANES];
+    uint8_t* out[MAX_PLANES];
+    for(int i = 0; i < mNPlanes; i++) {
+        in[i] = data[i] + offset*mPlaneSampleBytes;
+        out[i] = mPending[i] + mPendingCount*mPlaneSampleBytes;
+    }
+    const int produced = swr_convert(mSwrContext, out,
+                                     mPendingCapacity - mPendingCount, in, n);
+    if(produced < 0) RuntimeThrow("Resampling failed");
+    mPendingCount += produced;
+}
+
+void SoundResampler::drain() {
+    mNextSrc = INT_MIN;
+    while(true) {
+        ensurePendingCapacity(mPendingCount + mLatency + 256);
+        uint8_t* out[MAX_PLANES];
+        for(int i = 0; i < mNPlanes; i++) {
+            out[i] = mPending[i] + mPendingCount*mPlaneSampleBytes;
+        }
+        const int flushed = swr_convert(mSwrContext, out,
+                                        mPendingCapacity - mPendingCount,
+                                        nullptr, 0);
+        if(flushed < 0) RuntimeThrow("Resampling failed");
+        if(flushed == 0) break;
+        mPendingCount += flushed;
+    }
+}
+
+void SoundResampler::dropPending(const int n) {
+    const int nDrop = qBound(0, n, mPendingCount);
+    if(nDrop == 0) return;
+    mPendingCount -= nDrop;
+    mPendingFirst += nDrop;
+    av_samples_copy(mPending, mPending, 0, nDrop, mPendingCount,
+                    mNChannels, mFormat);
+}
+
+void SoundResampler::restart(const int srcSample, const Samples* prev) {
+    if(swr_init(mSwrContext) < 0)
+        RuntimeThrow("Resampler has not been properly initialized");
+    mPendingCount = 0;
+    const int primeMin = srcSample - mPrimeSamples;
+    mPendingFirst = outSamples(primeMin, mSrcSampleRate, mDstSampleRate);
+    const SampleRange primeRange{primeMin, srcSample - 1};
+    const SampleRange known = prev ? prev->fSampleRange*primeRange :
+                                     SampleRange{0, -1};
+    if(known.isValid() && known.fMax == primeRange.fMax) {
+        // silence where the preceding samples are not known
+        feed(mSilence, 0, known.fMin - primeMin);
+        feed(prev->fData, known.fMin - prev->fSampleRange.fMin, known.span());
+    } else feed(mSilence, 0, mPrimeSamples);
+}
+
+stdsptr<Samples> SoundResampler::convert(const Samples& src,
+                                         const Samples* prev) {
+    const SampleRange& srcRange = src.fSampleRange;
+    if(mNextSrc != srcRange.fMin) restart(srcRange.fMin, prev);
+    // invalid until the whole second is through
+    mNextSrc = INT_MIN;
+    feed(src.fData, 0, srcRange.span());
+
+    const SampleRange dstRange{
+        outSamples(srcRange.fMin, mSrcSampleRate, mDstSampleRate),
+        outSamples(srcRange.fMax + 1, mSrcSampleRate, mDstSampleRate) - 1};
+    const int nOut = dstRange.span();
+    // the latency stays in the output
+    const int first = dstRange.fMin - mLatency;
+    dropPending(first - mPendingFirst);
+    // the end of the sound, drain the samples held by the filter
+    const bool complete = mPendingFirst + mPendingCount >= first + nOut;
+    if(!complete) drain();
+
+    const auto result = enve::make_shared<Samples>(
+                dstRange, mDstSampleRate, mFormat, mChannelLayout);
+    const int lead = qBound(0, mPendingFirst - first, nOut);
+    const int nCopy = qBound(0, mPendingCount, nOut - lead);
+    av_samples_set_silence(result->fData, 0, lead, mNChannels, mFormat);
+    av_samples_copy(result->fData, mPending, lead, 0, nCopy,
+                    mNChannels, mFormat);
+    av_samples_set_silence(result->fData, lead + nCopy, nOut - lead - nCopy,
+                           mNChannels, mFormat);
+    dropPending(nCopy);
+    if(complete) mNextSrc = srcRange.fMax + 1;
+    return result;
+}
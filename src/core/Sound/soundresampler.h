@@ -0,0 +1,105 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SOUNDRESAMPLER_H
+#define SOUNDRESAMPLER_H
+#include <QMutex>
+#include <climits>
+#include "CacheHandlers/samples.h"
+extern "C" {
+    #include <libswresample/swresample.h>
+}
+
+//! @brief Resampler session of a time-stretched sound.
+//! Consecutive seconds are fed to one initialized context, so the filter
+//! state carries over the second boundaries. A second not following the
+//! previous one restarts the session primed with the tail of the
+//! preceding second, so the seconds can also be resampled in any order.
+//! Output is delayed by the filter latency and each second covers exactly
+//! its share of the output samples.
+//! Recent results are kept for the other mergers using the same second.
+class SoundResampler : public StdSelfRef {
+    e_OBJECT
+protected:
+    SoundResampler() {}
+public:
+    ~SoundResampler();
+
+    //! @brief Thread-safe, src holds one second of samples,
+    //! prev the preceding second of the same sound if available.
+    stdsptr<Samples> resample(const Samples& src, const Samples* prev,
+                              const qreal stretch);
+
+    //! @brief Range of the output samples resample returns for src.
+    static SampleRange sResampledRange(const SampleRange& src,
+                                       const int srcSampleRate,
+                                       const qreal stretch);
+private:
+    void setup(const Samples& src, const int dstSampleRate);
+    void freeBuffers();
+    //! @brief Measures the filter latency and picks the priming length.
+    void measureLatency();
+    stdsptr<Samples> convert(const Samples& src, const Samples* prev);
+    //! @brief Reinitializes the context and feeds it the mPrimeSamples
+    //! preceding srcSample, silence where prev does not have them.
+    void restart(const int srcSample, const Samples* prev);
+    //! @brief Converts n input samples starting at offset into mPending.
+    void feed(const uchar * const * const data,
+              const int offset, const int n);
+    //! @brief Flushes the samples held by the filter, ends the session.
+    void drain();
+    //! @brief Drops the first n pending samples.
+    void dropPending(const int n);
+    void ensurePendingCapacity(const int n);
+    const Samples* findTail(const int srcSample) const;
+
+    QMutex mMutex;
+    SwrContext* mSwrContext = nullptr;
+    int mSrcSampleRate = 0;
+    int mDstSampleRate = 0;
+    AVSampleFormat mFormat = AV_SAMPLE_FMT_NONE;
+    uint64_t mChannelLayout = 0;
+    int mNChannels = 0;
+    int mNPlanes = 0;
+    //! @brief Bytes of a single sample within a plane
+    int mPlaneSampleBytes = 0;
+    //! @brief Output samples held back by the filter
+    int mLatency = 0;
+    //! @brief Preceding input samples fed on restart,
+    //! a multiple of the input samples per whole output sample
+    int mPrimeSamples = 0;
+    uchar** mSilence = nullptr;
+
+    //! @brief First source sample of the next consecutive second,
+    //! INT_MIN if the session has to be restarted
+    int mNextSrc = INT_MIN;
+    //! @brief Converted samples not returned yet
+    uchar** mPending = nullptr;
+    int mPendingCapacity = 0;
+    int mPendingCount = 0;
+    //! @brief Output sample of the first pending sample
+    int mPendingFirst = 0;
+
+    QList<stdsptr<Samples>> mResampled;
+    //! @brief First source sample of each of mResampled
+    QList<int> mResampledSrc;
+    //! @brief Last mPrimeSamples of recently resampled seconds,
+    //! used if the preceding second is not passed
+    QList<stdsptr<Samples>> mTails;
+};
+
+#endif // SOUNDRESAMPLER_H
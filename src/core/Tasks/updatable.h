@@ -60,6 +60,8 @@ public:
                             SwitchableContext &context) = 0;
     virtual void process() = 0;
 
+    //! @brief Called after each cpu, gpu or hdd processing step,
+    //! return true to be queued again with queTaskNow instead of finishing.
     virtual bool nextStep() { return false; }
 
     bool queTask();
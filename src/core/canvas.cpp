@@ -366,12 +366,21 @@ FrameRange Canvas::prp_getIdenticalRelRange(const int relFrame) const {
     return groupRange;//*canvasRange;
 }
 
+stdsptr<BoxRenderData> Canvas::queOutputFrame(const int relFrame) {
+    if(mSceneFramesHandler.atFrame(relFrame)) return nullptr;
+    const auto current = mRenderDataHandler.getItemAtRelFrame(relFrame);
+    if(current) return current->ref<BoxRenderData>();
+    return queRender(relFrame);
+}
+
 void Canvas::renderDataFinished(BoxRenderData *renderData) {
     const bool currentState = renderData->fBoxStateId == mStateId;
     if(currentState) mRenderDataHandler.removeItemAtRelFrame(renderData->fRelFrame);
     else if(renderData->fBoxStateId < mLastStateId) return;
     const int relFrame = qRound(renderData->fRelFrame);
     mLastStateId = renderData->fBoxStateId;
+    const auto canvasData = static_cast<CanvasRenderData*>(renderData);
+    mRenderBase = canvasData->makeRenderBase();
 
     const auto range = prp_getIdenticalRelRange(relFrame);
     const auto cont = enve::make_shared<SceneFrameContainer>(
@@ -409,6 +409,7 @@ public:
         canvasData->fBgColor = toSkColor(mBackgroundColor->getColor());
         canvasData->fCanvasHeight = mHeight;
         canvasData->fCanvasWidth = mWidth;
+        canvasData->fRenderBase = mRenderBase;
     }
 
     bool clipToCanvas() { return mClipToCanvasSize; }
@@ -523,6 +524,10 @@ public:
     void renderDataFinished(BoxRenderData *renderData);
     FrameRange prp_getIdenticalRelRange(const int relFrame) const;
 
+    //! @brief Schedules rendering of relFrame independently of the current
+    //! frame, returns nullptr if the frame is already cached.
+    stdsptr<BoxRenderData> queOutputFrame(const int relFrame);
+
     void writeBoundingBox(eWriteStream& dst);
     void readBoundingBox(eReadStream& src);
     bool anim_prevRelFrameWithKey(const int relFrame, int &prevRelFrame);
@@ -634,6 +639,8 @@ protected:
 
     uint mLastStateId = 0;
     HddCachableCacheHandler mSceneFramesHandler;
+    //! @brief Last finished render, edits redraw only what differs from it
+    stdsptr<SceneRenderBase> mRenderBase;
 
     qsptr<ColorAnimator> mBackgroundColor = enve::make_shared<ColorAnimator>();
 
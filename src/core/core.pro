@@ -87,6 +87,7 @@ SOURCES += \
     Boxes/boxrendercontainer.cpp \
     Boxes/boxrenderdata.cpp \
     Boxes/boxwithpatheffects.cpp \
+    Boxes/brushstrokesubtaskspawner.cpp \
     Boxes/canvasrenderdata.cpp \
     Boxes/circle.cpp \
     Boxes/containerbox.cpp \
@@ -111,6 +112,7 @@ SOURCES += \
     Boxes/textbox.cpp \
     Boxes/videobox.cpp \
     Boxes/waitingforboxload.cpp \
+    CacheHandlers/boxframecontainer.cpp \
     CacheHandlers/cachecontainer.cpp \
     CacheHandlers/hddcachablecachehandler.cpp \
     CacheHandlers/hddcachablerangecont.cpp \
@@ -120,6 +122,7 @@ SOURCES += \
     CacheHandlers/soundcachecontainer.cpp \
     CacheHandlers/soundcachehandler.cpp \
     CacheHandlers/soundtmpfilehandlers.cpp \
+    CacheHandlers/cachearena.cpp \
     CacheHandlers/tmpdeleter.cpp \
     CacheHandlers/tmploader.cpp \
     CacheHandlers/tmpsaver.cpp \
@@ -130,8 +133,10 @@ SOURCES += \
     FileCacheHandlers/filedatacachehandler.cpp \
     FileCacheHandlers/imagecachehandler.cpp \
     FileCacheHandlers/imagesequencecachehandler.cpp \
+    FileCacheHandlers/soundpeaksreader.cpp \
     FileCacheHandlers/soundreader.cpp \
     FileCacheHandlers/videocachehandler.cpp \
+    FileCacheHandlers/videoframeconverter.cpp \
     FileCacheHandlers/videoframeloader.cpp \
     FileCacheHandlers/videostreamsdata.cpp \
     GUI/boxeslistactionbutton.cpp \
@@ -150,6 +155,7 @@ SOURCES += \
     Paint/brushcontexedwrapper.cpp \
     Paint/brushescontext.cpp \
     Paint/brushstroke.cpp \
+    Paint/brushstrokeworker.cpp \
     Paint/colorconversions.cpp \
     Paint/drawableautotiledsurface.cpp \
     Paint/onionskin.cpp \
@@ -169,6 +175,7 @@ SOURCES += \
     PathEffects/subpatheffect.cpp \
     PathEffects/sumpatheffect.cpp \
     PathEffects/zigzagpatheffect.cpp \
+    Private/Tasks/cputaskpool.cpp \
     Private/Tasks/gpupostprocessor.cpp \
     Private/Tasks/offscreenqgl33c.cpp \
     Private/Tasks/taskexecutor.cpp \
@@ -194,6 +201,7 @@ SOURCES += \
     ShaderEffects/shadereffectcaller.cpp \
     ShaderEffects/shadereffectcreator.cpp \
     ShaderEffects/shadereffectprogram.cpp \
+    ShaderEffects/shaderexpression.cpp \
     ShaderEffects/shadervaluehandler.cpp \
     ShaderEffects/uniformspecifiercreator.cpp \
     Sound/esound.cpp \
@@ -202,6 +210,9 @@ SOURCES += \
     Sound/singlesound.cpp \
     Sound/soundcomposition.cpp \
     Sound/soundmerger.cpp \
+    Sound/soundmixing.cpp \
+    Sound/soundpeaks.cpp \
+    Sound/soundresampler.cpp \
     Tasks/updatable.cpp \
     Timeline/animationrect.cpp \
     Timeline/durationrectangle.cpp \
@@ -268,6 +279,8 @@ SOURCES += \
     Animators/steppedanimator.cpp \
     differsinterpolate.cpp \
     skia/skiahelpers.cpp \
+    skia/pixelbufferpool.cpp \
+    skia/pixelruncodec.cpp \
     Animators/keyt.cpp \
     Animators/basedkeyt.cpp \
     Animators/graphkeyt.cpp \
@@ -324,6 +337,7 @@ HEADERS += \
     Boxes/boxrendercontainer.h \
     Boxes/boxrenderdata.h \
     Boxes/boxwithpatheffects.h \
+    Boxes/brushstrokesubtaskspawner.h \
     Boxes/canvasrenderdata.h \
     Boxes/circle.h \
     Boxes/containerbox.h \
@@ -349,6 +363,7 @@ HEADERS += \
     Boxes/textbox.h \
     Boxes/videobox.h \
     Boxes/waitingforboxload.h \
+    CacheHandlers/boxframecontainer.h \
     CacheHandlers/cachecontainer.h \
     CacheHandlers/hddcachablecachehandler.h \
     CacheHandlers/hddcachablecont.h \
@@ -359,6 +374,7 @@ HEADERS += \
     CacheHandlers/soundcachecontainer.h \
     CacheHandlers/soundcachehandler.h \
     CacheHandlers/soundtmpfilehandlers.h \
+    CacheHandlers/cachearena.h \
     CacheHandlers/tmpdeleter.h \
     CacheHandlers/tmploader.h \
     CacheHandlers/tmpsaver.h \
@@ -371,8 +387,10 @@ HEADERS += \
     FileCacheHandlers/filedatacachehandler.h \
     FileCacheHandlers/imagecachehandler.h \
     FileCacheHandlers/imagesequencecachehandler.h \
+    FileCacheHandlers/soundpeaksreader.h \
     FileCacheHandlers/soundreader.h \
     FileCacheHandlers/videocachehandler.h \
+    FileCacheHandlers/videoframeconverter.h \
     FileCacheHandlers/videoframeloader.h \
     FileCacheHandlers/videostreamsdata.h \
     GUI/boxeslistactionbutton.h \
@@ -391,6 +409,7 @@ HEADERS += \
     Paint/brushcontexedwrapper.h \
     Paint/brushescontext.h \
     Paint/brushstroke.h \
+    Paint/brushstrokeworker.h \
     Paint/colorconversions.h \
     Paint/drawableautotiledsurface.h \
     Paint/onionskin.h \
@@ -412,12 +431,14 @@ HEADERS += \
     PathEffects/subpatheffect.h \
     PathEffects/sumpatheffect.h \
     PathEffects/zigzagpatheffect.h \
+    Private/Tasks/cputaskpool.h \
     Private/Tasks/gpupostprocessor.h \
     Private/Tasks/offscreenqgl33c.h \
     Private/Tasks/taskexecutor.h \
     Private/Tasks/taskque.h \
     Private/Tasks/taskquehandler.h \
     Private/Tasks/taskscheduler.h \
+    Private/Tasks/workstealingdeque.h \
     Private/document.h \
     Private/esettings.h \
     Private/memorystructs.h \
@@ -441,6 +462,7 @@ HEADERS += \
     ShaderEffects/shadereffectcaller.h \
     ShaderEffects/shadereffectcreator.h \
     ShaderEffects/shadereffectprogram.h \
+    ShaderEffects/shaderexpression.h \
     ShaderEffects/shaderpropertycreator.h \
     ShaderEffects/shadervaluehandler.h \
     ShaderEffects/uniformspecifiercreator.h \
@@ -450,6 +472,9 @@ HEADERS += \
     Sound/singlesound.h \
     Sound/soundcomposition.h \
     Sound/soundmerger.h \
+    Sound/soundmixing.h \
+    Sound/soundpeaks.h \
+    Sound/soundresampler.h \
     Tasks/updatable.h \
     Timeline/animationrect.h \
     Timeline/durationrectangle.h \
@@ -520,6 +545,8 @@ HEADERS += \
     Animators/steppedanimator.h \
     differsinterpolate.h \
     skia/skiahelpers.h \
+    skia/pixelbufferpool.h \
+    skia/pixelruncodec.h \
     Animators/keyt.h \
     Animators/basedkeyt.h \
     Animators/graphkeyt.h \
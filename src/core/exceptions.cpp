@@ -81,7 +81,14 @@ QString gAllTextFromException(const std::exception &e,
     return allText;
 }
 
+static bool gErrorDialogsEnabled = true;
+
+void gSetErrorDialogsEnabled(const bool enabled) {
+    gErrorDialogsEnabled = enabled;
+}
+
 void gPrintException(const bool fatal, const QString &allText) {
+    if(!gErrorDialogsEnabled) return;
     const QString txt = fatal ? "Fatal" : "Critical";
     QMessageBox(QMessageBox::Critical, txt + " Error", allText).exec();
 }
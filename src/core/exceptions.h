@@ -62,5 +62,8 @@ extern void gPrintExceptionFatal(const std::exception& e);
 extern void gPrintException(const bool fatal, const QString& allText);
 extern void gPrintExceptionCritical(const std::exception_ptr& eptr);
 extern void gPrintExceptionFatal(const std::exception_ptr& eptr);
+//! @brief When disabled errors are only written to the log,
+//! for use without a user to dismiss the message boxes.
+extern void gSetErrorDialogsEnabled(const bool enabled);
 
 #endif // EXCEPTIONS_H
@@ -175,3 +175,13 @@ void iniProgram(QGL33 * const gl, GLuint& program,
     gl->glDeleteShader(vertexShader);
     gl->glDeleteShader(fragmentShader);
 }
+
+QJSEngine& GpuRenderData::jsEngine() {
+    if(mJSEngine) return *mJSEngine;
+    mJSEngine = std::make_shared<QJSEngine>();
+    mJSEngine->evaluate("eTexSize = [" + QString::number(fWidth) + "," +
+                        QString::number(fHeight) + "]");
+    mJSEngine->evaluate("eGlobalPos = [" + QString::number(fPosX) + "," +
+                        QString::number(fPosY) + "]");
+    return *mJSEngine;
+}
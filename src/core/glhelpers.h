@@ -71,9 +71,13 @@ struct CpuRenderData {
 };
 
 #include <QJSEngine>
+#include <memory>
 struct GpuRenderData : public CpuRenderData {
-    //! @brief Used for shader based effects
-    QJSEngine fJSEngine;
+    //! @brief Used for shader effects with scripts that could not be
+    //! compiled, created with eTexSize and eGlobalPos set on first use
+    QJSEngine& jsEngine();
+private:
+    std::shared_ptr<QJSEngine> mJSEngine;
 };
 
 #endif // GLHELPERS_H
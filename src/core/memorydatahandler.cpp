@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "memorydatahandler.h"
+#include "CacheHandlers/cachecontainer.h"
 
 MemoryDataHandler *MemoryDataHandler::sInstance = nullptr;
 
@@ -23,15 +24,64 @@ MemoryDataHandler::MemoryDataHandler() {
     sInstance = this;
 }
 
+bool MemoryDataHandler::isListed(const CacheContainer * const cont) const {
+    return cont->mLruPrev || mOldest == cont;
+}
+
 void MemoryDataHandler::addContainer(CacheContainer * const cont) {
-    mContainers << cont;
+    if(isListed(cont)) removeContainer(cont);
+    cont->mLruPrev = mNewest;
+    cont->mLruNext = nullptr;
+    if(mNewest) mNewest->mLruNext = cont;
+    else mOldest = cont;
+    mNewest = cont;
+    mCount++;
 }
 
 void MemoryDataHandler::removeContainer(CacheContainer * const cont) {
-    mContainers.removeOne(cont);
+    // taken containers are still flagged as handled by CacheContainer
+    if(!isListed(cont)) return;
+    if(cont->mLruPrev) cont->mLruPrev->mLruNext = cont->mLruNext;
+    else mOldest = cont->mLruNext;
+    if(cont->mLruNext) cont->mLruNext->mLruPrev = cont->mLruPrev;
+    else mNewest = cont->mLruPrev;
+    cont->mLruPrev = nullptr;
+    cont->mLruNext = nullptr;
+    mCount--;
 }
 
 void MemoryDataHandler::containerUpdated(CacheContainer * const cont) {
     removeContainer(cont);
     addContainer(cont);
 }
+
+// number of the oldest containers considered for each eviction
+#define EVICTION_CANDIDATES 16
+
+CacheContainer* MemoryDataHandler::takeNextToFree() {
+    CacheContainer* best = nullptr;
+    qreal bestScore = 0;
+    int rank = 0;
+    for(auto cont = mOldest; cont && rank < EVICTION_CANDIDATES;
+        cont = cont->mLruNext, rank++) {
+        const qreal score = sEvictionScore(cont, rank);
+        if(!best || score > bestScore) {
+            best = cont;
+            bestScore = score;
+        }
+    }
+    if(best) removeContainer(best);
+    return best;
+}
+
+qreal MemoryDataHandler::sEvictionScore(const CacheContainer * const cont,
+                                        const int ageRank) {
+    // older, further from the frames in use, and cheaper to get back
+    // means better to free
+    const qreal age = EVICTION_CANDIDATES - ageRank;
+    const qreal distance = 1 + 0.1*cont->frameDistance();
+    const qreal hdd = cont->hasHddCopy() ? 4 : 1;
+    const qreal costMs = 0.001*cont->recreateCostUs();
+    const qreal cost = 1 + costMs/16;
+    return age*distance*hdd/cost;
+}
@@ -16,10 +16,14 @@
 
 #ifndef MEMORYDATAHANDLER_H
 #define MEMORYDATAHANDLER_H
-#include <QList>
+#include <QtGlobal>
 
 class CacheContainer;
 
+//! @brief Least recently used list of cache containers not in use.
+//! Eviction picks among the oldest entries, weighting them
+//! by recreation cost, distance from the frames in use,
+//! and whether they can be reloaded from the hdd cache.
 class MemoryDataHandler {
 public:
     MemoryDataHandler();
@@ -30,12 +34,20 @@ public:
     void removeContainer(CacheContainer * const cont);
     void containerUpdated(CacheContainer * const cont);
 
-    bool isEmpty() const { return mContainers.isEmpty(); }
-    CacheContainer* takeFirst() {
-        return mContainers.takeFirst();
-    }
+    bool isEmpty() const { return !mOldest; }
+    int count() const { return mCount; }
+
+    //! @brief Removes and returns the container to be freed next.
+    CacheContainer* takeNextToFree();
 private:
-    QList<CacheContainer*> mContainers;
+    bool isListed(const CacheContainer * const cont) const;
+
+    static qreal sEvictionScore(const CacheContainer * const cont,
+                                const int ageRank);
+
+    CacheContainer* mOldest = nullptr;
+    CacheContainer* mNewest = nullptr;
+    int mCount = 0;
 };
 
 #endif // MEMORYDATAHANDLER_H
@@ -0,0 +1,113 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "pixelbufferpool.h"
+
+// smaller buffers are cheap enough for malloc
+#define MIN_POOLED_BYTES (256*1024)
+
+bool PixelBufferPool::sAllocPixels(SkBitmap& bitmap,
+                                   const SkImageInfo& info) {
+    const size_t rowBytes = info.minRowBytes();
+    const size_t bytes = info.computeByteSize(rowBytes);
+    if(bytes < MIN_POOLED_BYTES) return bitmap.tryAllocPixels(info);
+    const size_t classSize = sClassSize(bytes);
+    void* addr = sInstance().take(classSize);
+    if(!addr) addr = malloc(classSize);
+    if(!addr) return false;
+    const auto context = reinterpret_cast<void*>(classSize);
+    return bitmap.installPixels(info, addr, rowBytes, &sRelease, context);
+}
+
+qint64 PixelBufferPool::sTrim(const qint64 bytes) {
+    return sInstance().trim(bytes);
+}
+
+qint64 PixelBufferPool::sPooledBytes() {
+    auto& pool = sInstance();
+    QMutexLocker lock(&pool.mMutex);
+    return pool.mPooledBytes;
+}
+
+void PixelBufferPool::sSetMaxPooledBytes(const qint64 bytes) {
+    auto& pool = sInstance();
+    {
+        QMutexLocker lock(&pool.mMutex);
+        pool.mMaxPooledBytes = bytes;
+    }
+    const qint64 excess = sPooledBytes() - bytes;
+    if(excess > 0) pool.trim(excess);
+}
+
+PixelBufferPool& PixelBufferPool::sInstance() {
+    static PixelBufferPool instance;
+    return instance;
+}
+
+void PixelBufferPool::sRelease(void* addr, void* context) {
+    const auto classSize = reinterpret_cast<size_t>(context);
+    sInstance().give(addr, classSize);
+}
+
+size_t PixelBufferPool::sClassSize(const size_t bytes) {
+    // classes at 2^n and 1.5*2^n, wasting at most a third of a buffer
+    size_t pow2 = MIN_POOLED_BYTES;
+    while(pow2 < bytes) pow2 <<= 1;
+    const size_t threeQuarters = pow2 - pow2/4;
+    return bytes <= threeQuarters ? threeQuarters : pow2;
+}
+
+void* PixelBufferPool::take(const size_t classSize) {
+    QMutexLocker lock(&mMutex);
+    const auto it = mBuffers.find(classSize);
+    if(it == mBuffers.end() || it->isEmpty()) return nullptr;
+    mPooledBytes -= static_cast<qint64>(classSize);
+    return it->takeLast();
+}
+
+void PixelBufferPool::give(void * const addr, const size_t classSize) {
+    {
+        QMutexLocker lock(&mMutex);
+        const qint64 size = static_cast<qint64>(classSize);
+        if(mPooledBytes + size <= mMaxPooledBytes) {
+            mBuffers[classSize] << addr;
+            mPooledBytes += size;
+            return;
+        }
+    }
+    free(addr);
+}
+
+qint64 PixelBufferPool::trim(const qint64 bytes) {
+    QVector<void*> toFree;
+    qint64 freed = 0;
+    {
+        QMutexLocker lock(&mMutex);
+        // largest buffers first, they are the least likely to be reused
+        auto it = mBuffers.end();
+        while(freed < bytes && it != mBuffers.begin()) {
+            it--;
+            const qint64 size = static_cast<qint64>(it.key());
+            while(freed < bytes && !it->isEmpty()) {
+                toFree << it->takeLast();
+                freed += size;
+            }
+        }
+        mPooledBytes -= freed;
+    }
+    for(const auto addr : toFree) free(addr);
+    return freed;
+}
@@ -0,0 +1,59 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PIXELBUFFERPOOL_H
+#define PIXELBUFFERPOOL_H
+#include "skiaincludes.h"
+#include <QMutex>
+#include <QMap>
+#include <QVector>
+
+//! @brief Thread-safe pool of large pixel buffers grouped in size classes.
+//! Buffers return to the pool once the bitmap (or the SkImage made
+//! from it) releasing them is destroyed.
+class PixelBufferPool {
+public:
+    //! @brief Allocates pixels for the bitmap, reusing a pooled buffer
+    //! when one of a matching size class is available.
+    //! Pixels are not initialized.
+    static bool sAllocPixels(SkBitmap& bitmap, const SkImageInfo& info);
+
+    //! @brief Frees at least the given number of pooled bytes
+    //! (or all of them), returns the number of bytes freed.
+    static qint64 sTrim(const qint64 bytes);
+    static qint64 sPooledBytes();
+
+    //! @brief Buffers returned beyond the limit are freed right away.
+    static void sSetMaxPooledBytes(const qint64 bytes);
+private:
+    PixelBufferPool() {}
+
+    static PixelBufferPool& sInstance();
+    static void sRelease(void* addr, void* context);
+
+    static size_t sClassSize(const size_t bytes);
+
+    void* take(const size_t classSize);
+    void give(void* const addr, const size_t classSize);
+    qint64 trim(const qint64 bytes);
+
+    QMutex mMutex;
+    QMap<size_t, QVector<void*>> mBuffers;
+    qint64 mPooledBytes = 0;
+    qint64 mMaxPooledBytes = 256*1024*1024;
+};
+
+#endif // PIXELBUFFERPOOL_H
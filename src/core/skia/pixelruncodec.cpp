@@ -0,0 +1,134 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "pixelruncodec.h"
+#include "pixelbufferpool.h"
+#include "skiahelpers.h"
+#include "exceptions.h"
+#include <algorithm>
+
+// shorter runs are cheaper to store verbatim
+#define MIN_RUN 3
+
+namespace {
+    struct Header {
+        qint32 fWidth;
+        qint32 fHeight;
+    };
+
+    // packet tag: (count << 1) | isRun,
+    // a run is followed by one pixel, a literal by count pixels
+    inline void appendTag(QByteArray& dst, const quint32 count,
+                          const bool run) {
+        const quint32 tag = (count << 1) | (run ? 1 : 0);
+        dst.append(reinterpret_cast<const char*>(&tag), sizeof(quint32));
+    }
+
+    inline void appendPixels(QByteArray& dst, const quint32* const src,
+                             const quint32 count) {
+        dst.append(reinterpret_cast<const char*>(src),
+                   static_cast<int>(count*sizeof(quint32)));
+    }
+
+    void encodeRow(QByteArray& dst, const quint32* const row,
+                   const int width) {
+        int literalStart = 0;
+        int i = 0;
+        while(i < width) {
+            const quint32 pixel = row[i];
+            int runEnd = i + 1;
+            while(runEnd < width && row[runEnd] == pixel) runEnd++;
+            const int runLength = runEnd - i;
+            if(runLength < MIN_RUN) {
+                i = runEnd;
+                continue;
+            }
+            const int literalLength = i - literalStart;
+            if(literalLength > 0) {
+                appendTag(dst, literalLength, false);
+                appendPixels(dst, row + literalStart, literalLength);
+            }
+            appendTag(dst, runLength, true);
+            appendPixels(dst, &pixel, 1);
+            i = runEnd;
+            literalStart = runEnd;
+        }
+        const int literalLength = width - literalStart;
+        if(literalLength > 0) {
+            appendTag(dst, literalLength, false);
+            appendPixels(dst, row + literalStart, literalLength);
+        }
+    }
+}
+
+QByteArray PixelRunCodec::encode(const SkPixmap& pix) {
+    Q_ASSERT(pix.info().bytesPerPixel() == 4);
+    const Header header{pix.width(), pix.height()};
+    QByteArray result;
+    // typical frames with some transparency compress below half
+    result.reserve(static_cast<int>(pix.computeByteSize()/2));
+    result.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+    for(int y = 0; y < pix.height(); y++) {
+        const auto row = static_cast<const quint32*>(pix.addr(0, y));
+        encodeRow(result, row, pix.width());
+    }
+    return result;
+}
+
+sk_sp<SkImage> PixelRunCodec::decodeImage(const QByteArray& data) {
+    if(data.size() < static_cast<int>(sizeof(Header)))
+        RuntimeThrow("Corrupted pixel data");
+    Header header;
+    memcpy(&header, data.constData(), sizeof(Header));
+    if(header.fWidth <= 0 || header.fHeight <= 0)
+        RuntimeThrow("Corrupted pixel data");
+    SkBitmap bitmap;
+    const auto info = SkiaHelpers::getPremulRGBAInfo(header.fWidth,
+                                                     header.fHeight);
+    if(!PixelBufferPool::sAllocPixels(bitmap, info))
+        RuntimeThrow("Failed to allocate pixels");
+
+    const char* src = data.constData() + sizeof(Header);
+    const char* const srcEnd = data.constData() + data.size();
+    for(int y = 0; y < header.fHeight; y++) {
+        auto dst = static_cast<quint32*>(bitmap.getAddr(0, y));
+        const auto dstEnd = dst + header.fWidth;
+        while(dst < dstEnd) {
+            if(srcEnd - src < static_cast<int>(sizeof(quint32)))
+                RuntimeThrow("Corrupted pixel data");
+            quint32 tag;
+            memcpy(&tag, src, sizeof(quint32));
+            src += sizeof(quint32);
+            const quint32 count = tag >> 1;
+            const bool run = tag & 1;
+            if(count == 0 || count > static_cast<quint32>(dstEnd - dst))
+                RuntimeThrow("Corrupted pixel data");
+            const qint64 srcBytes = (run ? 1 : count)*sizeof(quint32);
+            if(srcEnd - src < srcBytes)
+                RuntimeThrow("Corrupted pixel data");
+            if(run) {
+                quint32 pixel;
+                memcpy(&pixel, src, sizeof(quint32));
+                std::fill(dst, dst + count, pixel);
+            } else {
+                memcpy(dst, src, static_cast<size_t>(srcBytes));
+            }
+            src += srcBytes;
+            dst += count;
+        }
+    }
+    return SkiaHelpers::transferDataToSkImage(bitmap);
+}
@@ -0,0 +1,31 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PIXELRUNCODEC_H
+#define PIXELRUNCODEC_H
+#include "skiaincludes.h"
+#include <QByteArray>
+
+//! @brief Fast lossless codec for 32-bit pixel data.
+//! Repeated pixels, including transparent areas, are stored as runs,
+//! everything else is copied verbatim.
+namespace PixelRunCodec {
+    QByteArray encode(const SkPixmap& pix);
+    //! @brief Throws if the data is corrupted.
+    sk_sp<SkImage> decodeImage(const QByteArray& data);
+}
+
+#endif // PIXELRUNCODEC_H
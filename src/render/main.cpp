@@ -0,0 +1,362 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPainter>
+#include <QSurfaceFormat>
+#include <QTimer>
+#include "hardwareinfo.h"
+#include "Private/esettings.h"
+#include "Private/document.h"
+#include "efiltersettings.h"
+#include "importhandler.h"
+#include "effectsloader.h"
+#include "memoryhandler.h"
+#include "renderhandler.h"
+#include "renderinstancesettings.h"
+#include "videoencoder.h"
+#include "canvas.h"
+#include "Boxes/boundingbox.h"
+#include "Sound/esoundsettings.h"
+#include "ReadWrite/basicreadwrite.h"
+#include "ReadWrite/filefooter.h"
+#include "GUI/audiohandler.h"
+
+int FONT_HEIGHT;
+int MIN_WIDGET_DIM;
+int BUTTON_DIM;
+int KEY_RECT_SIZE;
+
+QPixmap* ALPHA_MESH_PIX;
+
+void setDefaultFormat() {
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    format.setStencilBufferSize(8);
+    format.setSamples(0);
+    QSurfaceFormat::setDefaultFormat(format);
+}
+
+//! @brief Same as MainWindow::loadEVFile, without the window layout.
+void loadEVFile(Document& document, const QString &path) {
+    QFile file(path);
+    if(!file.exists()) RuntimeThrow("File does not exist " + path);
+    if(!file.open(QIODevice::ReadOnly))
+        RuntimeThrow("Could not open file " + path);
+    try {
+        const int evVersion = FileFooter::sReadEvFileVersion(&file);
+        if(evVersion <= 0) RuntimeThrow("Incompatible or incomplete data");
+        eReadStream readStream(evVersion, &file);
+
+        const qint64 savedPos = file.pos();
+        const qint64 pos = file.size() - FileFooter::sSize(evVersion) -
+                qint64(sizeof(int));
+        file.seek(pos);
+        readStream.readFutureTable();
+        file.seek(savedPos);
+        readStream.readCheckpoint("File beginning pos mismatch");
+        document.read(readStream);
+        readStream.readCheckpoint("Error reading Document");
+    } catch(...) {
+        file.close();
+        RuntimeThrow("Error while reading from file " + path);
+    }
+    file.close();
+
+    BoundingBox::sClearReadBoxes();
+}
+
+Canvas* findScene(const Document& document, const QString& nameOrId) {
+    if(document.fScenes.isEmpty()) RuntimeThrow("Document has no scenes");
+    if(nameOrId.isEmpty()) return document.fScenes.first().get();
+    for(const auto& scene : document.fScenes) {
+        if(scene->prp_getName() == nameOrId) return scene.get();
+    }
+    bool ok;
+    const int id = nameOrId.toInt(&ok);
+    if(ok && id >= 0 && id < document.fScenes.count())
+        return document.fScenes.at(id).get();
+    RuntimeThrow("No scene named '" + nameOrId + "'");
+}
+
+//! @brief Default settings for the format deduced from the output extension.
+OutputSettings guessOutputSettings(const QString& path,
+                                   const qreal videoBitrateMbps,
+                                   const bool audio) {
+    OutputSettings settings;
+    const auto format = av_guess_format(nullptr, path.toUtf8().data(),
+                                        nullptr);
+    if(!format) RuntimeThrow("Could not deduce output format from " + path);
+    settings.outputFormat = format;
+
+    if(format->video_codec != AV_CODEC_ID_NONE) {
+        const auto codec = avcodec_find_encoder(format->video_codec);
+        if(codec) {
+            settings.videoEnabled = true;
+            settings.videoCodec = codec;
+            settings.videoPixelFormat = codec->pix_fmts ? codec->pix_fmts[0] :
+                                                          AV_PIX_FMT_YUV420P;
+            settings.videoBitrate = qRound(videoBitrateMbps*1000000);
+        }
+    }
+    if(!settings.videoEnabled)
+        RuntimeThrow("No video encoder available for '" +
+                     QString(format->name) + "'");
+
+    if(audio && format->audio_codec != AV_CODEC_ID_NONE) {
+        const auto codec = avcodec_find_encoder(format->audio_codec);
+        if(codec) {
+            settings.audioEnabled = true;
+            settings.audioCodec = codec;
+            settings.audioSampleFormat = codec->sample_fmts ?
+                        codec->sample_fmts[0] : AV_SAMPLE_FMT_FLTP;
+            settings.audioChannelsLayout = AV_CH_LAYOUT_STEREO;
+            settings.audioSampleRate = 44100;
+            settings.audioBitrate = 192000;
+        }
+    }
+    return settings;
+}
+
+stdsptr<OutputSettingsProfile> loadProfile(const QString& pathOrName) {
+    QString path = pathOrName;
+    if(!QFileInfo(path).exists()) {
+        path = eSettings::sSettingsDir() + "/OutputProfiles/" +
+                pathOrName + ".eProf";
+    }
+    if(!QFileInfo(path).exists())
+        RuntimeThrow("No output profile '" + pathOrName + "'");
+    const auto profile = enve::make_shared<OutputSettingsProfile>();
+    profile->load(path);
+    return profile;
+}
+
+FrameRange parseFrameRange(const QString& str) {
+    const auto minMax = str.split(':');
+    bool minOk = false;
+    bool maxOk = false;
+    if(minMax.count() == 2) {
+        const FrameRange range{minMax.first().toInt(&minOk),
+                               minMax.last().toInt(&maxOk)};
+        if(minOk && maxOk && range.fMin <= range.fMax) return range;
+    }
+    RuntimeThrow("Invalid frame range '" + str + "', expected first:last");
+}
+
+int main(int argc, char *argv[]) {
+    // render without a display unless told otherwise
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    setDefaultFormat();
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("enve-render");
+    gSetErrorDialogsEnabled(false);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render an enve scene to a video file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "The .ev file to render.");
+    const QCommandLineOption outputOpt({"o", "output"},
+            "Output file, format deduced from the extension.", "path");
+    const QCommandLineOption sceneOpt({"s", "scene"},
+            "Scene name or index, first scene by default.", "scene");
+    const QCommandLineOption framesOpt({"f", "frames"},
+            "Inclusive frame range, scene range by default.", "first:last");
+    const QCommandLineOption resolutionOpt({"r", "resolution"},
+            "Resolution in percent, 100 by default.", "percent", "100");
+    const QCommandLineOption profileOpt({"p", "profile"},
+            "Output settings profile, .eProf path or saved profile name.",
+            "profile");
+    const QCommandLineOption bitrateOpt("bitrate",
+            "Video bitrate in Mbps when no profile is used, 9 by default.",
+            "mbps", "9");
+    const QCommandLineOption noAudioOpt("no-audio",
+            "Do not encode audio when no profile is used.");
+    const QCommandLineOption cpuOpt("cpu",
+            "Do not use the gpu, render everything on the cpu.");
+    parser.addOptions({outputOpt, sceneOpt, framesOpt, resolutionOpt,
+                       profileOpt, bitrateOpt, noAudioOpt, cpuOpt});
+    parser.process(app);
+
+    const auto args = parser.positionalArguments();
+    if(args.count() != 1 || !parser.isSet(outputOpt)) {
+        qCritical() << "Expected an input file and an output path";
+        parser.showHelp(1);
+    }
+
+    FONT_HEIGHT = QApplication::fontMetrics().height();
+    MIN_WIDGET_DIM = FONT_HEIGHT*4/3;
+    BUTTON_DIM = qRound(MIN_WIDGET_DIM*1.1);
+    KEY_RECT_SIZE = MIN_WIDGET_DIM*3/5;
+    QPixmap alphaMeshPix;
+    {
+        const int dim = MIN_WIDGET_DIM/2;
+        alphaMeshPix = QPixmap(2*dim, 2*dim);
+        ALPHA_MESH_PIX = &alphaMeshPix;
+        const QColor light = QColor::fromRgbF(0.2, 0.2, 0.2);
+        const QColor dark = QColor::fromRgbF(0.4, 0.4, 0.4);
+        QPainter p(ALPHA_MESH_PIX);
+        p.fillRect(0, 0, dim, dim, light);
+        p.fillRect(dim, 0, dim, dim, dark);
+        p.fillRect(0, dim, dim, dim, dark);
+        p.fillRect(dim, dim, dim, dim, light);
+        p.end();
+    }
+
+    eSettings settings;
+    eFilterSettings filterSettings;
+    HardwareInfo::sUpdateInfo();
+    try {
+        settings.loadFromFile();
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+    }
+
+    ImportHandler importHandler;
+    TaskScheduler taskScheduler;
+    MemoryHandler memoryHandler;
+    bool gpu = !parser.isSet(cpuOpt);
+    if(gpu) {
+        try {
+            taskScheduler.initializeGpu();
+        } catch(const std::exception& e) {
+            gPrintExceptionCritical(e);
+            qWarning() << "No usable gpu, rendering on the cpu";
+            gpu = false;
+        }
+    }
+    Document document(taskScheduler);
+    Actions actions(document);
+
+    EffectsLoader effectsLoader;
+    if(gpu) {
+        try {
+            effectsLoader.initializeGpu();
+        } catch(const std::exception& e) {
+            gPrintExceptionCritical(e);
+        }
+    }
+    effectsLoader.iniCustomPathEffects();
+    effectsLoader.iniCustomRasterEffects();
+    // shader effects are gpu only, they are skipped when rendering on the cpu
+    if(gpu) effectsLoader.iniShaderEffects();
+    effectsLoader.iniCustomBoxes();
+
+    eSoundSettings soundSettings;
+    AudioHandler audioHandler;
+    const auto videoEncoder = enve::make_shared<VideoEncoder>();
+    RenderHandler renderHandler(document, audioHandler,
+                                *videoEncoder, memoryHandler);
+
+    Canvas* scene = nullptr;
+    stdsptr<OutputSettingsProfile> profile;
+    RenderSettings renderSettings;
+    OutputSettings outputSettings;
+    const QString outputPath = QFileInfo(parser.value(outputOpt)).absoluteFilePath();
+    try {
+        loadEVFile(document, args.first());
+        scene = findScene(document, parser.value(sceneOpt));
+        if(parser.isSet(profileOpt)) {
+            profile = loadProfile(parser.value(profileOpt));
+        } else {
+            bool ok;
+            const qreal bitrate = parser.value(bitrateOpt).toDouble(&ok);
+            if(!ok || bitrate <= 0)
+                RuntimeThrow("Invalid bitrate " + parser.value(bitrateOpt));
+            outputSettings = guessOutputSettings(outputPath, bitrate,
+                                                 !parser.isSet(noAudioOpt));
+        }
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+        return 1;
+    }
+
+    RenderInstanceSettings renderInstance(scene);
+    renderInstance.setOutputDestination(outputPath);
+    if(profile) renderInstance.setOutputSettingsProfile(profile.get());
+    else renderInstance.setOutputRenderSettings(outputSettings);
+
+    renderSettings = renderInstance.getRenderSettings();
+    try {
+        const auto range = parser.isSet(framesOpt) ?
+                    parseFrameRange(parser.value(framesOpt)) :
+                    scene->getFrameRange();
+        renderSettings.fMinFrame = range.fMin;
+        renderSettings.fMaxFrame = range.fMax;
+        bool ok;
+        const qreal percent = parser.value(resolutionOpt).toDouble(&ok);
+        if(!ok || percent <= 0)
+            RuntimeThrow("Invalid resolution " + parser.value(resolutionOpt));
+        renderSettings.fResolution = percent/100;
+        renderSettings.fVideoWidth = qRound(renderSettings.fBaseWidth*
+                                            renderSettings.fResolution);
+        renderSettings.fVideoHeight = qRound(renderSettings.fBaseHeight*
+                                             renderSettings.fResolution);
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+        return 1;
+    }
+    renderInstance.setRenderSettings(renderSettings);
+
+    const int nFrames = renderSettings.fMaxFrame - renderSettings.fMinFrame + 1;
+    QElapsedTimer timer;
+    QObject::connect(&renderInstance, &RenderInstanceSettings::renderFrameChanged,
+                     [&](const int frame) {
+        const int done = frame - renderSettings.fMinFrame;
+        const qreal secs = timer.elapsed()*0.001;
+        const qreal fps = secs > 0 ? done/secs : 0;
+        qInfo().noquote() << QString("Frame %1/%2 (%3 fps)").
+                             arg(done).arg(nFrames).arg(fps, 0, 'f', 2);
+    });
+
+    const auto emitter = videoEncoder->getEmitter();
+    QObject::connect(emitter, &VideoEncoderEmitter::encodingFinished, [&]() {
+        const qreal secs = timer.elapsed()*0.001;
+        qInfo().noquote() << QString("Rendered %1 frames in %2 s (%3 fps)").
+                             arg(nFrames).arg(secs, 0, 'f', 2).
+                             arg(secs > 0 ? nFrames/secs : 0, 0, 'f', 2);
+        app.exit(0);
+    });
+    const auto failed = [&]() {
+        qCritical().noquote() << "Rendering failed:" <<
+                                 renderInstance.getRenderError();
+        app.exit(1);
+    };
+    QObject::connect(emitter, &VideoEncoderEmitter::encodingStartFailed, failed);
+    QObject::connect(emitter, &VideoEncoderEmitter::encodingFailed, failed);
+    QObject::connect(emitter, &VideoEncoderEmitter::encodingInterrupted, [&]() {
+        qCritical() << "Rendering interrupted";
+        app.exit(2);
+    });
+
+    QTimer::singleShot(0, [&]() {
+        timer.start();
+        renderHandler.renderFromSettings(&renderInstance);
+    });
+
+    try {
+        return app.exec();
+    } catch(const std::exception& e) {
+        gPrintExceptionFatal(e);
+        return -1;
+    }
+}
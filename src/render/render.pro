@@ -0,0 +1,93 @@
+# enve - 2D animations software
+# Copyright (C) 2016-2019 Maurycy Liebner
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Headless command-line renderer, shares the render pipeline with the app
+
+VERSION = 0.0.0
+
+QT += multimedia core gui svg opengl sql qml xml concurrent
+LIBS += -lavutil -lavformat -lavcodec -lswscale -lswresample -lavresample
+CONFIG += c++14 console
+
+ENVE_FOLDER = $$PWD/../..
+SKIA_FOLDER = $$ENVE_FOLDER/third_party/skia
+LIBMYPAINT_FOLDER = $$ENVE_FOLDER/third_party/libmypaint-1.3.0
+GPERFTOOLS_FOLDER = $$ENVE_FOLDER/third_party/gperftools-2.7-enve-mod
+APP_FOLDER = $$PWD/../app
+
+INCLUDEPATH += ../core
+DEPENDPATH += ../core
+
+LIBS += -L$$OUT_PWD/../core -lenvecore
+
+INCLUDEPATH += $$APP_FOLDER
+DEPENDPATH += $$APP_FOLDER
+
+INCLUDEPATH += $$LIBMYPAINT_FOLDER/include
+LIBS += -L$$LIBMYPAINT_FOLDER/.libs -lmypaint -lgobject-2.0 -lglib-2.0 -ljson-c
+
+INCLUDEPATH += $$GPERFTOOLS_FOLDER/include
+LIBS += -L$$GPERFTOOLS_FOLDER/.libs -ltcmalloc
+
+INCLUDEPATH += $$SKIA_FOLDER
+
+CONFIG(debug, debug|release) {
+    LIBS += -L$$SKIA_FOLDER/out/Debug
+} else {
+    LIBS += -L$$SKIA_FOLDER/out/Release
+    QMAKE_CFLAGS -= -O2
+    QMAKE_CFLAGS -= -O1
+    QMAKE_CXXFLAGS -= -O2
+    QMAKE_CXXFLAGS -= -O1
+    QMAKE_CFLAGS = -m64 -O3
+    QMAKE_LFLAGS = -m64 -O3
+    QMAKE_CXXFLAGS = -m64 -O3
+}
+
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -lskia -lpthread -lfreetype -lpng -ldl -fopenmp
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = enve-render
+TEMPLATE = app
+
+SOURCES += main.cpp \
+    $$APP_FOLDER/GUI/audiohandler.cpp \
+    $$APP_FOLDER/GUI/audiofeeder.cpp \
+    $$APP_FOLDER/GUI/ColorWidgets/colorwidgetshaders.cpp \
+    $$APP_FOLDER/effectsloader.cpp \
+    $$APP_FOLDER/hardwareinfo.cpp \
+    $$APP_FOLDER/memorychecker.cpp \
+    $$APP_FOLDER/memoryhandler.cpp \
+    $$APP_FOLDER/outputsettings.cpp \
+    $$APP_FOLDER/renderhandler.cpp \
+    $$APP_FOLDER/renderinstancesettings.cpp \
+    $$APP_FOLDER/videoencoder.cpp
+
+HEADERS += \
+    $$APP_FOLDER/GUI/audiohandler.h \
+    $$APP_FOLDER/GUI/audiofeeder.h \
+    $$APP_FOLDER/GUI/audioringbuffer.h \
+    $$APP_FOLDER/GUI/ColorWidgets/colorwidgetshaders.h \
+    $$APP_FOLDER/effectsloader.h \
+    $$APP_FOLDER/hardwareinfo.h \
+    $$APP_FOLDER/memorychecker.h \
+    $$APP_FOLDER/memoryhandler.h \
+    $$APP_FOLDER/outputsettings.h \
+    $$APP_FOLDER/renderhandler.h \
+    $$APP_FOLDER/renderinstancesettings.h \
+    $$APP_FOLDER/videoencoder.h
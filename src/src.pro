@@ -19,9 +19,13 @@ TEMPLATE = subdirs
 SUBDIRS = app \
           colorwidgetshaders \
           core \
-          shaders
+          render \
+          shaders \
+          tests
 
 colorwidgetshaders.subdir = app/GUI/ColorWidgets/colorwidgetshaders
 shaders.subdir = core/shaders
 
-app.depends = core
\ No newline at end of file
+app.depends = core
+render.depends = core
+tests.depends = core
\ No newline at end of file
@@ -0,0 +1,253 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest>
+#include "Paint/colorconversions.h"
+
+using ColorConversions::Simd;
+Q_DECLARE_METATYPE(ColorConversions::Simd)
+
+class ColorConversionsTest : public QObject {
+    Q_OBJECT
+private slots:
+    void cleanup();
+
+    void rgba8MatchesScalar_data();
+    void rgba8MatchesScalar();
+    void rgba16MatchesScalar_data();
+    void rgba16MatchesScalar();
+    void clampsColorToAlpha();
+
+    void rgba8ToRgba16_data();
+    void rgba8ToRgba16();
+    void rgba8PremulToRgba16_data();
+    void rgba8PremulToRgba16();
+    void rgba16ToRgba8Unpremul_data();
+    void rgba16ToRgba8Unpremul();
+    void rgba16ToRgba8Premul_data();
+    void rgba16ToRgba8Premul();
+};
+
+namespace {
+    void addSimdRows() {
+        QTest::addColumn<Simd>("simd");
+        QTest::newRow("scalar") << Simd::scalar;
+        if(ColorConversions::setSimd(Simd::sse41))
+            QTest::newRow("sse41") << Simd::sse41;
+        if(ColorConversions::setSimd(Simd::avx2))
+            QTest::newRow("avx2") << Simd::avx2;
+    }
+
+    void restoreDefaultSimd() {
+        if(!ColorConversions::setSimd(Simd::avx2))
+            ColorConversions::setSimd(Simd::sse41);
+    }
+
+    typedef void (*To16Func)(const uint8_t*, uint16_t*, int);
+    typedef void (*To8Func)(const uint16_t*, uint8_t*, int);
+
+    //! @brief Converts with the scalar kernels and with simd, true if equal
+    bool matches(const Simd simd, const To16Func func,
+                 const QVector<uint8_t>& src, const int n) {
+        QVector<uint16_t> expected(4*n);
+        ColorConversions::setSimd(Simd::scalar);
+        func(src.constData(), expected.data(), n);
+        QVector<uint16_t> result(4*n);
+        ColorConversions::setSimd(simd);
+        func(src.constData(), result.data(), n);
+        return expected == result;
+    }
+
+    bool matches(const Simd simd, const To8Func func,
+                 const QVector<uint16_t>& src, const int n) {
+        QVector<uint8_t> expected(4*n);
+        ColorConversions::setSimd(Simd::scalar);
+        func(src.constData(), expected.data(), n);
+        QVector<uint8_t> result(4*n);
+        ColorConversions::setSimd(simd);
+        func(src.constData(), result.data(), n);
+        return expected == result;
+    }
+
+    //! @brief 256 tiles of 64x64 pixels
+    const int sBenchmarkPixels = 256*64*64;
+
+    QVector<uint8_t> benchmarkRgba8() {
+        QVector<uint8_t> result(4*sBenchmarkPixels);
+        for(int i = 0; i < result.count(); i++)
+            result[i] = static_cast<uint8_t>(i*7919 >> 3);
+        return result;
+    }
+
+    QVector<uint16_t> benchmarkRgba16() {
+        QVector<uint16_t> result(4*sBenchmarkPixels);
+        for(int i = 0; i < sBenchmarkPixels; i++) {
+            const int a = (i*7919) % 32769;
+            result[4*i] = static_cast<uint16_t>(a/3);
+            result[4*i + 1] = static_cast<uint16_t>(a/2);
+            result[4*i + 2] = static_cast<uint16_t>(a);
+            result[4*i + 3] = static_cast<uint16_t>(a);
+        }
+        return result;
+    }
+}
+
+void ColorConversionsTest::cleanup() {
+    restoreDefaultSimd();
+}
+
+void ColorConversionsTest::rgba8MatchesScalar_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba8MatchesScalar() {
+    QFETCH(Simd, simd);
+    // every 8-bit rgba pixel, one span per red and alpha pair,
+    // an odd count exercises the scalar tails
+    const int n = 256*256 + 3;
+    QVector<uint8_t> src(4*n);
+    for(int i = 0; i < n; i++) {
+        src[4*i + 1] = static_cast<uint8_t>(i >> 8);
+        src[4*i + 2] = static_cast<uint8_t>(i);
+    }
+    for(int a = 0; a < 256; a++) {
+        for(int r = 0; r < 256; r++) {
+            for(int i = 0; i < n; i++) {
+                src[4*i] = static_cast<uint8_t>(r);
+                src[4*i + 3] = static_cast<uint8_t>(a);
+            }
+            QVERIFY(matches(simd, rgba8_to_rgba16_span, src, n));
+            QVERIFY(matches(simd, rgba8_premultiplied_to_rgba16_span, src, n));
+        }
+    }
+}
+
+void ColorConversionsTest::rgba16MatchesScalar_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba16MatchesScalar() {
+    QFETCH(Simd, simd);
+    // channels convert independently for a given alpha,
+    // so every valid premultiplied color and alpha pair is covered
+    // with each color channel going through [0, alpha]
+    QVector<uint16_t> src(4*((1 << 15) + 1));
+    for(int a = 0; a <= (1 << 15); a++) {
+        const int n = a + 1;
+        for(int c = 0; c < n; c++) {
+            src[4*c] = static_cast<uint16_t>(c);
+            src[4*c + 1] = static_cast<uint16_t>(a - c);
+            src[4*c + 2] = static_cast<uint16_t>((c*7919) % n);
+            src[4*c + 3] = static_cast<uint16_t>(a);
+        }
+        QVERIFY(matches(simd, rgba16_to_rgba8_unpremultiplied_span, src, n));
+        QVERIFY(matches(simd, rgba16_to_rgba8_premultiplied_span, src, n));
+    }
+}
+
+void ColorConversionsTest::clampsColorToAlpha() {
+    // color above alpha is not valid premultiplied data,
+    // it converts the same as color equal to alpha
+    const int n = 19;
+    for(const auto simd : {Simd::scalar, Simd::sse41, Simd::avx2}) {
+        if(!ColorConversions::setSimd(simd)) continue;
+        for(const int a : {0, 1, 2, 255, 256, 12345, 32767}) {
+            QVector<uint16_t> src(4*n);
+            for(int i = 0; i < n; i++) {
+                src[4*i] = static_cast<uint16_t>(a + 1 + i);
+                src[4*i + 1] = static_cast<uint16_t>(32768 + i);
+                src[4*i + 2] = static_cast<uint16_t>(65535 - i);
+                src[4*i + 3] = static_cast<uint16_t>(a);
+            }
+            QVector<uint8_t> dst(4*n);
+            rgba16_to_rgba8_unpremultiplied_span(src.constData(),
+                                                 dst.data(), n);
+            const uint8_t color = a == 0 ? 0 : 255;
+            const uint8_t alpha = static_cast<uint8_t>(
+                        (a*255 + (1 << 14)) >> 15);
+            for(int i = 0; i < n; i++) {
+                QCOMPARE(dst[4*i], color);
+                QCOMPARE(dst[4*i + 1], color);
+                QCOMPARE(dst[4*i + 2], color);
+                QCOMPARE(dst[4*i + 3], alpha);
+            }
+        }
+    }
+}
+
+void ColorConversionsTest::rgba8ToRgba16_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba8ToRgba16() {
+    QFETCH(Simd, simd);
+    const auto src = benchmarkRgba8();
+    QVector<uint16_t> dst(src.count());
+    QVERIFY(ColorConversions::setSimd(simd));
+    QBENCHMARK {
+        rgba8_to_rgba16_span(src.constData(), dst.data(), sBenchmarkPixels);
+    }
+}
+
+void ColorConversionsTest::rgba8PremulToRgba16_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba8PremulToRgba16() {
+    QFETCH(Simd, simd);
+    const auto src = benchmarkRgba8();
+    QVector<uint16_t> dst(src.count());
+    QVERIFY(ColorConversions::setSimd(simd));
+    QBENCHMARK {
+        rgba8_premultiplied_to_rgba16_span(src.constData(), dst.data(),
+                                           sBenchmarkPixels);
+    }
+}
+
+void ColorConversionsTest::rgba16ToRgba8Unpremul_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba16ToRgba8Unpremul() {
+    QFETCH(Simd, simd);
+    const auto src = benchmarkRgba16();
+    QVector<uint8_t> dst(src.count());
+    QVERIFY(ColorConversions::setSimd(simd));
+    QBENCHMARK {
+        rgba16_to_rgba8_unpremultiplied_span(src.constData(), dst.data(),
+                                             sBenchmarkPixels);
+    }
+}
+
+void ColorConversionsTest::rgba16ToRgba8Premul_data() {
+    addSimdRows();
+}
+
+void ColorConversionsTest::rgba16ToRgba8Premul() {
+    QFETCH(Simd, simd);
+    const auto src = benchmarkRgba16();
+    QVector<uint8_t> dst(src.count());
+    QVERIFY(ColorConversions::setSimd(simd));
+    QBENCHMARK {
+        rgba16_to_rgba8_premultiplied_span(src.constData(), dst.data(),
+                                           sBenchmarkPixels);
+    }
+}
+
+QTEST_APPLESS_MAIN(ColorConversionsTest)
+
+#include "tst_colorconversions.moc"
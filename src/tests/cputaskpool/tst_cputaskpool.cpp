@@ -0,0 +1,116 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest>
+#include <atomic>
+#include "Private/Tasks/cputaskpool.h"
+#include "Tasks/updatable.h"
+
+class CpuTaskPoolTest : public QObject {
+    Q_OBJECT
+private:
+    //! @brief Submits nTasks tasks and spins the event loop
+    //! until all of them are delivered back as finished.
+    void runTasks(CpuTaskPool& pool, const int nTasks,
+                  const std::function<void(void)>& run);
+private slots:
+    void processesAllTasks();
+    void wakesAfterIdle();
+    void runsJobsOnIdle();
+    void dispatch_data();
+    void dispatch();
+};
+
+void CpuTaskPoolTest::runTasks(CpuTaskPool& pool, const int nTasks,
+                               const std::function<void(void)>& run) {
+    int nFinished = 0;
+    const auto conn = connect(&pool, &CpuTaskPool::finishedTasks,
+                              [&nFinished](const QList<stdsptr<eTask>>& tasks) {
+        nFinished += tasks.count();
+    });
+    for(int i = 0; i < nTasks; i++) {
+        pool.submit(enve::make_shared<eCustomCpuTask>(nullptr, run, nullptr));
+    }
+    while(nFinished < nTasks) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    disconnect(conn);
+}
+
+void CpuTaskPoolTest::processesAllTasks() {
+    CpuTaskPool pool(QThread::idealThreadCount());
+    std::atomic<int> nRun{0};
+    runTasks(pool, 10000, [&nRun]() { nRun++; });
+    QCOMPARE(nRun.load(), 10000);
+}
+
+void CpuTaskPoolTest::wakesAfterIdle() {
+    CpuTaskPool pool(QThread::idealThreadCount());
+    std::atomic<int> nRun{0};
+    // workers sleep without a timeout between the batches
+    for(int i = 0; i < 20; i++) {
+        runTasks(pool, 1, [&nRun]() { nRun++; });
+        QThread::msleep(2);
+    }
+    pool.setActiveThreads(1);
+    runTasks(pool, 100, [&nRun]() { nRun++; });
+    pool.setActiveThreads(pool.threadCount());
+    runTasks(pool, 100, [&nRun]() { nRun++; });
+    QCOMPARE(nRun.load(), 220);
+}
+
+void CpuTaskPoolTest::runsJobsOnIdle() {
+    CpuTaskPool pool(2);
+    // let both workers go to sleep
+    while(pool.idleThreads() < 2) QThread::msleep(1);
+    QSemaphore started;
+    QSemaphore release;
+    const auto job = [&started, &release]() {
+        started.release();
+        release.acquire();
+    };
+    QVERIFY(pool.runOnIdle(job));
+    QVERIFY(pool.runOnIdle(job));
+    // both idle workers are claimed
+    QVERIFY(!pool.runOnIdle(job));
+    started.acquire(2);
+    release.release(2);
+    // jobs do not hold back tasks
+    std::atomic<int> nRun{0};
+    runTasks(pool, 100, [&nRun]() { nRun++; });
+    QCOMPARE(nRun.load(), 100);
+}
+
+void CpuTaskPoolTest::dispatch_data() {
+    QTest::addColumn<int>("nTasks");
+    QTest::newRow("1 task") << 1;
+    QTest::newRow("64 tasks") << 64;
+    QTest::newRow("4096 tasks") << 4096;
+}
+
+void CpuTaskPoolTest::dispatch() {
+    QFETCH(int, nTasks);
+    CpuTaskPool pool(QThread::idealThreadCount());
+    // measures submission, stealing and batched delivery of empty tasks
+    QBENCHMARK {
+        runTasks(pool, nTasks, nullptr);
+    }
+}
+
+QTEST_MAIN(CpuTaskPoolTest)
+
+#include "tst_cputaskpool.moc"
@@ -0,0 +1,313 @@
+// enve - 2D animations software
+// Copyright (C) 2016-2019 Maurycy Liebner
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest>
+#include <random>
+#include "Sound/soundmixing.h"
+#include "Animators/qrealsnapshot.h"
+#include "Animators/qrealkey.h"
+
+using SoundMixing::Simd;
+Q_DECLARE_METATYPE(SoundMixing::Simd)
+
+class SoundMixingTest : public QObject {
+    Q_OBJECT
+private slots:
+    void cleanup();
+
+    void roundsHalfToEven();
+    void saturates();
+    void simdMatchesScalar_data();
+    void simdMatchesScalar();
+
+    void mixS16_data();
+    void mixS16();
+    void mixFloat_data();
+    void mixFloat();
+
+    void mergePerSample_data();
+    void mergePerSample();
+    void mergeBlocks_data();
+    void mergeBlocks();
+};
+
+namespace {
+    //! @brief Mixes with the given kernels selected
+    void mixS16With(const Simd simd, QVector<qint16>& dst,
+                    const QVector<qint16>& src, const QVector<float>& gain) {
+        QVERIFY(SoundMixing::setSimd(simd));
+        SoundMixing::mixS16(dst.data(), src.constData(),
+                            gain.constData(), dst.count());
+    }
+
+    void mixFloatWith(const Simd simd, QVector<float>& dst,
+                      const QVector<float>& src, const QVector<float>& gain) {
+        QVERIFY(SoundMixing::setSimd(simd));
+        SoundMixing::mixFloat(dst.data(), src.constData(),
+                              gain.constData(), dst.count());
+    }
+
+    void addSimdRows() {
+        QTest::addColumn<Simd>("simd");
+        QTest::newRow("scalar") << Simd::scalar;
+        if(SoundMixing::setSimd(Simd::sse2))
+            QTest::newRow("sse2") << Simd::sse2;
+        if(SoundMixing::setSimd(Simd::avx2))
+            QTest::newRow("avx2") << Simd::avx2;
+    }
+
+    //! @brief Volume snapshot with sample frames at 44100 Hz and 24 fps,
+    //! fades out over one second if animated
+    QrealSnapshot volumeSnapshot(const bool animated) {
+        QrealSnapshot snap(100, 44100./24, 0.01);
+        if(animated) {
+            const auto first = enve::make_shared<QrealKey>(100, 0, nullptr);
+            const auto last = enve::make_shared<QrealKey>(0, 24, nullptr);
+            snap.appendKey(first.get());
+            snap.appendKey(last.get());
+        }
+        return snap;
+    }
+
+    void addVolumeRows() {
+        QTest::addColumn<bool>("animated");
+        QTest::newRow("static volume") << false;
+        QTest::newRow("animated volume") << true;
+    }
+
+    //! @brief Interleaved float merge as done by SoundMerger
+    //! before the gain kernels, one volume lookup per sample
+    void mergePerSampleFloat(const float* const src, float * const dst,
+                             const int nSamples,
+                             QrealSnapshot::Iterator volIt,
+                             const int nChannels) {
+        int dstId = 0;
+        int srcId = 0;
+        if(volIt.staticValue()) {
+            const float vol = static_cast<float>(volIt.getValueAndProgress(1));
+            for(int i = 0; i < nSamples; i++) {
+                for(int j = 0; j < nChannels; j++) {
+                    dst[dstId++] += src[srcId++]*vol;
+                }
+            }
+        } else {
+            for(int i = 0; i < nSamples; i++) {
+                const float vol = static_cast<float>(volIt.getValueAndProgress(1));
+                for(int j = 0; j < nChannels; j++) {
+                    dst[dstId++] += src[srcId++]*vol;
+                }
+            }
+        }
+    }
+
+    //! @brief Interleaved float merge as done by SoundMerger,
+    //! gains are filled from volume ramps for blocks of 256 samples
+    void mergeBlocksFloat(const float* const src, float * const dst,
+                          const int nSamples,
+                          QrealSnapshot::Iterator volIt,
+                          const int nChannels) {
+        const int block = 256;
+        QVector<float> gains(block*nChannels);
+        const auto fillGains = [&volIt, &gains, nChannels](const int n) {
+            float* gain = gains.data();
+            int i = 0;
+            while(i < n) {
+                qreal vol;
+                qreal step;
+                const int nRamp = volIt.getRampAndProgress(n - i, vol, step);
+                for(int k = 0; k < nRamp; k++) {
+                    const float g = static_cast<float>(vol + k*step);
+                    for(int j = 0; j < nChannels; j++) *gain++ = g;
+                }
+                i += nRamp;
+            }
+        };
+        const bool staticVol = volIt.staticValue();
+        if(staticVol) fillGains(block);
+        for(int i = 0; i < nSamples; i += block) {
+            const int n = qMin(block, nSamples - i);
+            if(!staticVol) fillGains(n);
+            SoundMixing::mixFloat(dst + i*nChannels, src + i*nChannels,
+                                  gains.constData(), n*nChannels);
+        }
+    }
+
+    void restoreDefaultSimd() {
+        if(!SoundMixing::setSimd(Simd::avx2))
+            SoundMixing::setSimd(Simd::sse2);
+    }
+}
+
+void SoundMixingTest::cleanup() {
+    restoreDefaultSimd();
+}
+
+void SoundMixingTest::roundsHalfToEven() {
+    // 20 samples so that every kernel also runs its scalar tail
+    const QVector<qint16> src{1, 3, 5, 7, -1, -3, -5, -7, 1, 3,
+                              5, 7, -1, -3, -5, -7, 1, 3, 5, 7};
+    const QVector<qint16> expected{0, 2, 2, 4, 0, -2, -2, -4, 0, 2,
+                                   2, 4, 0, -2, -2, -4, 0, 2, 2, 4};
+    const QVector<float> gain(src.count(), 0.5f);
+    for(const auto simd : {Simd::scalar, Simd::sse2, Simd::avx2}) {
+        if(!SoundMixing::setSimd(simd)) continue;
+        QVector<qint16> dst(src.count(), 0);
+        mixS16With(simd, dst, src, gain);
+        QCOMPARE(dst, expected);
+    }
+}
+
+void SoundMixingTest::saturates() {
+    const QVector<qint16> src(20, 30000);
+    const QVector<float> gain(src.count(), 1.f);
+    for(const auto simd : {Simd::scalar, Simd::sse2, Simd::avx2}) {
+        if(!SoundMixing::setSimd(simd)) continue;
+        QVector<qint16> high(src.count(), 30000);
+        mixS16With(simd, high, src, gain);
+        QCOMPARE(high, QVector<qint16>(src.count(), 32767));
+
+        QVector<qint16> low(src.count(), -30000);
+        mixS16With(simd, low, src, QVector<float>(src.count(), -1.f));
+        QCOMPARE(low, QVector<qint16>(src.count(), -32768));
+    }
+}
+
+void SoundMixingTest::simdMatchesScalar_data() {
+    addSimdRows();
+}
+
+void SoundMixingTest::simdMatchesScalar() {
+    QFETCH(Simd, simd);
+    // every qint16 sample, an odd count exercises the scalar tails
+    const int n = 65536 + 13;
+    QVector<qint16> src(n);
+    QVector<float> srcFloat(n);
+    for(int i = 0; i < n; i++) {
+        src[i] = static_cast<qint16>(i % 65536 - 32768);
+        srcFloat[i] = src[i]/32768.f;
+    }
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> randomGain(-3.f, 3.f);
+    QList<QVector<float>> gains;
+    for(const float g : {0.f, 0.25f, 0.5f, 1.f, 1.5f, -0.5f, 2.f, 0.7071f}) {
+        gains << QVector<float>(n, g);
+    }
+    QVector<float> random(n);
+    for(auto& g : random) g = randomGain(rng);
+    gains << random;
+
+    for(const auto& gain : gains) {
+        for(const qint16 dst0 : {-32768, -20001, -1, 0, 1, 12345, 32767}) {
+            QVector<qint16> expected(n, dst0);
+            mixS16With(Simd::scalar, expected, src, gain);
+            QVector<qint16> result(n, dst0);
+            mixS16With(simd, result, src, gain);
+            QVERIFY(expected == result);
+
+            QVector<float> expectedFloat(n, dst0/32768.f);
+            mixFloatWith(Simd::scalar, expectedFloat, srcFloat, gain);
+            QVector<float> resultFloat(n, dst0/32768.f);
+            mixFloatWith(simd, resultFloat, srcFloat, gain);
+            QVERIFY(memcmp(expectedFloat.constData(), resultFloat.constData(),
+                           static_cast<size_t>(n)*sizeof(float)) == 0);
+        }
+    }
+}
+
+void SoundMixingTest::mixS16_data() {
+    addSimdRows();
+}
+
+void SoundMixingTest::mixS16() {
+    QFETCH(Simd, simd);
+    // one second of stereo samples at 44100 Hz
+    const int n = 2*44100;
+    QVector<qint16> src(n);
+    for(int i = 0; i < n; i++) src[i] = static_cast<qint16>(i*7919);
+    const QVector<float> gain(n, 0.7f);
+    QVector<qint16> dst(n, 0);
+    QVERIFY(SoundMixing::setSimd(simd));
+    QBENCHMARK {
+        SoundMixing::mixS16(dst.data(), src.constData(), gain.constData(), n);
+    }
+}
+
+void SoundMixingTest::mixFloat_data() {
+    addSimdRows();
+}
+
+void SoundMixingTest::mixFloat() {
+    QFETCH(Simd, simd);
+    const int n = 2*44100;
+    QVector<float> src(n);
+    for(int i = 0; i < n; i++) src[i] = static_cast<float>(i % 200)/100 - 1;
+    const QVector<float> gain(n, 0.7f);
+    QVector<float> dst(n, 0.f);
+    QVERIFY(SoundMixing::setSimd(simd));
+    QBENCHMARK {
+        SoundMixing::mixFloat(dst.data(), src.constData(), gain.constData(), n);
+    }
+}
+
+void SoundMixingTest::mergePerSample_data() {
+    addVolumeRows();
+}
+
+void SoundMixingTest::mergePerSample() {
+    QFETCH(bool, animated);
+    // one second of stereo samples at 44100 Hz
+    const int nSamples = 44100;
+    QVector<float> src(2*nSamples);
+    for(int i = 0; i < src.count(); i++)
+        src[i] = static_cast<float>(i % 200)/100 - 1;
+    QVector<float> dst(src.count(), 0.f);
+    const auto snap = volumeSnapshot(animated);
+    QBENCHMARK {
+        const QrealSnapshot::Iterator volIt(0, 1000, &snap);
+        mergePerSampleFloat(src.constData(), dst.data(), nSamples, volIt, 2);
+    }
+}
+
+void SoundMixingTest::mergeBlocks_data() {
+    addVolumeRows();
+}
+
+void SoundMixingTest::mergeBlocks() {
+    QFETCH(bool, animated);
+    const int nSamples = 44100;
+    QVector<float> src(2*nSamples);
+    for(int i = 0; i < src.count(); i++)
+        src[i] = static_cast<float>(i % 200)/100 - 1;
+    QVector<float> dst(src.count(), 0.f);
+    const auto snap = volumeSnapshot(animated);
+    // the merged result matches the per-sample merge
+    QVector<float> expected(src.count(), 0.f);
+    mergePerSampleFloat(src.constData(), expected.data(), nSamples,
+                        QrealSnapshot::Iterator(0, 1000, &snap), 2);
+    mergeBlocksFloat(src.constData(), dst.data(), nSamples,
+                     QrealSnapshot::Iterator(0, 1000, &snap), 2);
+    for(int i = 0; i < dst.count(); i++)
+        QVERIFY(qAbs(dst.at(i) - expected.at(i)) < 1e-4f);
+    QBENCHMARK {
+        const QrealSnapshot::Iterator volIt(0, 1000, &snap);
+        mergeBlocksFloat(src.constData(), dst.data(), nSamples, volIt, 2);
+    }
+}
+
+QTEST_APPLESS_MAIN(SoundMixingTest)
+
+#include "tst_soundmixing.moc"